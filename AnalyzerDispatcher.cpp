@@ -0,0 +1,312 @@
+/*
+ * AnalyzerDispatcher.cpp
+ */
+
+#include "AnalyzerDispatcher.h"
+#include "SerialPortDataAnalyzer.h"
+
+#include <algorithm>
+
+const std::size_t AnalyzerDispatcher::DEFAULT_ANALYZER_QUEUE_CAPACITY;
+const std::size_t AnalyzerDispatcher::MAX_SAMPLES_PER_RUN;
+const std::size_t AnalyzerDispatcher::SINGLE_SOURCE_WORKER_COUNT;
+
+AnalyzerDispatcher::AnalyzerDispatcher(std::size_t workerCount)
+    :stopRequested(false)
+    ,droppedCount(0) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        this->workers.emplace_back([this] {this->runWorker(); });
+    }
+}
+
+AnalyzerDispatcher::~AnalyzerDispatcher() {
+    this->shutdown();
+}
+
+bool AnalyzerDispatcher::addAnalyzer(SerialPortDataAnalyzer* analyzer, BackpressurePolicy policy, std::size_t queueCapacity,
+                                     PortId portFilter) {
+    if (analyzer == nullptr) {
+        return false;
+    }
+
+    std::scoped_lock dispatcherLock(this->dispatcherMutex);
+
+    if (this->stopRequested) {
+        return false;
+    }
+
+    for (const std::shared_ptr<AnalyzerEntry>& entry : this->analyzerEntries) {
+        if (entry->analyzer == analyzer) {
+            return false;
+        }
+    }
+
+    std::shared_ptr<AnalyzerEntry> entry = std::make_shared<AnalyzerEntry>();
+    entry->analyzer = analyzer;
+    entry->policy = policy;
+    entry->queueCapacity = std::max<std::size_t>(queueCapacity, 1);
+    entry->portFilter = portFilter;
+    entry->allChannels = analyzer->receivesAllChannels();
+    entry->scheduled = false;
+    entry->removed = false;
+
+    this->analyzerEntries.push_back(entry);
+    return true;
+}
+
+void AnalyzerDispatcher::removeAnalyzer(SerialPortDataAnalyzer* analyzer) {
+    std::shared_ptr<AnalyzerEntry> removedEntry;
+
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+
+        auto entryPosition = std::find_if(this->analyzerEntries.begin(), this->analyzerEntries.end(),
+                [analyzer](const std::shared_ptr<AnalyzerEntry>& entry) { return entry->analyzer == analyzer; });
+        if (entryPosition == this->analyzerEntries.end()) {
+            return;
+        }
+
+        removedEntry = *entryPosition;
+        this->analyzerEntries.erase(entryPosition);
+    }
+
+    std::unique_lock<std::mutex> entryLock(removedEntry->entryMutex);
+    removedEntry->removed = true;
+    removedEntry->pendingSamples.clear();
+
+    // Wakes up dispatch() blocked on full queue of that analyzer.
+    removedEntry->entryNotifier.notify_all();
+
+    // Worker running the analyzer finishes its current run and does not schedule it again.
+    removedEntry->entryNotifier.wait(entryLock, [&removedEntry] {
+        return !removedEntry->scheduled;
+    });
+}
+
+void AnalyzerDispatcher::dispatch(const SerialSample* samples, std::size_t count) {
+    std::vector<std::shared_ptr<AnalyzerEntry>> currentEntries;
+
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+
+        if (this->stopRequested) {
+            return;
+        }
+        currentEntries = this->analyzerEntries;
+    }
+
+    // Single clock read for the whole block.
+    SampleTimestamp dispatchTime = SampleClock::now();
+
+    for (const std::shared_ptr<AnalyzerEntry>& entry : currentEntries) {
+        std::unique_lock<std::mutex> entryLock(entry->entryMutex);
+
+        for (std::size_t i = 0; i < count && !entry->removed; ++i) {
+            if ((entry->portFilter != ALL_PORTS && samples[i].portId != entry->portFilter) ||
+                    (samples[i].channel != 0 && !entry->allChannels)) {
+                continue;
+            }
+
+            if (entry->policy == BackpressurePolicy::BLOCK) {
+                while (entry->pendingSamples.size() >= entry->queueCapacity && !entry->removed) {
+                    if (!entry->scheduled) {
+                        // Queue can be full of readings from this very call - worker has to take them first.
+                        entry->scheduled = true;
+                        entryLock.unlock();
+                        this->schedule(entry);
+                        entryLock.lock();
+                    }
+                    else {
+                        entry->entryNotifier.wait(entryLock);
+                    }
+                }
+                if (entry->removed) {
+                    break;
+                }
+            }
+
+            this->enqueue(*entry, samples[i], dispatchTime);
+        }
+
+        if (!entry->scheduled && !entry->removed && !entry->pendingSamples.empty()) {
+            entry->scheduled = true;
+            entryLock.unlock();
+            this->schedule(entry);
+        }
+    }
+}
+
+void AnalyzerDispatcher::waitUntilIdle() {
+    std::vector<std::shared_ptr<AnalyzerEntry>> currentEntries;
+
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+        currentEntries = this->analyzerEntries;
+    }
+
+    for (const std::shared_ptr<AnalyzerEntry>& entry : currentEntries) {
+        std::unique_lock<std::mutex> entryLock(entry->entryMutex);
+        entry->entryNotifier.wait(entryLock, [&entry] {
+            return entry->removed || (entry->pendingSamples.empty() && !entry->scheduled);
+        });
+    }
+}
+
+void AnalyzerDispatcher::shutdown() {
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+        this->stopRequested = true;
+    }
+    this->workerNotifier.notify_all();
+
+    // Workers stop only when there is nothing left to run.
+    for (std::thread& worker : this->workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::uint64_t AnalyzerDispatcher::getDroppedCount() const {
+    return this->droppedCount;
+}
+
+std::size_t AnalyzerDispatcher::getWorkerCount() const {
+    return this->workers.size();
+}
+
+const LatencyHistogram& AnalyzerDispatcher::getAnalyzerLatency() const {
+    return this->analyzerLatency;
+}
+
+void AnalyzerDispatcher::collectMetrics(MetricsWriter& writer, const std::string& labels) {
+    std::vector<std::shared_ptr<AnalyzerEntry>> currentEntries;
+
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+        currentEntries = this->analyzerEntries;
+    }
+
+    std::size_t totalDepth = 0;
+    std::size_t maxDepth = 0;
+    for (const std::shared_ptr<AnalyzerEntry>& entry : currentEntries) {
+        std::scoped_lock entryLock(entry->entryMutex);
+        totalDepth += entry->pendingSamples.size();
+        maxDepth = std::max(maxDepth, entry->pendingSamples.size());
+    }
+
+    writer.addGauge("analyzer_count", "Amount of registered analyzers.", labels,
+                    static_cast<double>(currentEntries.size()));
+    writer.addGauge("analyzer_queue_depth", "Readings waiting in all analyzer queues.", labels,
+                    static_cast<double>(totalDepth));
+    writer.addGauge("analyzer_queue_depth_max", "Readings waiting in the longest analyzer queue.", labels,
+                    static_cast<double>(maxDepth));
+    writer.addCounter("analyzer_dropped_readings_total", "Readings dropped or coalesced by analyzer queues.", labels,
+                      this->droppedCount);
+    writer.addHistogram("analyzer_dispatch_to_done_seconds",
+                        "Time from dispatching the oldest reading of analyzer run until the run finished.", labels,
+                        this->analyzerLatency);
+}
+
+void AnalyzerDispatcher::runWorker() {
+    std::vector<SerialSample> samplesToDeliver;
+    samplesToDeliver.reserve(MAX_SAMPLES_PER_RUN);
+
+    while (true) {
+        std::shared_ptr<AnalyzerEntry> entry;
+        SampleTimestamp oldestDispatchTime = INVALID_TIMESTAMP;
+
+        {
+            std::unique_lock<std::mutex> dispatcherLock(this->dispatcherMutex);
+            this->workerNotifier.wait(dispatcherLock, [this] {
+                return !this->readyEntries.empty() || this->stopRequested;
+            });
+
+            if (this->readyEntries.empty()) {
+                return;
+            }
+
+            entry = std::move(this->readyEntries.front());
+            this->readyEntries.pop_front();
+        }
+
+        {
+            std::scoped_lock entryLock(entry->entryMutex);
+            std::size_t takenSamples = std::min(entry->pendingSamples.size(), MAX_SAMPLES_PER_RUN);
+            if (takenSamples > 0) {
+                oldestDispatchTime = entry->pendingSamples.front().dispatchTime;
+            }
+            for (std::size_t i = 0; i < takenSamples; ++i) {
+                samplesToDeliver.push_back(entry->pendingSamples[i].sample);
+            }
+            entry->pendingSamples.erase(entry->pendingSamples.begin(), entry->pendingSamples.begin() + takenSamples);
+        }
+        // Free space for dispatch() blocked on full queue.
+        entry->entryNotifier.notify_all();
+
+        // Analyzer runs without any lock held, entry stays scheduled so no other worker runs it.
+        if (!samplesToDeliver.empty()) {
+            entry->analyzer->fetchNewBatch(samplesToDeliver.data(), samplesToDeliver.size());
+            samplesToDeliver.clear();
+            this->analyzerLatency.recordSince(oldestDispatchTime);
+        }
+
+        bool scheduleAgain = false;
+        {
+            std::scoped_lock entryLock(entry->entryMutex);
+            if (!entry->removed && !entry->pendingSamples.empty()) {
+                scheduleAgain = true;
+            }
+            else {
+                entry->scheduled = false;
+            }
+        }
+
+        if (scheduleAgain) {
+            // Goes to the end of the line, so other analyzers get their turn.
+            this->schedule(entry);
+        }
+        else {
+            entry->entryNotifier.notify_all();
+        }
+    }
+}
+
+void AnalyzerDispatcher::enqueue(AnalyzerEntry& entry, const SerialSample& sample, SampleTimestamp dispatchTime) {
+    std::deque<QueuedSample>& pendingSamples = entry.pendingSamples;
+
+    if (entry.policy == BackpressurePolicy::COALESCE && sample.status == SampleStatus::VALUE) {
+        // Values queued after the latest status reading hold at most one value per port and channel,
+        // so only a few of them are checked. Value of the same port and channel which was not delivered
+        // yet is outdated anyway. Replaced in place, channels of the newest multi-channel message
+        // stay together in queue.
+        for (auto queued = pendingSamples.rbegin(); queued != pendingSamples.rend(); ++queued) {
+            if (queued->sample.status != SampleStatus::VALUE) {
+                break;
+            }
+            if (queued->sample.portId == sample.portId && queued->sample.channel == sample.channel) {
+                *queued = QueuedSample{ sample, dispatchTime };
+                ++this->droppedCount;
+                return;
+            }
+        }
+    }
+
+    if (pendingSamples.size() >= entry.queueCapacity) {
+        pendingSamples.pop_front();
+        ++this->droppedCount;
+    }
+    pendingSamples.push_back(QueuedSample{ sample, dispatchTime });
+}
+
+void AnalyzerDispatcher::schedule(const std::shared_ptr<AnalyzerEntry>& entry) {
+    {
+        std::scoped_lock dispatcherLock(this->dispatcherMutex);
+        this->readyEntries.push_back(entry);
+    }
+    this->workerNotifier.notify_one();
+}
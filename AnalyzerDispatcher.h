@@ -0,0 +1,184 @@
+/*
+ * AnalyzerDispatcher.h
+ *
+ * Delivers readings to registered analyzers on a pool of worker threads.
+ *
+ * Every analyzer has its own bounded queue and is run by at most one worker at a time,
+ * so it gets readings in order and does not need to be reentrant, but different analyzers
+ * run in parallel - slow analyzer does not delay the other ones. What happens when
+ * analyzer's queue is full depends on policy chosen during registration.
+ *
+ * Dispatcher measures time from dispatching a reading until analyzer finished processing it
+ * (see getAnalyzerLatency()) and reports its queues in metrics of the reader owning it.
+ */
+
+#ifndef ANALYZERDISPATCHER_H_
+#define ANALYZERDISPATCHER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "MetricsWriter.h"
+#include "SampleClock.h"
+#include "SerialSample.h"
+
+class SerialPortDataAnalyzer;
+
+// Behaviour of analyzer queue when analyzer does not keep up with readings.
+enum class BackpressurePolicy {
+    BLOCK,       // no reading is lost, dispatching waits for free space (delays all analyzers)
+    DROP_OLDEST, // the oldest queued reading is dropped
+    COALESCE     // queued value is replaced by newer value of the same port and channel, analyzer gets
+                 // only the latest value (latest message of multi-channel device) of every port
+                 // (status readings are always kept)
+};
+
+class AnalyzerDispatcher {
+public:
+    // Default size of single analyzer queue.
+    static const std::size_t DEFAULT_ANALYZER_QUEUE_CAPACITY = 1024;
+
+    // Default amount of workers of sources reading a single port (Serial, ReplaySource) - every reader
+    // has its own dispatcher, so one worker per processor core would multiply threads by amount of readers.
+    static const std::size_t SINGLE_SOURCE_WORKER_COUNT = 2;
+
+    /**
+     * Starts worker threads.
+     *
+     * param: workerCount - amount of worker threads, 0 means one per processor core
+     */
+    explicit AnalyzerDispatcher(std::size_t workerCount = 0);
+
+    // Delivers queued readings and stops workers.
+    ~AnalyzerDispatcher();
+
+    AnalyzerDispatcher(const AnalyzerDispatcher&) = delete;
+    AnalyzerDispatcher& operator=(const AnalyzerDispatcher&) = delete;
+
+    /**
+     * Adds analyzer, it gets readings dispatched from now on.
+     *
+     * params:
+     * analyzer - analyzer to add
+     * policy - what to do when analyzer queue is full
+     * queueCapacity - maximal amount of readings waiting for that analyzer
+     * portFilter - analyzer gets only readings of that port, ALL_PORTS for readings of every port
+     * returns: true on success, false when analyzer is already added or dispatcher is stopped
+     */
+    bool addAnalyzer(SerialPortDataAnalyzer* analyzer, BackpressurePolicy policy,
+                     std::size_t queueCapacity = DEFAULT_ANALYZER_QUEUE_CAPACITY, PortId portFilter = ALL_PORTS);
+
+    // Removes analyzer and drops its queued readings. When analyzer is being run by a worker
+    // waits until it finishes, so analyzer can be destroyed right after that call.
+    // Must not be called from the analyzer itself.
+    void removeAnalyzer(SerialPortDataAnalyzer* analyzer);
+
+    /**
+     * Puts readings into queues of all analyzers and schedules them on workers.
+     * Can be called from several threads (e.g. I/O threads of SerialPortManager) - readings
+     * dispatched by a single thread reach every analyzer in the same order.
+     */
+    void dispatch(const SerialSample* samples, std::size_t count);
+
+    // Blocks until all queued readings are delivered.
+    void waitUntilIdle();
+
+    // Delivers all queued readings and stops workers, dispatch() does nothing afterwards.
+    void shutdown();
+
+    // Returns amount of readings dropped or coalesced by all analyzer queues.
+    std::uint64_t getDroppedCount() const;
+
+    // Returns amount of worker threads.
+    std::size_t getWorkerCount() const;
+
+    // Returns histogram of time from dispatch() of the oldest reading given to analyzer run
+    // until analyzer finished that run (one value per run).
+    const LatencyHistogram& getAnalyzerLatency() const;
+
+    /**
+     * Adds metrics of analyzer queues (called by reader owning the dispatcher).
+     *
+     * params:
+     * writer - collected metrics
+     * labels - labels identifying the reader, see MetricsWriter::label()
+     */
+    void collectMetrics(MetricsWriter& writer, const std::string& labels);
+
+private:
+    // Reading waiting in analyzer queue with time it was dispatched.
+    struct QueuedSample {
+        SerialSample sample;
+        SampleTimestamp dispatchTime;
+    };
+
+    // Analyzer with its queue. Shared between dispatcher and workers, so removed analyzer
+    // entry stays valid until worker running it finishes.
+    struct AnalyzerEntry {
+        SerialPortDataAnalyzer* analyzer;
+        BackpressurePolicy policy;
+        std::size_t queueCapacity;
+        PortId portFilter;
+        // False when analyzer gets only channel 0 of multi-channel messages.
+        bool allChannels;
+
+        // Protects all fields below.
+        std::mutex entryMutex;
+
+        // Signalled when readings are taken from queue or analyzer stops running.
+        std::condition_variable entryNotifier;
+
+        std::deque<QueuedSample> pendingSamples;
+
+        // True when entry waits in readyEntries or is being run by a worker.
+        bool scheduled;
+
+        // True after removeAnalyzer(), entry is not scheduled anymore.
+        bool removed;
+    };
+
+    // Maximal amount of readings given to analyzer in one run, so worker goes
+    // to other analyzers from time to time.
+    static const std::size_t MAX_SAMPLES_PER_RUN = 256;
+
+    std::vector<std::thread> workers;
+
+    // Protects analyzerEntries, readyEntries and stopRequested.
+    std::mutex dispatcherMutex;
+
+    // Signalled when entry becomes ready or workers should stop.
+    std::condition_variable workerNotifier;
+
+    std::vector<std::shared_ptr<AnalyzerEntry>> analyzerEntries;
+
+    // Entries with pending readings waiting for a worker, in order of scheduling.
+    std::deque<std::shared_ptr<AnalyzerEntry>> readyEntries;
+
+    bool stopRequested;
+
+    // Readings dropped by DROP_OLDEST and COALESCE policies.
+    std::atomic<std::uint64_t> droppedCount;
+
+    LatencyHistogram analyzerLatency;
+
+    // Runs ready analyzers until stop is requested.
+    void runWorker();
+
+    // Puts single reading into analyzer queue according to its policy. Queue has to be locked
+    // and for BLOCK policy it must have free space.
+    void enqueue(AnalyzerEntry& entry, const SerialSample& sample, SampleTimestamp dispatchTime);
+
+    // Adds entry to readyEntries and wakes up a worker.
+    void schedule(const std::shared_ptr<AnalyzerEntry>& entry);
+};
+
+#endif /* ANALYZERDISPATCHER_H_ */
@@ -0,0 +1,66 @@
+/*
+ * AsyncExecutor.cpp
+ */
+
+#include "AsyncExecutor.h"
+
+#include <algorithm>
+
+AsyncExecutor::AsyncExecutor(std::size_t threadCount)
+    :stopRequested(false) {
+    threadCount = std::max<std::size_t>(threadCount, 1);
+
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        this->threads.push_back(std::make_unique<std::thread>([this] { this->runThread(); }));
+    }
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    {
+        std::scoped_lock executorLock(this->executorMutex);
+        this->stopRequested = true;
+    }
+    this->coroutinesReady.notify_all();
+
+    for (std::unique_ptr<std::thread>& thread : this->threads) {
+        thread->join();
+    }
+}
+
+void AsyncExecutor::post(std::coroutine_handle<> handle) {
+    {
+        std::scoped_lock executorLock(this->executorMutex);
+        this->readyCoroutines.push_back(handle);
+    }
+    this->coroutinesReady.notify_one();
+}
+
+AsyncExecutor::ScheduleAwaiter AsyncExecutor::schedule() {
+    return ScheduleAwaiter(*this);
+}
+
+std::size_t AsyncExecutor::getThreadCount() const {
+    return this->threads.size();
+}
+
+void AsyncExecutor::runThread() {
+    std::unique_lock<std::mutex> executorLock(this->executorMutex);
+
+    while (true) {
+        this->coroutinesReady.wait(executorLock, [this] {
+            return !this->readyCoroutines.empty() || this->stopRequested;
+        });
+
+        // Coroutines posted before stopping are still resumed, so they are not leaked.
+        if (this->readyCoroutines.empty()) {
+            return;
+        }
+
+        std::coroutine_handle<> handle = this->readyCoroutines.front();
+        this->readyCoroutines.pop_front();
+
+        executorLock.unlock();
+        handle.resume();
+        executorLock.lock();
+    }
+}
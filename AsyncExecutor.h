@@ -0,0 +1,88 @@
+/*
+ * AsyncExecutor.h
+ *
+ * Executor of coroutines (see AsyncTask) - a few threads resuming coroutines which are ready
+ * to run. Coroutine waiting for readings (see AsyncSampleReader) does not hold any thread,
+ * so any amount of ports and analyzers written as straight-line coroutines share the executor threads.
+ *
+ * Executor has to outlive coroutines using it. Coroutines which are ready to run when executor
+ * is destroyed are still resumed, suspended ones should be woken up before (e.g. by destroying
+ * readers they wait for).
+ */
+
+#ifndef ASYNCEXECUTOR_H_
+#define ASYNCEXECUTOR_H_
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AsyncExecutor {
+public:
+    // Awaitable moving coroutine to executor thread, see schedule().
+    class ScheduleAwaiter {
+    public:
+        explicit ScheduleAwaiter(AsyncExecutor& executor)
+            :executor(executor) {
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            this->executor.post(handle);
+        }
+
+        void await_resume() const noexcept {
+        }
+
+    private:
+        AsyncExecutor& executor;
+    };
+
+    // threadCount - amount of threads resuming coroutines (at least 1)
+    explicit AsyncExecutor(std::size_t threadCount = 1);
+
+    // Resumes coroutines which are ready to run and stops threads.
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    /**
+     * Queues suspended coroutine to be resumed on one of executor threads. Can be called from any thread.
+     * param: handle - coroutine suspended waiting for that call
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * Returns awaitable which continues coroutine on executor thread:
+     *     co_await executor.schedule();
+     */
+    ScheduleAwaiter schedule();
+
+    // Returns amount of executor threads.
+    std::size_t getThreadCount() const;
+
+private:
+    // Coroutines ready to run, in order of posting.
+    std::deque<std::coroutine_handle<>> readyCoroutines;
+
+    bool stopRequested;
+
+    std::mutex executorMutex;
+    std::condition_variable coroutinesReady;
+
+    std::vector<std::unique_ptr<std::thread>> threads;
+
+    // Resumes ready coroutines until executor is stopped.
+    void runThread();
+};
+
+#endif /* ASYNCEXECUTOR_H_ */
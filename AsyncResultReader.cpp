@@ -0,0 +1,28 @@
+/*
+ * AsyncResultReader.cpp
+ */
+
+#include "AsyncResultReader.h"
+
+AsyncResultReader::AsyncResultReader(SerialPortDataAnalyzer& analyzer, AsyncExecutor& executor, std::size_t capacity)
+    :analyzer(analyzer)
+    ,resultQueue(executor, capacity)
+    ,subscriptionId(0) {
+    this->subscriptionId = this->analyzer.subscribe([this](const SerialSample* results, std::size_t count) {
+        this->resultQueue.push(results, count);
+    });
+}
+
+AsyncResultReader::~AsyncResultReader() {
+    // Callback is not running after unsubscribing, so coroutine can be woken up for the last time.
+    this->analyzer.unsubscribe(this->subscriptionId);
+    this->resultQueue.close();
+}
+
+AsyncSampleQueue::NextBatchAwaiter AsyncResultReader::nextResults() {
+    return this->resultQueue.nextBatch();
+}
+
+std::uint64_t AsyncResultReader::getDroppedCount() const {
+    return this->resultQueue.getDroppedCount();
+}
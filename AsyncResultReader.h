@@ -0,0 +1,65 @@
+/*
+ * AsyncResultReader.h
+ *
+ * Gives processed values of an analyzer (see SerialPortDataAnalyzer::subscribe()) to a coroutine:
+ *
+ *   AsyncTask printFiltered(AsyncResultReader& medianResults) {
+ *       std::vector<SerialSample> results;
+ *       while (!(results = co_await medianResults.nextResults()).empty()) {
+ *           ...
+ *       }
+ *   }
+ *
+ * Every value computed by the analyzer is delivered, waiting coroutine does not hold any thread.
+ */
+
+#ifndef ASYNCRESULTREADER_H_
+#define ASYNCRESULTREADER_H_
+
+#include <cstdint>
+
+#include "AsyncExecutor.h"
+#include "AsyncSampleQueue.h"
+#include "ResultPublisher.h"
+#include "SerialPortDataAnalyzer.h"
+
+class AsyncResultReader {
+public:
+
+    /**
+     * Subscribes to results of analyzer.
+     *
+     * params:
+     * analyzer - analyzer whose results are read, has to outlive the reader
+     * executor - executor running coroutine awaiting results, has to outlive the reader
+     * capacity - maximal amount of results waiting for coroutine, the oldest ones are dropped above it
+     */
+    AsyncResultReader(SerialPortDataAnalyzer& analyzer, AsyncExecutor& executor,
+                      std::size_t capacity = AsyncSampleQueue::DEFAULT_CAPACITY);
+
+    // Unsubscribes, waiting coroutine is resumed with empty batch.
+    ~AsyncResultReader();
+
+    AsyncResultReader(const AsyncResultReader&) = delete;
+    AsyncResultReader& operator=(const AsyncResultReader&) = delete;
+
+    /**
+     * Returns awaitable giving all results (filtered values and status samples) published since
+     * the previous call. Coroutine is suspended until they come.
+     * Empty batch means that reader is being destroyed.
+     */
+    AsyncSampleQueue::NextBatchAwaiter nextResults();
+
+    // Returns amount of results dropped because coroutine did not keep up.
+    std::uint64_t getDroppedCount() const;
+
+private:
+    SerialPortDataAnalyzer& analyzer;
+
+    // Results waiting for coroutine.
+    AsyncSampleQueue resultQueue;
+
+    SubscriptionId subscriptionId;
+};
+
+#endif /* ASYNCRESULTREADER_H_ */
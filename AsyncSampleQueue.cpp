@@ -0,0 +1,91 @@
+/*
+ * AsyncSampleQueue.cpp
+ */
+
+#include "AsyncSampleQueue.h"
+
+const std::size_t AsyncSampleQueue::DEFAULT_CAPACITY;
+
+AsyncSampleQueue::AsyncSampleQueue(AsyncExecutor& executor, std::size_t capacity)
+    :executor(executor)
+    ,capacity(capacity > 0 ? capacity : 1)
+    ,closed(false)
+    ,waitingAwaiter(nullptr)
+    ,droppedCount(0) {
+}
+
+AsyncSampleQueue::~AsyncSampleQueue() {
+    this->close();
+}
+
+AsyncSampleQueue::NextBatchAwaiter AsyncSampleQueue::nextBatch() {
+    return NextBatchAwaiter(*this);
+}
+
+void AsyncSampleQueue::push(const SerialSample* samples, std::size_t count) {
+    std::scoped_lock queueLock(this->queueMutex);
+
+    if (this->closed || count == 0) {
+        return;
+    }
+
+    // Waiting coroutine means that nothing is queued - samples go straight to it.
+    if (this->waitingAwaiter != nullptr) {
+        this->waitingAwaiter->batch.assign(samples, samples + count);
+        this->resumeWaiter();
+        return;
+    }
+
+    // Oldest samples are dropped when coroutine does not keep up.
+    if (count > this->capacity) {
+        this->droppedCount.fetch_add(count - this->capacity, std::memory_order_relaxed);
+        samples += count - this->capacity;
+        count = this->capacity;
+    }
+    std::size_t overflow = this->pendingSamples.size() + count;
+    if (overflow > this->capacity) {
+        overflow -= this->capacity;
+        this->pendingSamples.erase(this->pendingSamples.begin(), this->pendingSamples.begin() + overflow);
+        this->droppedCount.fetch_add(overflow, std::memory_order_relaxed);
+    }
+    this->pendingSamples.insert(this->pendingSamples.end(), samples, samples + count);
+}
+
+void AsyncSampleQueue::close() {
+    std::scoped_lock queueLock(this->queueMutex);
+
+    this->closed = true;
+    if (this->waitingAwaiter != nullptr) {
+        this->resumeWaiter();
+    }
+}
+
+std::uint64_t AsyncSampleQueue::getDroppedCount() const {
+    return this->droppedCount.load(std::memory_order_relaxed);
+}
+
+bool AsyncSampleQueue::suspendWaiter(NextBatchAwaiter& awaiter, std::coroutine_handle<> handle) {
+    std::scoped_lock queueLock(this->queueMutex);
+
+    // Queued samples are taken at once, coroutine continues without suspending.
+    if (!this->pendingSamples.empty()) {
+        awaiter.batch.assign(this->pendingSamples.begin(), this->pendingSamples.end());
+        this->pendingSamples.clear();
+        return false;
+    }
+
+    // Closed queue gives empty batch.
+    if (this->closed) {
+        return false;
+    }
+
+    this->waitingAwaiter = &awaiter;
+    this->waitingCoroutine = handle;
+    return true;
+}
+
+void AsyncSampleQueue::resumeWaiter() {
+    this->executor.post(this->waitingCoroutine);
+    this->waitingAwaiter = nullptr;
+    this->waitingCoroutine = nullptr;
+}
@@ -0,0 +1,121 @@
+/*
+ * AsyncSampleQueue.h
+ *
+ * Queue of readings or analyzer results awaited by a coroutine:
+ *     std::vector<SerialSample> samples = co_await queue.nextBatch();
+ *
+ * Producers (dispatcher worker threads) never wait - pushed samples either go straight to
+ * the waiting coroutine, which is then resumed on executor thread, or are queued until it asks
+ * for them. When coroutine does not keep up, the oldest queued samples are dropped.
+ *
+ * Only one coroutine can wait for the queue at a time.
+ */
+
+#ifndef ASYNCSAMPLEQUEUE_H_
+#define ASYNCSAMPLEQUEUE_H_
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "AsyncExecutor.h"
+#include "SerialSample.h"
+
+class AsyncSampleQueue {
+public:
+    // Default maximal amount of samples waiting for coroutine.
+    static const std::size_t DEFAULT_CAPACITY = 4096;
+
+    // Awaitable returned by nextBatch(). Samples are handed over to the awaiter itself,
+    // so resumed coroutine does not touch the queue (it can be already destroyed after close()).
+    class NextBatchAwaiter {
+    public:
+        explicit NextBatchAwaiter(AsyncSampleQueue& queue)
+            :queue(queue) {
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return this->queue.suspendWaiter(*this, handle);
+        }
+
+        std::vector<SerialSample> await_resume() {
+            return std::move(this->batch);
+        }
+
+    private:
+        friend class AsyncSampleQueue;
+
+        AsyncSampleQueue& queue;
+        std::vector<SerialSample> batch;
+    };
+
+    /**
+     * params:
+     * executor - executor resuming waiting coroutine
+     * capacity - maximal amount of waiting samples, the oldest ones are dropped above it
+     */
+    AsyncSampleQueue(AsyncExecutor& executor, std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Closes queue, waiting coroutine is resumed with empty batch.
+    ~AsyncSampleQueue();
+
+    AsyncSampleQueue(const AsyncSampleQueue&) = delete;
+    AsyncSampleQueue& operator=(const AsyncSampleQueue&) = delete;
+
+    /**
+     * Returns awaitable giving all samples queued since the previous call, in order of pushing.
+     * When there are none coroutine is suspended until they come.
+     * Empty batch means that queue was closed and no samples will come anymore.
+     */
+    NextBatchAwaiter nextBatch();
+
+    /**
+     * Queues samples or passes them to waiting coroutine. Can be called from any thread.
+     *
+     * params:
+     * samples - samples in order of arrival
+     * count - amount of samples, nothing is done for 0
+     */
+    void push(const SerialSample* samples, std::size_t count);
+
+    // Resumes waiting coroutine with samples left in queue or empty batch. Samples pushed later are ignored.
+    void close();
+
+    // Returns amount of samples dropped because coroutine did not keep up.
+    std::uint64_t getDroppedCount() const;
+
+private:
+    AsyncExecutor& executor;
+
+    std::deque<SerialSample> pendingSamples;
+    std::size_t capacity;
+    bool closed;
+
+    // Coroutine waiting for samples (nullptr when there is none) and its awaiter.
+    NextBatchAwaiter* waitingAwaiter;
+    std::coroutine_handle<> waitingCoroutine;
+
+    std::atomic<std::uint64_t> droppedCount;
+
+    std::mutex queueMutex;
+
+    /**
+     * Hands queued samples to awaiter or registers it as waiting.
+     * returns: true when coroutine has to be suspended
+     */
+    bool suspendWaiter(NextBatchAwaiter& awaiter, std::coroutine_handle<> handle);
+
+    // Resumes waiting coroutine on executor thread. Lock queueMutex before calling.
+    void resumeWaiter();
+};
+
+#endif /* ASYNCSAMPLEQUEUE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * AsyncSampleReader.cpp
+ */
+
+#include "AsyncSampleReader.h"
+
+#include <iostream>
+
+AsyncSampleReader::AsyncSampleReader(const std::shared_ptr<SampleSource>& serialReader, AsyncExecutor& executor,
+                                     std::size_t capacity)
+    :SerialPortDataAnalyzer(serialReader)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,sampleQueue(executor, capacity) {
+    if (this->registerToSerialReader(this) == false) {
+        std::cout << "Error: registering to serial reader failed." << std::endl;
+    }
+}
+
+AsyncSampleReader::~AsyncSampleReader() {
+    // No readings come after deregistering, so coroutine can be woken up for the last time.
+    this->deregisterFromSerialReader(this);
+    this->sampleQueue.close();
+}
+
+AsyncSampleQueue::NextBatchAwaiter AsyncSampleReader::nextBatch() {
+    return this->sampleQueue.nextBatch();
+}
+
+std::uint64_t AsyncSampleReader::getDroppedCount() const {
+    return this->sampleQueue.getDroppedCount();
+}
+
+std::pair<SampleTimestamp, double> AsyncSampleReader::getRawData() {
+    TimestampedValue result = this->rawResult.load();
+
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
+}
+
+std::pair<SampleTimestamp, double> AsyncSampleReader::getProcessedData() {
+    return this->getRawData();
+}
+
+void AsyncSampleReader::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
+
+void AsyncSampleReader::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    // Raw value reflects the last reading of the block.
+    const SerialSample& lastSample = samples[count - 1];
+    if (lastSample.status != SampleStatus::VALUE) {
+        this->rawResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    }
+    else {
+        this->rawResult.store(TimestampedValue{ lastSample.timestamp, lastSample.value });
+    }
+
+    this->sampleQueue.push(samples, count);
+}
+
+bool AsyncSampleReader::receivesAllChannels() const {
+    return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * AsyncSampleReader.h
+ *
+ * Analyzer giving readings of its source to a coroutine (see AsyncTask), so processing
+ * of a port can be written as straight-line code:
+ *
+ *   AsyncTask printPort(AsyncSampleReader& reader) {
+ *       while (true) {
+ *           std::vector<SerialSample> readings = co_await reader.nextBatch();
+ *           if (readings.empty()) {
+ *               co_return;     // reader was destroyed
+ *           }
+ *           for (const SerialSample& reading : readings) {
+ *               ...
+ *           }
+ *       }
+ *   }
+ *
+ * Waiting coroutine does not hold any thread. With SerialPortManager (all ports read by one thread)
+ * and a reader per port, any amount of ports is handled by a few executor threads.
+ */
+
+#ifndef ASYNCSAMPLEREADER_H_
+#define ASYNCSAMPLEREADER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "AsyncExecutor.h"
+#include "AsyncSampleQueue.h"
+#include "SeqLock.h"
+#include "SerialPortDataAnalyzer.h"
+
+class AsyncSampleReader: public SerialPortDataAnalyzer {
+public:
+
+    /**
+     * Creates reader and registers it to serial reader.
+     *
+     * params:
+     * serialReader - serial reader object or other source of readings (see SampleSource)
+     * executor - executor running coroutine awaiting readings, has to outlive the reader
+     * capacity - maximal amount of readings waiting for coroutine, the oldest ones are dropped above it
+     */
+    AsyncSampleReader(const std::shared_ptr<SampleSource>& serialReader, AsyncExecutor& executor,
+                      std::size_t capacity = AsyncSampleQueue::DEFAULT_CAPACITY);
+
+    // Deregisters reader, waiting coroutine is resumed with empty batch.
+    virtual ~AsyncSampleReader();
+
+    /**
+     * Returns awaitable giving all readings (values and status readings, every channel of multi-channel
+     * messages) received since the previous call. Coroutine is suspended until they come.
+     * Empty batch means that reader is being destroyed.
+     */
+    AsyncSampleQueue::NextBatchAwaiter nextBatch();
+
+    // Returns amount of readings dropped because coroutine did not keep up.
+    std::uint64_t getDroppedCount() const;
+
+    /**
+     *  Get latest read from serial port with timestamp.
+     *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet,
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getRawData();
+
+    /**
+     *  Reader does not process data, so it returns the same value as getRawData().
+     */
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
+
+private:
+
+    // Latest raw value ({-1,0} after status reading), read by getRawData() without locking
+    SeqLock<TimestampedValue> rawResult;
+
+    // Readings waiting for coroutine.
+    AsyncSampleQueue sampleQueue;
+
+    /**
+     * Method used by Serial object to send latest data to analyzer.
+     *
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, whole block is handed
+     * to coroutine at once.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    // Coroutine gets every channel of multi-channel messages.
+    virtual bool receivesAllChannels() const;
+};
+
+#endif /* ASYNCSAMPLEREADER_H_ */
@@ -0,0 +1,71 @@
+/*
+ * AsyncTask.cpp
+ */
+
+#include "AsyncTask.h"
+
+#include <utility>
+
+AsyncTask::AsyncTask(std::coroutine_handle<promise_type> handle, const std::shared_ptr<CompletionState>& completion)
+    :handle(handle)
+    ,completion(completion) {
+}
+
+AsyncTask::AsyncTask(AsyncTask&& other) noexcept
+    :handle(std::exchange(other.handle, nullptr))
+    ,completion(std::move(other.completion)) {
+}
+
+AsyncTask& AsyncTask::operator=(AsyncTask&& other) noexcept {
+    if (this != &other) {
+        if (this->handle) {
+            this->handle.destroy();
+        }
+        this->handle = std::exchange(other.handle, nullptr);
+        this->completion = std::move(other.completion);
+    }
+    return *this;
+}
+
+AsyncTask::~AsyncTask() {
+    if (this->handle) {
+        this->handle.destroy();
+    }
+}
+
+void AsyncTask::start(AsyncExecutor& executor) {
+    if (!this->handle) {
+        return;
+    }
+
+    // From now on coroutine frame belongs to the coroutine itself.
+    executor.post(std::exchange(this->handle, nullptr));
+}
+
+void AsyncTask::wait() {
+    if (!this->completion || this->handle) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> completionLock(this->completion->completionMutex);
+    this->completion->completed.wait(completionLock, [this] {
+        return this->completion->done;
+    });
+}
+
+bool AsyncTask::isDone() {
+    if (!this->completion) {
+        return true;
+    }
+
+    std::scoped_lock completionLock(this->completion->completionMutex);
+    return this->completion->done;
+}
+
+void AsyncTask::finish(CompletionState& completion) {
+    {
+        std::scoped_lock completionLock(completion.completionMutex);
+        completion.done = true;
+    }
+    completion.completed.notify_all();
+}
@@ -0,0 +1,106 @@
+/*
+ * AsyncTask.h
+ *
+ * Coroutine run by AsyncExecutor. Any function returning AsyncTask can use co_await, e.g.:
+ *
+ *   AsyncTask filterPort(AsyncSampleReader& reader) {
+ *       while (true) {
+ *           std::vector<SerialSample> readings = co_await reader.nextBatch();
+ *           if (readings.empty()) {
+ *               co_return;     // reader was closed
+ *           }
+ *           ...
+ *       }
+ *   }
+ *
+ *   AsyncTask task = filterPort(reader);
+ *   task.start(executor);
+ *
+ * Coroutine does not run until start() is called. Started coroutine frame is destroyed as soon
+ * as coroutine finishes, AsyncTask object only allows to wait for that.
+ * Coroutines should not throw - exception leaving coroutine terminates application.
+ */
+
+#ifndef ASYNCTASK_H_
+#define ASYNCTASK_H_
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "AsyncExecutor.h"
+
+class AsyncTask {
+private:
+    // Completion flag shared by coroutine and AsyncTask object, which can be destroyed in any order.
+    struct CompletionState {
+        bool done = false;
+        std::mutex completionMutex;
+        std::condition_variable completed;
+    };
+
+public:
+    struct promise_type {
+        std::shared_ptr<CompletionState> completion = std::make_shared<CompletionState>();
+
+        // Promise is destroyed together with coroutine frame, after all coroutine locals.
+        ~promise_type() {
+            AsyncTask::finish(*this->completion);
+        }
+
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this), this->completion);
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+    AsyncTask(AsyncTask&& other) noexcept;
+    AsyncTask& operator=(AsyncTask&& other) noexcept;
+
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    // Destroys coroutine which was not started, started one keeps running.
+    ~AsyncTask();
+
+    /**
+     * Starts coroutine on executor thread. Does nothing when coroutine was started already.
+     * param: executor - executor resuming the coroutine, has to outlive it
+     */
+    void start(AsyncExecutor& executor);
+
+    // Blocks until coroutine finishes (returns at once for coroutine which was not started).
+    void wait();
+
+    // Checks if coroutine finished.
+    bool isDone();
+
+private:
+    // Coroutine which was not started yet, empty afterwards.
+    std::coroutine_handle<promise_type> handle;
+
+    std::shared_ptr<CompletionState> completion;
+
+    AsyncTask(std::coroutine_handle<promise_type> handle, const std::shared_ptr<CompletionState>& completion);
+
+    // Marks coroutine as finished and wakes up waiting threads.
+    static void finish(CompletionState& completion);
+};
+
+#endif /* ASYNCTASK_H_ */
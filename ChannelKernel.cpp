@@ -0,0 +1,159 @@
+/*
+ * ChannelKernel.cpp
+ */
+
+#include "ChannelKernel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ChannelWindow.h"
+#include "FixedWindowChannelMedian.h"
+#include "SlidingMedian.h"
+
+namespace {
+    // Median of window of any width - one SlidingMedian per channel.
+    class SlidingChannelMedian: public ChannelKernel {
+    public:
+        SlidingChannelMedian(unsigned int windowWidth, std::size_t channelCount)
+            :medianWindows(std::max<std::size_t>(channelCount, 1), SlidingMedian(windowWidth)) {
+        }
+
+        virtual void push(SampleTimestamp timestamp, const double* values) {
+            for (std::size_t channel = 0; channel < this->medianWindows.size(); ++channel) {
+                this->medianWindows[channel].push(timestamp, values[channel]);
+            }
+        }
+
+        virtual void clear() {
+            for (SlidingMedian& medianWindow : this->medianWindows) {
+                medianWindow.clear();
+            }
+        }
+
+        virtual bool isFull() const {
+            return this->medianWindows.front().isFull();
+        }
+
+        virtual void computeResults(double* results) {
+            for (std::size_t channel = 0; channel < this->medianWindows.size(); ++channel) {
+                results[channel] = this->medianWindows[channel].getMedian();
+            }
+        }
+
+        virtual SampleTimestamp getCenterTimestamp() const {
+            return this->medianWindows.front().getCenterTimestamp();
+        }
+
+    private:
+        std::vector<SlidingMedian> medianWindows;
+    };
+
+    // Average of window of any width - running sums of all channels updated with one loop.
+    class ChannelAverage: public ChannelKernel {
+    public:
+        ChannelAverage(unsigned int windowWidth, std::size_t channelCount)
+            :window(windowWidth, channelCount)
+            ,sums(this->window.getChannelCount(), 0)
+            ,updatesSinceResync(0)
+            ,resyncInterval(std::max<std::size_t>(this->window.getWidth(), MIN_RESYNC_INTERVAL)) {
+        }
+
+        virtual void push(SampleTimestamp timestamp, const double* values) {
+            std::size_t channelCount = this->window.getChannelCount();
+            double* sums = this->sums.data();
+
+            if (this->window.isFull()) {
+                const double* oldest = this->window.getOldest();
+                for (std::size_t channel = 0; channel < channelCount; ++channel) {
+                    sums[channel] += values[channel] - oldest[channel];
+                }
+            }
+            else {
+                for (std::size_t channel = 0; channel < channelCount; ++channel) {
+                    sums[channel] += values[channel];
+                }
+            }
+            this->window.push(timestamp, values);
+
+            // Rounding errors of add/subtract pairs accumulate, sums are recomputed from time to time.
+            if (++this->updatesSinceResync >= this->resyncInterval) {
+                this->resync();
+            }
+        }
+
+        virtual void clear() {
+            this->window.clear();
+            std::fill(this->sums.begin(), this->sums.end(), 0);
+            this->updatesSinceResync = 0;
+        }
+
+        virtual bool isFull() const {
+            return this->window.isFull();
+        }
+
+        // For not full window - average of values received so far.
+        virtual void computeResults(double* results) {
+            std::size_t messageCount = this->window.getMessageCount();
+            for (std::size_t channel = 0; channel < this->sums.size(); ++channel) {
+                results[channel] = (messageCount == 0) ? 0 : this->sums[channel] / messageCount;
+            }
+        }
+
+        virtual SampleTimestamp getCenterTimestamp() const {
+            return this->window.getCenterTimestamp();
+        }
+
+    private:
+        // Lower bound of updates between recomputing sums, keeps resync cost small for narrow windows.
+        static constexpr std::size_t MIN_RESYNC_INTERVAL = 4096;
+
+        ChannelWindow window;
+
+        // Sum of window values of every channel.
+        std::vector<double> sums;
+
+        std::size_t updatesSinceResync;
+        std::size_t resyncInterval;
+
+        void resync() {
+            std::size_t channelCount = this->window.getChannelCount();
+            const double* values = this->window.getValues();
+            double* sums = this->sums.data();
+
+            std::fill(this->sums.begin(), this->sums.end(), 0);
+            for (std::size_t row = 0; row < this->window.getMessageCount(); ++row) {
+                for (std::size_t channel = 0; channel < channelCount; ++channel) {
+                    sums[channel] += values[row * channelCount + channel];
+                }
+            }
+            this->updatesSinceResync = 0;
+        }
+    };
+}
+
+ChannelKernel::~ChannelKernel() {
+    // Base class does not own any resources.
+}
+
+std::unique_ptr<ChannelKernel> ChannelKernel::createMedian(unsigned int windowWidth, std::size_t channelCount) {
+    // Keep in line with FilterKernel::FIXED_WINDOW_WIDTHS.
+    switch (windowWidth) {
+    case 3:
+        return std::make_unique<FixedWindowChannelMedian<3>>(channelCount);
+    case 5:
+        return std::make_unique<FixedWindowChannelMedian<5>>(channelCount);
+    case 7:
+        return std::make_unique<FixedWindowChannelMedian<7>>(channelCount);
+    case 9:
+        return std::make_unique<FixedWindowChannelMedian<9>>(channelCount);
+    case 15:
+        return std::make_unique<FixedWindowChannelMedian<15>>(channelCount);
+    default:
+        return std::make_unique<SlidingChannelMedian>(windowWidth, channelCount);
+    }
+}
+
+std::unique_ptr<ChannelKernel> ChannelKernel::createAverage(unsigned int windowWidth, std::size_t channelCount) {
+    return std::make_unique<ChannelAverage>(windowWidth, channelCount);
+}
@@ -0,0 +1,68 @@
+/*
+ * ChannelKernel.h
+ *
+ * Multi-channel counterpart of FilterKernel - filters all channels of a device at once,
+ * every channel has its own window of values.
+ *
+ * Factory methods pick median kernel specialized at compile time for common window widths
+ * (FilterKernel::FIXED_WINDOW_WIDTHS), which selects medians of all channels with a single
+ * sorting network run over channel lanes (see FixedWindowChannelMedian). Average of any width
+ * updates running sums of all channels with one loop.
+ */
+
+#ifndef CHANNELKERNEL_H_
+#define CHANNELKERNEL_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "SampleClock.h"
+
+class ChannelKernel {
+public:
+    virtual ~ChannelKernel();
+
+    /**
+     * Adds newest message to the window, oldest one is removed when window is full.
+     *
+     * params:
+     * timestamp - timestamp of message
+     * values - values of all channels
+     */
+    virtual void push(SampleTimestamp timestamp, const double* values) = 0;
+
+    // Removes all messages from the window.
+    virtual void clear() = 0;
+
+    // Checks if window holds windowWidth messages already.
+    virtual bool isFull() const = 0;
+
+    /**
+     * Computes filtered value of every channel (valid only when window is full).
+     * param: results - output array, one value per channel
+     */
+    virtual void computeResults(double* results) = 0;
+
+    // Returns timestamp of message from the middle of the window (valid only when window is full).
+    virtual SampleTimestamp getCenterTimestamp() const = 0;
+
+    /**
+     * Creates median of last windowWidth values of every channel.
+     *
+     * params:
+     * windowWidth - amount of values median is computed from (at least 1)
+     * channelCount - amount of channels (at least 1)
+     */
+    static std::unique_ptr<ChannelKernel> createMedian(unsigned int windowWidth, std::size_t channelCount);
+
+    /**
+     * Creates average of last windowWidth values of every channel.
+     *
+     * params:
+     * windowWidth - amount of values that are averaged (at least 1)
+     * channelCount - amount of channels (at least 1)
+     */
+    static std::unique_ptr<ChannelKernel> createAverage(unsigned int windowWidth, std::size_t channelCount);
+};
+
+#endif /* CHANNELKERNEL_H_ */
@@ -0,0 +1,60 @@
+/*
+ * ChannelWindow.cpp
+ */
+
+#include "ChannelWindow.h"
+
+#include <algorithm>
+
+ChannelWindow::ChannelWindow(unsigned int windowWidth, std::size_t channelCount)
+    :width(std::max(windowWidth, 1u))
+    ,channelCount(std::max<std::size_t>(channelCount, 1))
+    ,timestamps(this->width, INVALID_TIMESTAMP)
+    ,values(this->width * this->channelCount, 0)
+    ,nextIndex(0)
+    ,messageCount(0) {
+}
+
+void ChannelWindow::push(SampleTimestamp timestamp, const double* values) {
+    std::copy(values, values + this->channelCount, this->values.begin() + this->nextIndex * this->channelCount);
+    this->timestamps[this->nextIndex] = timestamp;
+    this->nextIndex = (this->nextIndex + 1 == this->width) ? 0 : this->nextIndex + 1;
+
+    if (this->messageCount < this->width) {
+        ++this->messageCount;
+    }
+}
+
+void ChannelWindow::clear() {
+    this->nextIndex = 0;
+    this->messageCount = 0;
+}
+
+bool ChannelWindow::isFull() const {
+    return this->messageCount == this->width;
+}
+
+std::size_t ChannelWindow::getWidth() const {
+    return this->width;
+}
+
+std::size_t ChannelWindow::getChannelCount() const {
+    return this->channelCount;
+}
+
+std::size_t ChannelWindow::getMessageCount() const {
+    return this->messageCount;
+}
+
+const double* ChannelWindow::getValues() const {
+    return this->values.data();
+}
+
+const double* ChannelWindow::getOldest() const {
+    return this->values.data() + this->nextIndex * this->channelCount;
+}
+
+SampleTimestamp ChannelWindow::getCenterTimestamp() const {
+    // When window is full nextIndex points at the oldest message.
+    return this->timestamps[(this->nextIndex + this->width / 2) % this->width];
+}
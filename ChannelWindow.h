@@ -0,0 +1,70 @@
+/*
+ * ChannelWindow.h
+ *
+ * Window of latest messages of multi-channel device (see FrameFormat::channelCount).
+ *
+ * Readings are kept as structure of arrays - timestamps in one array, values in another - instead
+ * of array of SerialSample structures. Values array holds a row per message with all its channels
+ * next to each other, so filters update every channel with one loop over contiguous memory.
+ */
+
+#ifndef CHANNELWINDOW_H_
+#define CHANNELWINDOW_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "SampleClock.h"
+
+class ChannelWindow {
+public:
+    /**
+     * params:
+     * windowWidth - amount of messages in the window (at least 1)
+     * channelCount - amount of values in every message (at least 1)
+     */
+    ChannelWindow(unsigned int windowWidth, std::size_t channelCount);
+
+    /**
+     * Adds newest message to the window, oldest one is removed when window is full.
+     *
+     * params:
+     * timestamp - timestamp of message
+     * values - channelCount values of message
+     */
+    void push(SampleTimestamp timestamp, const double* values);
+
+    // Removes all messages from the window.
+    void clear();
+
+    // Checks if window holds windowWidth messages already.
+    bool isFull() const;
+
+    std::size_t getWidth() const;
+    std::size_t getChannelCount() const;
+
+    // Returns amount of messages in the window.
+    std::size_t getMessageCount() const;
+
+    // Returns values of all messages, row after row (rows are not in order of arrival).
+    // Only getMessageCount() first rows are valid when window is not full.
+    const double* getValues() const;
+
+    // Returns values of the oldest message - the one removed by next push (valid only when window is full).
+    const double* getOldest() const;
+
+    // Returns timestamp of message from the middle of the window (valid only when window is full).
+    SampleTimestamp getCenterTimestamp() const;
+
+private:
+    std::size_t width;
+    std::size_t channelCount;
+
+    // Circular buffer of rows, nextIndex points at the oldest row once buffer is full.
+    std::vector<SampleTimestamp> timestamps;
+    std::vector<double> values;
+    std::size_t nextIndex;
+    std::size_t messageCount;
+};
+
+#endif /* CHANNELWINDOW_H_ */
@@ -0,0 +1,27 @@
+/*
+ * DecimatorStage.cpp
+ */
+
+#include "DecimatorStage.h"
+
+DecimatorStage::DecimatorStage(unsigned int factor)
+    :factor((factor > 0) ? factor : 1)
+    ,skippedValues(0) {
+    // The first value is passed.
+    this->reset();
+}
+
+bool DecimatorStage::process(const TimestampedValue& input, TimestampedValue& output) {
+    if (this->skippedValues + 1 < this->factor) {
+        ++this->skippedValues;
+        return false;
+    }
+
+    this->skippedValues = 0;
+    output = input;
+    return true;
+}
+
+void DecimatorStage::reset() {
+    this->skippedValues = this->factor - 1;
+}
@@ -0,0 +1,29 @@
+/*
+ * DecimatorStage.h
+ *
+ * Passes every factor-th value (starting with the first one) and drops the other ones,
+ * e.g. to lower rate of values after low-pass filter stage.
+ */
+
+#ifndef DECIMATORSTAGE_H_
+#define DECIMATORSTAGE_H_
+
+#include "FilterStage.h"
+
+class DecimatorStage: public FilterStage {
+public:
+    // factor - one of that many values is passed (at least 1)
+    explicit DecimatorStage(unsigned int factor);
+
+    virtual bool process(const TimestampedValue& input, TimestampedValue& output);
+
+    virtual void reset();
+
+private:
+    unsigned int factor;
+
+    // Amount of values dropped since the last passed one.
+    unsigned int skippedValues;
+};
+
+#endif /* DECIMATORSTAGE_H_ */
@@ -0,0 +1,122 @@
+/*
+ * FilterKernel.cpp
+ */
+
+#include "FilterKernel.h"
+
+#include <algorithm>
+
+#include "FixedWindowAverage.h"
+#include "FixedWindowMedian.h"
+#include "SlidingAverage.h"
+#include "SlidingMedian.h"
+
+constexpr std::array<unsigned int, 5> FilterKernel::FIXED_WINDOW_WIDTHS;
+
+namespace {
+    // Median of window of any width.
+    class SlidingMedianKernel: public FilterKernel {
+    public:
+        explicit SlidingMedianKernel(unsigned int windowWidth)
+            :medianWindow(windowWidth) {
+        }
+
+        virtual void push(SampleTimestamp timestamp, double value) {
+            this->medianWindow.push(timestamp, value);
+        }
+
+        virtual void clear() {
+            this->medianWindow.clear();
+        }
+
+        virtual bool isFull() const {
+            return this->medianWindow.isFull();
+        }
+
+        virtual double getResult() const {
+            return this->medianWindow.getMedian();
+        }
+
+        virtual SampleTimestamp getCenterTimestamp() const {
+            return this->medianWindow.getCenterTimestamp();
+        }
+
+    private:
+        SlidingMedian medianWindow;
+    };
+
+    // Average of window of any width.
+    class SlidingAverageKernel: public FilterKernel {
+    public:
+        explicit SlidingAverageKernel(unsigned int windowWidth)
+            :averagingWindow(windowWidth) {
+        }
+
+        virtual void push(SampleTimestamp timestamp, double value) {
+            this->averagingWindow.push(timestamp, value);
+        }
+
+        virtual void clear() {
+            this->averagingWindow.clear();
+        }
+
+        virtual bool isFull() const {
+            return this->averagingWindow.isFull();
+        }
+
+        virtual double getResult() const {
+            return this->averagingWindow.getAverage();
+        }
+
+        virtual SampleTimestamp getCenterTimestamp() const {
+            return this->averagingWindow.getCenterTimestamp();
+        }
+
+    private:
+        SlidingAverage averagingWindow;
+    };
+}
+
+FilterKernel::~FilterKernel() {
+    // Base class does not own any resources.
+}
+
+bool FilterKernel::hasFixedWindowKernel(unsigned int windowWidth) {
+    return std::find(FIXED_WINDOW_WIDTHS.begin(), FIXED_WINDOW_WIDTHS.end(), windowWidth) != FIXED_WINDOW_WIDTHS.end();
+}
+
+std::unique_ptr<FilterKernel> FilterKernel::createMedian(unsigned int windowWidth) {
+    // Keep in line with FIXED_WINDOW_WIDTHS.
+    switch (windowWidth) {
+    case 3:
+        return std::make_unique<FixedWindowMedian<3>>();
+    case 5:
+        return std::make_unique<FixedWindowMedian<5>>();
+    case 7:
+        return std::make_unique<FixedWindowMedian<7>>();
+    case 9:
+        return std::make_unique<FixedWindowMedian<9>>();
+    case 15:
+        return std::make_unique<FixedWindowMedian<15>>();
+    default:
+        return std::make_unique<SlidingMedianKernel>(windowWidth);
+    }
+}
+
+std::unique_ptr<FilterKernel> FilterKernel::createAverage(unsigned int windowWidth) {
+    // Keep in line with FIXED_WINDOW_WIDTHS.
+    switch (windowWidth) {
+    case 3:
+        return std::make_unique<FixedWindowAverage<3>>();
+    case 5:
+        return std::make_unique<FixedWindowAverage<5>>();
+    case 7:
+        return std::make_unique<FixedWindowAverage<7>>();
+    case 9:
+        return std::make_unique<FixedWindowAverage<9>>();
+    case 15:
+        return std::make_unique<FixedWindowAverage<15>>();
+    default:
+        return std::make_unique<SlidingAverageKernel>(windowWidth);
+    }
+}
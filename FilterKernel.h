@@ -0,0 +1,65 @@
+/*
+ * FilterKernel.h
+ *
+ * Window of latest values computing single filtered value (median, average) - the part of
+ * a filter run for every reading.
+ *
+ * Kernels are created by factory methods, which pick a kernel specialized at compile time when
+ * window width is one of the common ones (FIXED_WINDOW_WIDTHS) - values kept in std::array
+ * inside the kernel, no allocation, straight line code (see FixedWindowMedian, FixedWindowAverage).
+ * Other widths get general kernels (SlidingMedian, SlidingAverage).
+ */
+
+#ifndef FILTERKERNEL_H_
+#define FILTERKERNEL_H_
+
+#include <array>
+#include <memory>
+
+#include "SampleClock.h"
+
+class FilterKernel {
+public:
+    // Window widths with kernels specialized at compile time.
+    static constexpr std::array<unsigned int, 5> FIXED_WINDOW_WIDTHS = { 3, 5, 7, 9, 15 };
+
+    virtual ~FilterKernel();
+
+    /**
+     * Adds newest value to the window, oldest one is removed when window is full.
+     *
+     * params:
+     * timestamp - timestamp of value
+     * value - new value
+     */
+    virtual void push(SampleTimestamp timestamp, double value) = 0;
+
+    // Removes all values from the window.
+    virtual void clear() = 0;
+
+    // Checks if window holds windowWidth values already.
+    virtual bool isFull() const = 0;
+
+    // Returns filtered value of the window (valid only when window is full).
+    virtual double getResult() const = 0;
+
+    // Returns timestamp of value from the middle of the window (valid only when window is full).
+    virtual SampleTimestamp getCenterTimestamp() const = 0;
+
+    // Checks if given window width has kernels specialized at compile time.
+    static bool hasFixedWindowKernel(unsigned int windowWidth);
+
+    /**
+     * Creates median of last windowWidth values.
+     * param: windowWidth - amount of values median is computed from (at least 1)
+     */
+    static std::unique_ptr<FilterKernel> createMedian(unsigned int windowWidth);
+
+    /**
+     * Creates average of last windowWidth values.
+     * param: windowWidth - amount of values that are averaged (at least 1)
+     */
+    static std::unique_ptr<FilterKernel> createAverage(unsigned int windowWidth);
+};
+
+#endif /* FILTERKERNEL_H_ */
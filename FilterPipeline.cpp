@@ -0,0 +1,174 @@
+/*
+ * FilterPipeline.cpp
+ */
+
+#include <iostream>
+#include "FilterPipeline.h"
+
+const FilterPipeline::StageId FilterPipeline::RAW_INPUT;
+const FilterPipeline::StageId FilterPipeline::INVALID_STAGE;
+
+FilterPipeline::FilterPipeline(const std::shared_ptr<SampleSource>& serialReader)
+    :SerialPortDataAnalyzer(serialReader)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,started(false) {
+}
+
+FilterPipeline::~FilterPipeline() {
+    if (this->started) {
+        this->deregisterFromSerialReader(this);
+    }
+}
+
+FilterPipeline::StageId FilterPipeline::addStage(std::unique_ptr<FilterStage> stage, StageId source) {
+    if (this->started || !stage || (source != RAW_INPUT && source >= this->stages.size())) {
+        return INVALID_STAGE;
+    }
+
+    StageNode node;
+    node.stage = std::move(stage);
+    node.source = source;
+    node.publishedOutput = std::make_unique<SeqLock<TimestampedValue>>(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    this->stages.push_back(std::move(node));
+
+    this->stageOutputs.push_back(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    this->producedNow.push_back(0);
+    this->producedSincePublish.push_back(0);
+
+    return this->stages.size() - 1;
+}
+
+bool FilterPipeline::start(BackpressurePolicy policy) {
+    if (this->started) {
+        return false;
+    }
+
+    // Flag is set first, so graph is not changed while first readings are processed.
+    this->started = true;
+    if (this->registerToSerialReader(this, policy) == false) {
+        std::cout << "Error: registering to serial reader failed." << std::endl;
+        this->started = false;
+        return false;
+    }
+    return true;
+}
+
+std::pair<SampleTimestamp, double> FilterPipeline::getRawData() {
+    TimestampedValue result = this->rawResult.load();
+
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
+}
+
+std::pair<SampleTimestamp, double> FilterPipeline::getProcessedData() {
+    if (this->stages.empty()) {
+        return std::pair<SampleTimestamp, double>{ -1,0 };
+    }
+    return this->getStageOutput(this->stages.size() - 1);
+}
+
+std::pair<SampleTimestamp, double> FilterPipeline::getStageOutput(StageId stageId) {
+    if (stageId >= this->stages.size()) {
+        return std::pair<SampleTimestamp, double>{ -1,0 };
+    }
+
+    TimestampedValue result = this->stages[stageId].publishedOutput->load();
+
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
+}
+
+std::size_t FilterPipeline::getStageCount() const {
+    return this->stages.size();
+}
+
+void FilterPipeline::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
+
+void FilterPipeline::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    // Latest value received after the latest status reading.
+    const SerialSample* latestValue = nullptr;
+
+    // Subscribers get every output of the last stage, not only the latest one.
+    bool resultsSubscribed = this->resultPublisher.hasSubscribers() && !this->stages.empty();
+    std::size_t lastStage = this->stages.size() - 1;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const SerialSample& sample = samples[i];
+
+        if (sample.status != SampleStatus::VALUE) {
+            this->resetStages();
+            latestValue = nullptr;
+
+            if (sample.status == SampleStatus::RECONNECTED) {
+                std::cout << "Serial port reconnected - filter pipeline restarted." << std::endl;
+            }
+            else {
+                std::cout << "No data received - serial port reader is in " << sampleStatusName(sample.status) << " state." << std::endl;
+            }
+
+            if (resultsSubscribed) {
+                this->newResults.push_back(sample);
+            }
+        }
+        else {
+            this->runStages(TimestampedValue{ sample.timestamp, sample.value });
+            latestValue = &sample;
+
+            if (resultsSubscribed && this->producedNow[lastStage]) {
+                const TimestampedValue& output = this->stageOutputs[lastStage];
+                this->newResults.push_back(SerialSample{ output.timestamp, output.value, SampleStatus::VALUE, sample.portId });
+            }
+        }
+    }
+
+    // Only the state after the whole block is published.
+    if (latestValue != nullptr) {
+        this->rawResult.store(TimestampedValue{ latestValue->timestamp, latestValue->value });
+        this->publishOutputs();
+    }
+
+    if (!this->newResults.empty()) {
+        this->resultPublisher.publish(this->newResults.data(), this->newResults.size());
+        this->newResults.clear();
+    }
+}
+
+void FilterPipeline::runStages(const TimestampedValue& rawValue) {
+    for (std::size_t i = 0; i < this->stages.size(); ++i) {
+        StageNode& node = this->stages[i];
+        const TimestampedValue* input = &rawValue;
+
+        if (node.source != RAW_INPUT) {
+            // Source stage comes earlier, so it has already run for this reading.
+            if (!this->producedNow[node.source]) {
+                this->producedNow[i] = 0;
+                continue;
+            }
+            input = &this->stageOutputs[node.source];
+        }
+
+        this->producedNow[i] = node.stage->process(*input, this->stageOutputs[i]) ? 1 : 0;
+        this->producedSincePublish[i] |= this->producedNow[i];
+    }
+}
+
+void FilterPipeline::publishOutputs() {
+    for (std::size_t i = 0; i < this->stages.size(); ++i) {
+        if (this->producedSincePublish[i]) {
+            this->stages[i].publishedOutput->store(this->stageOutputs[i]);
+            this->producedSincePublish[i] = 0;
+        }
+    }
+}
+
+void FilterPipeline::resetStages() {
+    // When no numeric value is provided all the values stop being legitimate.
+    this->rawResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+
+    for (std::size_t i = 0; i < this->stages.size(); ++i) {
+        this->stages[i].stage->reset();
+        this->stages[i].publishedOutput->store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+        this->producedNow[i] = 0;
+        this->producedSincePublish[i] = 0;
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * FilterPipeline.h
+ *
+ * Analyzer running a graph of filter stages. Every stage is fed either by raw readings or by
+ * output of one earlier stage, so stages can be chained (median -> moving average -> decimator)
+ * and fanned out (several stages fed by the same stage).
+ *
+ * Whole graph runs fused: every reading goes through all stages in one pass, values are passed
+ * between stages directly (no queues, no copies into intermediate buffers, no reparsing).
+ * Latest output of every stage is published once per block of readings and can be read
+ * from any thread without locking. Subscribers (see subscribe()) get every output of the last stage.
+ *
+ * Example:
+ *   FilterPipeline pipeline(serialReader);
+ *   FilterPipeline::StageId median = pipeline.addStage(std::make_unique<MedianStage>(2));
+ *   FilterPipeline::StageId average = pipeline.addStage(std::make_unique<MovingAverageStage>(2), median);
+ *   pipeline.addStage(std::make_unique<DecimatorStage>(10), median);
+ *   pipeline.start();
+ */
+
+#ifndef FILTERPIPELINE_H_
+#define FILTERPIPELINE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "FilterStage.h"
+#include "SeqLock.h"
+#include "SerialPortDataAnalyzer.h"
+
+class FilterPipeline: public SerialPortDataAnalyzer {
+public:
+    typedef std::size_t StageId;
+
+    // Source of stages fed by raw readings.
+    static const StageId RAW_INPUT = static_cast<StageId>(-1);
+
+    // Returned by addStage() on failure.
+    static const StageId INVALID_STAGE = static_cast<StageId>(-2);
+
+    /**
+     * Creates empty pipeline, it is registered to serial reader by start().
+     *
+     * param: serialReader - serial reader object or other source of readings (see SampleSource)
+     */
+    FilterPipeline(const std::shared_ptr<SampleSource>& serialReader);
+
+    virtual ~FilterPipeline();
+
+    /**
+     * Adds stage to the graph. Stages can be added only before start().
+     *
+     * params:
+     * stage - processing stage, owned by pipeline from now on
+     * source - stage whose outputs are passed to the new stage, RAW_INPUT for raw readings
+     * returns: id of the new stage, INVALID_STAGE when pipeline was started or source does not exist
+     */
+    StageId addStage(std::unique_ptr<FilterStage> stage, StageId source = RAW_INPUT);
+
+    /**
+     * Registers pipeline to serial reader, readings go through stages from now on.
+     * returns: true on success, false otherwise
+     */
+    bool start(BackpressurePolicy policy = BackpressurePolicy::BLOCK);
+
+    /**
+     *  Get latest read from serial port with timestamp.
+     *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet,
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getRawData();
+
+    /**
+     *  Get latest output of the last added stage.
+     *  returns: latest output with timestamp or (-1,0) when stage did not produce anything yet
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
+
+    /**
+     *  Get latest output of given stage.
+     *  returns: latest output with timestamp or (-1,0) when stage did not produce anything yet,
+     *  error occured or stage does not exist.
+     */
+    std::pair<SampleTimestamp, double> getStageOutput(StageId stageId);
+
+    // Returns amount of stages in the graph.
+    std::size_t getStageCount() const;
+
+private:
+    struct StageNode {
+        std::unique_ptr<FilterStage> stage;
+        StageId source;
+
+        // Latest output, read by getters without locking.
+        std::unique_ptr<SeqLock<TimestampedValue>> publishedOutput;
+    };
+
+    // Stages in order of adding - every stage comes after its source, so a single pass
+    // over that vector runs the whole graph.
+    std::vector<StageNode> stages;
+
+    // Latest output of every stage and flags telling which stages produced output for
+    // the current reading / since the last publishing. Used only by the thread running pipeline.
+    std::vector<TimestampedValue> stageOutputs;
+    std::vector<char> producedNow;
+    std::vector<char> producedSincePublish;
+
+    // Latest raw value, read by getRawData() without locking.
+    SeqLock<TimestampedValue> rawResult;
+
+    // Outputs of the last stage produced from the current block, published to subscribers after it
+    // (see subscribe()).
+    std::vector<SerialSample> newResults;
+
+    // Set by start(), graph cannot be changed afterwards.
+    std::atomic<bool> started;
+
+    /**
+     * Method used by Serial object to send latest data to analyzer.
+     *
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, every reading goes through
+     * the whole graph and outputs are published once after the block.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    // Passes single raw value through all stages.
+    void runStages(const TimestampedValue& rawValue);
+
+    // Publishes outputs produced since the last publishing.
+    void publishOutputs();
+
+    // Drops values collected by all stages and invalidates their outputs.
+    void resetStages();
+};
+
+#endif /* FILTERPIPELINE_H_ */
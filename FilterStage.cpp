@@ -0,0 +1,9 @@
+/*
+ * FilterStage.cpp
+ */
+
+#include "FilterStage.h"
+
+FilterStage::~FilterStage() {
+    // Base class does not own any resources.
+}
@@ -0,0 +1,34 @@
+/*
+ * FilterStage.h
+ *
+ * Single processing step of FilterPipeline (median, moving average, decimation etc.).
+ *
+ * Stage gets values one by one and for each of them can produce one output value, which is
+ * passed directly to stages connected after it. Stages of a pipeline are always run by one
+ * thread at a time, so they do not need any synchronisation.
+ */
+
+#ifndef FILTERSTAGE_H_
+#define FILTERSTAGE_H_
+
+#include "SampleClock.h"
+
+class FilterStage {
+public:
+    virtual ~FilterStage();
+
+    /**
+     * Processes single value.
+     *
+     * params:
+     * input - raw reading or output of previous stage
+     * output - value produced by the stage, untouched when nothing was produced
+     * returns: true when output was produced, false when stage needs more values
+     */
+    virtual bool process(const TimestampedValue& input, TimestampedValue& output) = 0;
+
+    // Drops collected values (after serial port error, reconnection etc.).
+    virtual void reset() = 0;
+};
+
+#endif /* FILTERSTAGE_H_ */
@@ -0,0 +1,80 @@
+/*
+ * FixedWindowAverage.h
+ *
+ * Average of last Width values, width known at compile time.
+ *
+ * Values are kept in std::array inside the object. Sum is computed from all values of the
+ * window every time, as pairwise sum expanded at compile time - independent additions run in
+ * parallel and no error is carried over from previous values (unlike running sum).
+ */
+
+#ifndef FIXEDWINDOWAVERAGE_H_
+#define FIXEDWINDOWAVERAGE_H_
+
+#include <array>
+#include <cstddef>
+
+#include "FilterKernel.h"
+
+template <unsigned int Width>
+class FixedWindowAverage: public FilterKernel {
+    static_assert(Width >= 1, "averaging window has to hold at least one value");
+
+public:
+    FixedWindowAverage()
+        :values{}
+        ,timestamps{}
+        ,nextIndex(0)
+        ,valueCount(0) {
+    }
+
+    virtual void push(SampleTimestamp timestamp, double value) {
+        this->values[this->nextIndex] = value;
+        this->timestamps[this->nextIndex] = timestamp;
+        this->nextIndex = (this->nextIndex + 1 == Width) ? 0 : this->nextIndex + 1;
+
+        if (this->valueCount < Width) {
+            ++this->valueCount;
+        }
+    }
+
+    virtual void clear() {
+        // Empty slots have to add nothing to the sum.
+        this->values.fill(0);
+        this->nextIndex = 0;
+        this->valueCount = 0;
+    }
+
+    virtual bool isFull() const {
+        return this->valueCount == Width;
+    }
+
+    virtual double getResult() const {
+        return this->sum<0, Width>() / static_cast<double>(Width);
+    }
+
+    virtual SampleTimestamp getCenterTimestamp() const {
+        // When window is full nextIndex points at the oldest value.
+        return this->timestamps[(this->nextIndex + Width / 2) % Width];
+    }
+
+private:
+    // Circular buffer of values and their timestamps.
+    std::array<double, Width> values;
+    std::array<SampleTimestamp, Width> timestamps;
+    std::size_t nextIndex;
+    std::size_t valueCount;
+
+    // Sum of Count values starting at Begin, halves are added separately.
+    template <std::size_t Begin, std::size_t Count>
+    double sum() const {
+        if constexpr (Count == 1) {
+            return this->values[Begin];
+        }
+        else {
+            return this->sum<Begin, Count / 2>() + this->sum<Begin + Count / 2, Count - Count / 2>();
+        }
+    }
+};
+
+#endif /* FIXEDWINDOWAVERAGE_H_ */
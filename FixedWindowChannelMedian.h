@@ -0,0 +1,95 @@
+/*
+ * FixedWindowChannelMedian.h
+ *
+ * Medians of last Width values of every channel, width known at compile time.
+ *
+ * Window rows (one per message, all channels next to each other) are copied to scratch buffer
+ * and a single sorting network (see SortingNetwork) is run over it with channels as lanes -
+ * every compare-exchange handles all channels with vector min/max instructions.
+ */
+
+#ifndef FIXEDWINDOWCHANNELMEDIAN_H_
+#define FIXEDWINDOWCHANNELMEDIAN_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "ChannelKernel.h"
+#include "ChannelWindow.h"
+#include "SortingNetwork.h"
+
+template <unsigned int Width>
+class FixedWindowChannelMedian: public ChannelKernel {
+    static_assert(Width >= 1, "median window has to hold at least one value");
+
+public:
+    // channelCount - amount of channels (at least 1)
+    explicit FixedWindowChannelMedian(std::size_t channelCount)
+        :window(Width, channelCount)
+        ,scratchRows(Width * this->window.getChannelCount()) {
+    }
+
+    virtual void push(SampleTimestamp timestamp, const double* values) {
+        this->window.push(timestamp, values);
+    }
+
+    virtual void clear() {
+        this->window.clear();
+    }
+
+    virtual bool isFull() const {
+        return this->window.isFull();
+    }
+
+    // For not full window (even amount of values) - mean of two middle values.
+    virtual void computeResults(double* results) {
+        std::size_t channelCount = this->window.getChannelCount();
+        const double* values = this->window.getValues();
+
+        if (this->window.isFull()) {
+            std::copy(values, values + Width * channelCount, this->scratchRows.begin());
+            SortingNetwork<Width>::selectMedianLanes(this->scratchRows.data(), channelCount);
+            std::copy(this->scratchRows.begin() + (Width / 2) * channelCount,
+                      this->scratchRows.begin() + (Width / 2 + 1) * channelCount, results);
+            return;
+        }
+
+        // Window is not full only for a moment after start or reset - channels are sorted one by one.
+        std::size_t messageCount = this->window.getMessageCount();
+        for (std::size_t channel = 0; channel < channelCount; ++channel) {
+            if (messageCount == 0) {
+                results[channel] = 0;
+                continue;
+            }
+
+            std::array<double, Width> channelValues;
+            for (std::size_t i = 0; i < messageCount; ++i) {
+                double value = values[i * channelCount + channel];
+                std::size_t position = i;
+                while (position > 0 && channelValues[position - 1] > value) {
+                    channelValues[position] = channelValues[position - 1];
+                    --position;
+                }
+                channelValues[position] = value;
+            }
+
+            std::size_t middle = messageCount / 2;
+            results[channel] = (messageCount % 2 == 1) ? channelValues[middle] :
+                                                         (channelValues[middle - 1] + channelValues[middle]) / 2;
+        }
+    }
+
+    virtual SampleTimestamp getCenterTimestamp() const {
+        return this->window.getCenterTimestamp();
+    }
+
+private:
+    ChannelWindow window;
+
+    // Copy of window reordered by sorting network.
+    std::vector<double> scratchRows;
+};
+
+#endif /* FIXEDWINDOWCHANNELMEDIAN_H_ */
@@ -0,0 +1,89 @@
+/*
+ * FixedWindowMedian.h
+ *
+ * Median of last Width values, width known at compile time.
+ *
+ * Values are kept in std::array inside the object. Median of full window is selected by
+ * sorting network (see SortingNetwork) from a copy of the window - for small widths that is
+ * faster than keeping values ordered, and adding value costs only a single store.
+ */
+
+#ifndef FIXEDWINDOWMEDIAN_H_
+#define FIXEDWINDOWMEDIAN_H_
+
+#include <array>
+#include <cstddef>
+
+#include "FilterKernel.h"
+#include "SortingNetwork.h"
+
+template <unsigned int Width>
+class FixedWindowMedian: public FilterKernel {
+    static_assert(Width >= 1, "median window has to hold at least one value");
+
+public:
+    FixedWindowMedian()
+        :values{}
+        ,timestamps{}
+        ,nextIndex(0)
+        ,valueCount(0) {
+    }
+
+    virtual void push(SampleTimestamp timestamp, double value) {
+        this->values[this->nextIndex] = value;
+        this->timestamps[this->nextIndex] = timestamp;
+        this->nextIndex = (this->nextIndex + 1 == Width) ? 0 : this->nextIndex + 1;
+
+        if (this->valueCount < Width) {
+            ++this->valueCount;
+        }
+    }
+
+    virtual void clear() {
+        this->nextIndex = 0;
+        this->valueCount = 0;
+    }
+
+    virtual bool isFull() const {
+        return this->valueCount == Width;
+    }
+
+    // For not full window (even amount of values) - mean of two middle values.
+    virtual double getResult() const {
+        std::array<double, Width> orderedValues = this->values;
+
+        if (this->valueCount == Width) {
+            return SortingNetwork<Width>::selectMedian(orderedValues);
+        }
+        if (this->valueCount == 0) {
+            return 0;
+        }
+
+        // Window is not full only for a moment after start or reset - insertion sort is enough.
+        for (std::size_t i = 1; i < this->valueCount; ++i) {
+            double value = orderedValues[i];
+            std::size_t position = i;
+            while (position > 0 && orderedValues[position - 1] > value) {
+                orderedValues[position] = orderedValues[position - 1];
+                --position;
+            }
+            orderedValues[position] = value;
+        }
+        std::size_t middle = this->valueCount / 2;
+        return (this->valueCount % 2 == 1) ? orderedValues[middle] : (orderedValues[middle - 1] + orderedValues[middle]) / 2;
+    }
+
+    virtual SampleTimestamp getCenterTimestamp() const {
+        // When window is full nextIndex points at the oldest value.
+        return this->timestamps[(this->nextIndex + Width / 2) % Width];
+    }
+
+private:
+    // Circular buffer of values and their timestamps.
+    std::array<double, Width> values;
+    std::array<SampleTimestamp, Width> timestamps;
+    std::size_t nextIndex;
+    std::size_t valueCount;
+};
+
+#endif /* FIXEDWINDOWMEDIAN_H_ */
@@ -0,0 +1,184 @@
+/*
+ * FrameParser.cpp
+ */
+
+#include "FrameParser.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+namespace {
+    // Powers of ten exactly representable as double.
+    const double EXACT_POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // Mantissa limit of fast path - integers up to 2^53 are exact in double.
+    const int MAX_FAST_PATH_DIGITS = 15;
+
+    inline bool isPadding(char character) {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n' || character == '\0';
+    }
+
+    inline bool isDigit(char character) {
+        return static_cast<unsigned char>(character - '0') < 10;
+    }
+}
+
+FrameParser::Result FrameParser::parseValue(const char* begin, const char* end, double& value) {
+    while (begin != end && isPadding(*begin)) {
+        ++begin;
+    }
+    while (end != begin && isPadding(*(end - 1))) {
+        --end;
+    }
+
+    if (begin == end) {
+        return Result::EMPTY;
+    }
+
+    // std::from_chars does not accept leading '+'.
+    if (*begin == '+') {
+        ++begin;
+        if (begin == end || *begin == '-' || *begin == '+') {
+            return Result::INVALID_FORMAT;
+        }
+    }
+
+    if (parseSimpleDecimal(begin, end, value)) {
+        return Result::OK;
+    }
+
+    double parsedValue = 0;
+    std::from_chars_result result = std::from_chars(begin, end, parsedValue);
+
+    if (result.ec == std::errc::result_out_of_range) {
+        return Result::OUT_OF_RANGE;
+    }
+    if (result.ec != std::errc() || result.ptr != end) {
+        return Result::INVALID_FORMAT;
+    }
+    if (!std::isfinite(parsedValue)) {
+        // "inf" and "nan" are not valid measurements.
+        return Result::OUT_OF_RANGE;
+    }
+
+    value = parsedValue;
+    return Result::OK;
+}
+
+FrameParser::BatchResult FrameParser::parseFixedWidthBatch(const char* data, std::size_t length, std::size_t frameWidth,
+                                                           SampleTimestamp timestamp, SerialSample* samples,
+                                                           std::size_t maxSamples) {
+    BatchResult batchResult{ 0, 0, 0 };
+
+    if (frameWidth == 0) {
+        return batchResult;
+    }
+
+    while (length - batchResult.consumedBytes >= frameWidth && batchResult.parsedSamples < maxSamples) {
+        const char* frame = data + batchResult.consumedBytes;
+        SerialSample& sample = samples[batchResult.parsedSamples];
+
+        if (parseValue(frame, frame + frameWidth, sample.value) == Result::OK) {
+            sample.timestamp = timestamp;
+            sample.status = SampleStatus::VALUE;
+            sample.channel = 0;
+            ++batchResult.parsedSamples;
+            batchResult.consumedBytes += frameWidth;
+        }
+        else {
+            // Messages with split number contain padding in the middle, so they never parse - moving
+            // by a single byte finds beginning of the next valid message.
+            ++batchResult.parseErrors;
+            ++batchResult.consumedBytes;
+        }
+    }
+
+    return batchResult;
+}
+
+FrameParser::Result FrameParser::parseChannels(const char* begin, const char* end, char separator, SerialSample* samples,
+                                               std::size_t channelCount) {
+    const char* fieldBegin = begin;
+    std::size_t channel = 0;
+
+    while (true) {
+        const char* fieldEnd = static_cast<const char*>(std::memchr(fieldBegin, separator, static_cast<std::size_t>(end - fieldBegin)));
+        if (fieldEnd == nullptr) {
+            fieldEnd = end;
+        }
+
+        if (channel == channelCount) {
+            return Result::INVALID_FORMAT;
+        }
+
+        Result fieldResult = parseValue(fieldBegin, fieldEnd, samples[channel].value);
+        if (fieldResult == Result::EMPTY) {
+            // Only whole message may be empty (e.g. "\r\n" line ending), empty field is an error.
+            return (channel == 0 && fieldEnd == end) ? Result::EMPTY : Result::INVALID_FORMAT;
+        }
+        if (fieldResult != Result::OK) {
+            return fieldResult;
+        }
+        ++channel;
+
+        if (fieldEnd == end) {
+            break;
+        }
+        fieldBegin = fieldEnd + 1;
+    }
+
+    return (channel == channelCount) ? Result::OK : Result::INVALID_FORMAT;
+}
+
+bool FrameParser::parseSimpleDecimal(const char* begin, const char* end, double& value) {
+    const char* position = begin;
+    bool negative = false;
+
+    if (*position == '-') {
+        negative = true;
+        ++position;
+    }
+
+    std::uint64_t mantissa = 0;
+    int digitCount = 0;
+    int fractionDigits = 0;
+    bool dotSeen = false;
+    bool digitSeen = false;
+
+    for (; position != end; ++position) {
+        char character = *position;
+        if (isDigit(character)) {
+            // Leading zeros do not count as significant digits.
+            if (mantissa != 0 || character != '0') {
+                if (++digitCount > MAX_FAST_PATH_DIGITS) {
+                    return false;
+                }
+            }
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(character - '0');
+            fractionDigits += dotSeen ? 1 : 0;
+            digitSeen = true;
+        }
+        else if (character == '.' && !dotSeen) {
+            dotSeen = true;
+        }
+        else {
+            // Exponent or anything unexpected - general parser decides.
+            return false;
+        }
+    }
+
+    if (!digitSeen || fractionDigits > 22) {
+        return false;
+    }
+
+    // Both mantissa and power of ten are exact, so single division gives correctly rounded result.
+    double result = static_cast<double>(mantissa) / EXACT_POWERS_OF_TEN[fractionDigits];
+    value = negative ? -result : result;
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * FrameParser.h
+ *
+ * Parser of numeric messages sent through serial port (e.g. "-12.345   " sent by Arduino
+ * generator - decimal number padded with spaces to fixed width).
+ *
+ * Parsing does not depend on locale, does not allocate memory and does not throw, errors are
+ * reported through result codes. Plain decimal numbers (the usual case) are converted by a fast
+ * path which is exact, anything else (exponents, very long mantissas) falls back to std::from_chars.
+ */
+
+#ifndef FRAMEPARSER_H_
+#define FRAMEPARSER_H_
+
+#include <cstddef>
+
+#include "SerialSample.h"
+
+class FrameParser {
+public:
+    enum class Result {
+        OK,
+        EMPTY,          // message contains only padding
+        INVALID_FORMAT, // message is not a number or contains something after the number
+        OUT_OF_RANGE    // number does not fit in double, or is not finite
+    };
+
+    // Summary of parsing a block of messages.
+    struct BatchResult {
+        // Amount of bytes taken from the block, remaining ones are beginning of incomplete message.
+        std::size_t consumedBytes;
+        // Amount of samples written to output.
+        std::size_t parsedSamples;
+        // Amount of messages that did not contain valid number (or, when stream had to be
+        // resynchronized byte by byte, amount of skipped positions).
+        std::size_t parseErrors;
+    };
+
+    /**
+     * Parses single number which may be surrounded by padding (spaces, tabs, CR, LF, NUL).
+     * Leading '+' sign is accepted.
+     *
+     * params:
+     * begin, end - message bytes
+     * value - parsed number, untouched on failure
+     */
+    static Result parseValue(const char* begin, const char* end, double& value);
+
+    /**
+     * Parses all complete fixed width messages from a block of data in one pass.
+     * When message at current position is not valid, stream is assumed to be desynced and
+     * parsing moves forward by a single byte (instead of whole message) until valid message is found.
+     *
+     * params:
+     * data, length - received bytes, incomplete message at the end is left untouched
+     * frameWidth - size of single message
+     * timestamp - capture time given to all parsed samples
+     * samples - output array
+     * maxSamples - size of output array, parsing stops when it is full
+     */
+    static BatchResult parseFixedWidthBatch(const char* data, std::size_t length, std::size_t frameWidth,
+                                            SampleTimestamp timestamp, SerialSample* samples, std::size_t maxSamples);
+
+    /**
+     * Parses message holding several numbers separated by a character (e.g. "0.12,-9.81,3.5"),
+     * every number may be surrounded by padding.
+     *
+     * params:
+     * begin, end - message bytes
+     * separator - character between numbers
+     * samples - number n is written to samples[n].value, other fields are untouched
+     * channelCount - amount of numbers message has to hold
+     * returns: OK, EMPTY when message contains only padding, INVALID_FORMAT when amount of numbers
+     *          differs or one of them is not valid, OUT_OF_RANGE when one of numbers does not fit
+     */
+    static Result parseChannels(const char* begin, const char* end, char separator, SerialSample* samples,
+                                std::size_t channelCount);
+
+private:
+    /**
+     * Converts [sign]digits[.digits] number with at most 15 significant digits exactly.
+     * returns: true on success, false when number has to be handled by general parser
+     */
+    static bool parseSimpleDecimal(const char* begin, const char* end, double& value);
+};
+
+#endif /* FRAMEPARSER_H_ */
@@ -0,0 +1,81 @@
+/*
+ * LatencyHistogram.cpp
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+const unsigned int LatencyHistogram::SUB_BUCKET_BITS;
+const std::size_t LatencyHistogram::SUB_BUCKET_COUNT;
+const unsigned int LatencyHistogram::MAX_VALUE_BITS;
+const std::int64_t LatencyHistogram::MAX_VALUE;
+const std::size_t LatencyHistogram::BUCKET_COUNT;
+
+LatencyHistogram::LatencyHistogram()
+    :sum(0) {
+    for (std::atomic<std::uint64_t>& bucketCount : this->bucketCounts) {
+        bucketCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.count = 0;
+
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.bucketCounts[i] = this->bucketCounts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.bucketCounts[i];
+    }
+    snapshot.sum = this->sum.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+std::int64_t LatencyHistogram::getBucketLowerBound(std::size_t bucketIndex) {
+    if (bucketIndex < SUB_BUCKET_COUNT) {
+        return static_cast<std::int64_t>(bucketIndex);
+    }
+
+    unsigned int shift = static_cast<unsigned int>(bucketIndex >> SUB_BUCKET_BITS) - 1;
+    std::int64_t subBucket = static_cast<std::int64_t>(bucketIndex & (SUB_BUCKET_COUNT - 1));
+    return (static_cast<std::int64_t>(SUB_BUCKET_COUNT) | subBucket) << shift;
+}
+
+std::int64_t LatencyHistogram::getBucketUpperBound(std::size_t bucketIndex) {
+    if (bucketIndex < SUB_BUCKET_COUNT) {
+        return static_cast<std::int64_t>(bucketIndex) + 1;
+    }
+
+    unsigned int shift = static_cast<unsigned int>(bucketIndex >> SUB_BUCKET_BITS) - 1;
+    return getBucketLowerBound(bucketIndex) + (static_cast<std::int64_t>(1) << shift);
+}
+
+std::int64_t LatencyHistogram::Snapshot::getValueAtQuantile(double quantile) const {
+    if (this->count == 0) {
+        return 0;
+    }
+
+    // Rank of the value (1 based), at least the first one.
+    double clampedQuantile = std::min(std::max(quantile, 0.0), 1.0);
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(clampedQuantile * static_cast<double>(this->count)));
+    rank = std::max<std::uint64_t>(rank, 1);
+
+    std::uint64_t countSoFar = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        countSoFar += this->bucketCounts[i];
+        if (countSoFar >= rank) {
+            return getBucketUpperBound(i);
+        }
+    }
+    return MAX_VALUE;
+}
+
+std::uint64_t LatencyHistogram::Snapshot::getCountBelow(std::int64_t value) const {
+    std::uint64_t countSoFar = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT && getBucketUpperBound(i) <= value; ++i) {
+        countSoFar += this->bucketCounts[i];
+    }
+    return countSoFar;
+}
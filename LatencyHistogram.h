@@ -0,0 +1,126 @@
+/*
+ * LatencyHistogram.h
+ *
+ * Histogram of latencies in nanoseconds with buckets of constant relative width (like HdrHistogram):
+ * every power of two range is split into SUB_BUCKET_COUNT linear buckets, so any value is kept
+ * with precision of about 1/SUB_BUCKET_COUNT of itself, from 1 ns up to MAX_VALUE.
+ *
+ * Recording is lock-free and wait-free - bucket index comes from a few bit operations and bucket
+ * counter is incremented with relaxed atomic add. Any thread can record and read at any time,
+ * readers get snapshot which can miss values recorded in the meantime, but never a broken one.
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "SampleClock.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class LatencyHistogram {
+public:
+    // Every power of two range is split into 2^SUB_BUCKET_BITS buckets (relative precision about 3%).
+    static const unsigned int SUB_BUCKET_BITS = 5;
+    static const std::size_t SUB_BUCKET_COUNT = static_cast<std::size_t>(1) << SUB_BUCKET_BITS;
+
+    // Values are tracked up to 2^MAX_VALUE_BITS ns (about 18 minutes), bigger ones go to the last bucket.
+    static const unsigned int MAX_VALUE_BITS = 40;
+    static const std::int64_t MAX_VALUE = (static_cast<std::int64_t>(1) << MAX_VALUE_BITS) - 1;
+
+    static const std::size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    // Copy of histogram taken at some moment.
+    struct Snapshot {
+        std::array<std::uint64_t, BUCKET_COUNT> bucketCounts;
+        // Amount of recorded values and their sum in nanoseconds.
+        std::uint64_t count;
+        std::uint64_t sum;
+
+        /**
+         * Returns value below which given fraction of recorded values lie (upper bound of bucket
+         * holding it), 0 when nothing was recorded.
+         * param: quantile - fraction in range 0..1, e.g. 0.99 for 99th percentile
+         */
+        std::int64_t getValueAtQuantile(double quantile) const;
+
+        // Returns amount of recorded values smaller than given value, value has to be
+        // a bucket boundary (e.g. a power of two) to get exact result.
+        std::uint64_t getCountBelow(std::int64_t value) const;
+    };
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * Records single latency, negative values are recorded as 0.
+     * param: latency - latency in nanoseconds
+     */
+    void record(std::int64_t latency) {
+        if (latency < 0) {
+            latency = 0;
+        }
+        else if (latency > MAX_VALUE) {
+            latency = MAX_VALUE;
+        }
+
+        this->bucketCounts[getBucketIndex(static_cast<std::uint64_t>(latency))].fetch_add(1, std::memory_order_relaxed);
+        this->sum.fetch_add(static_cast<std::uint64_t>(latency), std::memory_order_relaxed);
+    }
+
+    /**
+     * Records time elapsed from given moment until now. Does nothing for INVALID_TIMESTAMP
+     * (e.g. timestamp of status reading).
+     */
+    void recordSince(SampleTimestamp start) {
+        if (start != INVALID_TIMESTAMP) {
+            this->record(SampleClock::now() - start);
+        }
+    }
+
+    Snapshot getSnapshot() const;
+
+    // Returns lowest value that falls into bucket with given index.
+    static std::int64_t getBucketLowerBound(std::size_t bucketIndex);
+
+    // Returns lowest value that falls into bucket following the given one.
+    static std::int64_t getBucketUpperBound(std::size_t bucketIndex);
+
+    // Returns index of bucket holding given value (value up to MAX_VALUE).
+    static std::size_t getBucketIndex(std::uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<std::size_t>(value);
+        }
+
+        // Values in range 2^n..2^(n+1)-1 (n >= SUB_BUCKET_BITS) are split by their SUB_BUCKET_BITS
+        // bits following the highest one.
+        unsigned int shift = highestBit(value) - SUB_BUCKET_BITS;
+        std::size_t subBucket = static_cast<std::size_t>(value >> shift) & (SUB_BUCKET_COUNT - 1);
+        return ((static_cast<std::size_t>(shift) + 1) << SUB_BUCKET_BITS) | subBucket;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> bucketCounts;
+    std::atomic<std::uint64_t> sum;
+
+    // Returns position of the highest set bit (value has to be non zero).
+    static unsigned int highestBit(std::uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long position;
+        _BitScanReverse64(&position, value);
+        return static_cast<unsigned int>(position);
+#else
+        return 63 - static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+    }
+};
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,128 @@
+/*
+ * MappedFile.cpp
+ */
+
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& fileName)
+    :mappedData(nullptr)
+    ,mappedSize(0)
+    ,mapped(false)
+    ,fileHandle(INVALID_HANDLE_VALUE)
+    ,mappingHandle(nullptr) {
+    this->fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                   FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (this->fileHandle == INVALID_HANDLE_VALUE) {
+        std::cout << "ERROR: could not open file " << fileName << std::endl;
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(this->fileHandle, &fileSize)) {
+        std::cout << "ERROR: could not get size of file " << fileName << std::endl;
+        return;
+    }
+    this->mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+    if (this->mappedSize == 0) {
+        // Empty file cannot be mapped, but there is nothing to read anyway.
+        this->mapped = true;
+        return;
+    }
+
+    this->mappingHandle = CreateFileMappingA(this->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (this->mappingHandle != nullptr) {
+        this->mappedData = static_cast<const char*>(MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if (this->mappedData == nullptr) {
+        std::cout << "ERROR: could not map file " << fileName << std::endl;
+        this->mappedSize = 0;
+        return;
+    }
+    this->mapped = true;
+}
+
+MappedFile::~MappedFile() {
+    if (this->mappedData != nullptr) {
+        UnmapViewOfFile(this->mappedData);
+    }
+    if (this->mappingHandle != nullptr) {
+        CloseHandle(this->mappingHandle);
+    }
+    if (this->fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(this->fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& fileName)
+    :mappedData(nullptr)
+    ,mappedSize(0)
+    ,mapped(false) {
+    int fileDescriptor = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor == -1) {
+        std::cout << "ERROR: could not open file " << fileName << std::endl;
+        return;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        std::cout << "ERROR: could not get size of file " << fileName << std::endl;
+        ::close(fileDescriptor);
+        return;
+    }
+    this->mappedSize = static_cast<std::size_t>(fileStatus.st_size);
+
+    if (this->mappedSize > 0) {
+        void* mapping = mmap(nullptr, this->mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            std::cout << "ERROR: could not map file " << fileName << std::endl;
+            this->mappedSize = 0;
+            ::close(fileDescriptor);
+            return;
+        }
+        this->mappedData = static_cast<const char*>(mapping);
+
+        // Files are mostly read from beginning to end - let kernel read ahead aggressively.
+        madvise(mapping, this->mappedSize, MADV_SEQUENTIAL);
+    }
+
+    // Mapping stays valid after descriptor is closed.
+    ::close(fileDescriptor);
+    this->mapped = true;
+}
+
+MappedFile::~MappedFile() {
+    if (this->mappedData != nullptr) {
+        munmap(const_cast<char*>(this->mappedData), this->mappedSize);
+    }
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+    return this->mapped;
+}
+
+const char* MappedFile::getData() const {
+    return this->mappedData;
+}
+
+std::size_t MappedFile::getSize() const {
+    return this->mappedSize;
+}
@@ -0,0 +1,46 @@
+/*
+ * MappedFile.h
+ *
+ * Read-only memory mapping of a whole file (mmap on Linux, file mapping on Windows).
+ * Bytes are read straight from page cache, without copying them into user buffers.
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    // Maps given file, check isOpen() for result.
+    explicit MappedFile(const std::string& fileName);
+
+    // Unmaps file.
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Checks if file was mapped (empty file counts as mapped, with no data).
+    bool isOpen() const;
+
+    // Returns beginning of mapped bytes, nullptr for empty or not mapped file.
+    const char* getData() const;
+
+    // Returns size of mapped file.
+    std::size_t getSize() const;
+
+private:
+    const char* mappedData;
+    std::size_t mappedSize;
+    bool mapped;
+
+#ifdef _WIN32
+    // Handles of the file and of its mapping object.
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif /* MAPPEDFILE_H_ */
@@ -6,13 +6,13 @@
  */
 
 #include <iostream>
-#include <set>
 #include "MedianFilter.h"
 
-MedianFilter::MedianFilter(const std::shared_ptr<Serial>& serialReader, unsigned int filterWindow)
+MedianFilter::MedianFilter(const std::shared_ptr<SampleSource>& serialReader, unsigned int filterWindow)
     :SerialPortDataAnalyzer(serialReader)
-    ,rawValueLegit(false)
-    ,processedValueLegit(false)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,processedResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,medianWindow(FilterKernel::createMedian(2*filterWindow + 1))
     ,filterWindowWidth(2*filterWindow + 1) {
     if (this->registerToSerialReader(this) == false) {
         std::cout << "Error: registering to serial reader failed." << std::endl;
@@ -21,8 +21,9 @@ MedianFilter::MedianFilter(const std::shared_ptr<Serial>& serialReader, unsigned
 
 MedianFilter::MedianFilter(const std::string& serialName, unsigned int bufferSize, unsigned int filterWindow)
     :SerialPortDataAnalyzer(serialName, bufferSize)
-    ,rawValueLegit(false)
-    ,processedValueLegit(false)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,processedResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,medianWindow(FilterKernel::createMedian(2*filterWindow + 1))
     ,filterWindowWidth(2*filterWindow + 1) {
     if (this->registerToSerialReader(this) == false) {
         std::cout << "Error: registering to serial reader failed." << std::endl;
@@ -33,75 +34,88 @@ MedianFilter::~MedianFilter() {
     this->deregisterFromSerialReader(this);
 }
 
-std::pair<std::time_t, double> MedianFilter::getRawData() {
-    std::scoped_lock dataLock(this->dataMutex);
+std::pair<SampleTimestamp, double> MedianFilter::getRawData() {
+    TimestampedValue result = this->rawResult.load();
 
-    return this->rawValueLegit ? this->currentRawValue : std::pair<std::time_t, double>{ -1,0 };
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
 }
 
-std::pair<std::time_t, double> MedianFilter::getProcessedData() {
-    std::scoped_lock dataLock(this->dataMutex);
+std::pair<SampleTimestamp, double> MedianFilter::getProcessedData() {
+    TimestampedValue result = this->processedResult.load();
 
-    return this->processedValueLegit ? this->currentProcessedValue : std::pair<std::time_t, double>{ -1,0 };
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
 }
 
-void MedianFilter::fetchNewData(const std::pair<std::time_t, std::string>& data) {
+void MedianFilter::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
 
-    if (data.second == "ERROR" || data.second == "CLOSED" || data.second == "INITIALIZING") {
-        // When no numeric value is provided all the values stop being legitimate and filter window is cleared.
-        this->rawValueLegit = false;
-        this->processedValueLegit = false;
+void MedianFilter::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    std::scoped_lock dataLock(this->dataMutex);
 
-        std::cout << "No data received - serial port reader is in " << data.second << " state." << std::endl;
+    // Latest value received after the latest status reading.
+    const SerialSample* latestValue = nullptr;
 
-        std::scoped_lock dataLock(this->dataMutex);
-        this->valuesInFilterWindow.clear();
-        this->currentRawValue = std::pair<std::time_t, double>{ -1,0 };
-        this->currentProcessedValue = std::pair<std::time_t, double>{ -1,0 };
+    // Subscribers get every filtered value, not only the latest one.
+    bool resultsSubscribed = this->resultPublisher.hasSubscribers();
 
-    }
-    else {
-        try {
-            double newValue = std::stod(data.second); // If there is anything wrong with data, exception will be thrown there
+    for (std::size_t i = 0; i < count; ++i) {
+        const SerialSample& sample = samples[i];
 
-            std::scoped_lock dataLock(this->dataMutex);
-            this->currentRawValue.first = data.first;
-            this->currentRawValue.second = newValue;
+        if (sample.status != SampleStatus::VALUE) {
+            this->resetWindow(sample.status);
+            latestValue = nullptr;
 
-            if (this->rawValueLegit == false) {
-                this->rawValueLegit = true;
+            if (resultsSubscribed) {
+                this->newResults.push_back(sample);
             }
-
-            if (this->valuesInFilterWindow.size() == this->filterWindowWidth) {
-                this->valuesInFilterWindow.emplace(this->valuesInFilterWindow.begin(), data.first, newValue);
-                this->valuesInFilterWindow.pop_back();
-                this->processData();
-            }
-            else {
-                this->valuesInFilterWindow.emplace(this->valuesInFilterWindow.begin(), data.first, newValue);
-                if (this->valuesInFilterWindow.size() == this->filterWindowWidth) {
-                    this->processData();
-                    this->processedValueLegit = true;
-                }
+        }
+        else {
+            // Window drops its oldest value by itself, median is computed once for the whole block
+            // unless subscribers need all of them.
+            this->medianWindow->push(sample.timestamp, sample.value);
+            latestValue = &sample;
+
+            if (resultsSubscribed && this->medianWindow->isFull()) {
+                this->newResults.push_back(SerialSample{ this->medianWindow->getCenterTimestamp(),
+                                                         this->medianWindow->getResult(),
+                                                         SampleStatus::VALUE, sample.portId });
             }
         }
-        catch (const std::exception& e) {
-            std::cout << "Error during processing data from serial port - wrong value format or value out of range" << std::endl;
+    }
+
+    // Only the state after the whole block is published.
+    if (latestValue != nullptr) {
+        this->rawResult.store(TimestampedValue{ latestValue->timestamp, latestValue->value });
+
+        if (this->medianWindow->isFull()) {
+            this->processData();
         }
     }
+
+    if (!this->newResults.empty()) {
+        this->resultPublisher.publish(this->newResults.data(), this->newResults.size());
+        this->newResults.clear();
+    }
 }
 
-void MedianFilter::processData() {
-     std::set<double> sortedValues;
+void MedianFilter::resetWindow(SampleStatus status) {
+    // When no numeric value is provided all the values stop being legitimate and filter window is cleared.
+    this->rawResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    this->processedResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+
+    if (status == SampleStatus::RECONNECTED) {
+        std::cout << "Serial port reconnected - filter window restarted." << std::endl;
+    }
+    else {
+        std::cout << "No data received - serial port reader is in " << sampleStatusName(status) << " state." << std::endl;
+    }
 
-     // That method of sorting values may be inefficient but is very quick to implement.
-     // For relatively small filtering windows performance penalty should be negligible.
-     for(std::pair<std::time_t, double> vectorValue : this->valuesInFilterWindow) {
-         sortedValues.insert(vectorValue.second);
-     }
+    this->medianWindow->clear();
+}
 
-     double medianValue = *std::next(sortedValues.begin(), (this->filterWindowWidth) / 2); // middle value is median
+void MedianFilter::processData() {
+     // Window width is always odd, so median is the middle value.
      // Median filter cannot filter latest received value, it will always have little delay.
-     this->currentProcessedValue.first = this->valuesInFilterWindow[(this->filterWindowWidth)/2].first;
-     this->currentProcessedValue.second = medianValue;
+     this->processedResult.store(TimestampedValue{ this->medianWindow->getCenterTimestamp(), this->medianWindow->getResult() });
  }
@@ -0,0 +1,25 @@
+/*
+ * MedianStage.cpp
+ */
+
+#include "MedianStage.h"
+
+MedianStage::MedianStage(unsigned int filterWindow)
+    :medianWindow(FilterKernel::createMedian(2*filterWindow + 1)) {
+}
+
+bool MedianStage::process(const TimestampedValue& input, TimestampedValue& output) {
+    this->medianWindow->push(input.timestamp, input.value);
+
+    if (!this->medianWindow->isFull()) {
+        return false;
+    }
+
+    output.timestamp = this->medianWindow->getCenterTimestamp();
+    output.value = this->medianWindow->getResult();
+    return true;
+}
+
+void MedianStage::reset() {
+    this->medianWindow->clear();
+}
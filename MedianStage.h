@@ -0,0 +1,30 @@
+/*
+ * MedianStage.h
+ *
+ * Median of the last 2*filterWindow + 1 values, with timestamp of the middle one.
+ * Produces output once the window is full.
+ */
+
+#ifndef MEDIANSTAGE_H_
+#define MEDIANSTAGE_H_
+
+#include <memory>
+
+#include "FilterKernel.h"
+#include "FilterStage.h"
+
+class MedianStage: public FilterStage {
+public:
+    // filterWindow - filter window size presented as difference between center and farthest position
+    explicit MedianStage(unsigned int filterWindow);
+
+    virtual bool process(const TimestampedValue& input, TimestampedValue& output);
+
+    virtual void reset();
+
+private:
+    // Window of latest values (see FilterKernel).
+    std::unique_ptr<FilterKernel> medianWindow;
+};
+
+#endif /* MEDIANSTAGE_H_ */
@@ -0,0 +1,189 @@
+/*
+ * MetricsServer.cpp
+ */
+
+#include "MetricsServer.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+    // Requests are tiny, anything longer is rejected.
+    const std::size_t MAX_REQUEST_SIZE = 4096;
+
+    // The longest time server waits for request of a connected client.
+    const int CLIENT_TIMEOUT_SECONDS = 1;
+
+    // Sends whole buffer. returns: false when client went away
+    bool sendAll(int descriptor, const std::string& data) {
+        std::size_t sentBytes = 0;
+        while (sentBytes < data.size()) {
+            ssize_t result = send(descriptor, data.data() + sentBytes, data.size() - sentBytes, MSG_NOSIGNAL);
+            if (result == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            sentBytes += static_cast<std::size_t>(result);
+        }
+        return true;
+    }
+}
+
+const unsigned short MetricsServer::DEFAULT_PORT;
+
+MetricsServer::MetricsServer(unsigned short port, const std::vector<MetricsProvider*>& providers)
+    :providers(providers)
+    ,listenDescriptor(-1)
+    ,wakeupDescriptor(-1)
+    ,serverActive(false) {
+    if (this->openServerSocket(port)) {
+        this->serverActive = true;
+        this->serveThreadPtr = std::make_unique<std::thread>([this] {this->serveRequests(); });
+        std::cout << "Metrics available at http://127.0.0.1:" << port << "/metrics" << std::endl;
+    }
+}
+
+MetricsServer::~MetricsServer() {
+    this->serverActive = false;
+    if (this->wakeupDescriptor != -1) {
+        std::uint64_t increment = 1;
+        ssize_t result = write(this->wakeupDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+
+    if (this->serveThreadPtr) {
+        this->serveThreadPtr->join();
+    }
+
+    if (this->listenDescriptor != -1) {
+        close(this->listenDescriptor);
+    }
+    if (this->wakeupDescriptor != -1) {
+        close(this->wakeupDescriptor);
+    }
+}
+
+bool MetricsServer::isListening() const {
+    return this->serverActive;
+}
+
+std::string MetricsServer::collectMetrics() const {
+    MetricsWriter writer;
+
+    for (MetricsProvider* provider : this->providers) {
+        provider->collectMetrics(writer);
+    }
+    return writer.getText();
+}
+
+bool MetricsServer::openServerSocket(unsigned short port) {
+    this->wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    this->listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (this->wakeupDescriptor == -1 || this->listenDescriptor == -1) {
+        std::cout << "ERROR: could not create metrics server resources." << std::endl;
+        return false;
+    }
+
+    int reuseAddress = 1;
+    setsockopt(this->listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    // Metrics are meant for local collector (or SSH tunnel), they are not exposed to the network.
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    if (bind(this->listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+            || listen(this->listenDescriptor, SOMAXCONN) == -1) {
+        std::cout << "ERROR: could not listen on metrics port " << port << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void MetricsServer::serveRequests() {
+    pollfd descriptors[2] = {};
+    descriptors[0].fd = this->listenDescriptor;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = this->wakeupDescriptor;
+    descriptors[1].events = POLLIN;
+
+    while (this->serverActive) {
+        int result = poll(descriptors, 2, -1);
+
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "ERROR: metrics server failed." << std::endl;
+            break;
+        }
+
+        if (descriptors[0].revents & POLLIN) {
+            while (true) {
+                int clientDescriptor = accept4(this->listenDescriptor, nullptr, nullptr, SOCK_CLOEXEC);
+                if (clientDescriptor == -1) {
+                    // EAGAIN means that all pending connections were handled.
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    break;
+                }
+                // Scrapes are rare, clients are served one by one.
+                this->handleClient(clientDescriptor);
+            }
+        }
+    }
+}
+
+void MetricsServer::handleClient(int clientDescriptor) {
+    timeval timeout = {};
+    timeout.tv_sec = CLIENT_TIMEOUT_SECONDS;
+    setsockopt(clientDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(clientDescriptor, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only request line matters, the rest of request is read until the empty line.
+    std::string request;
+    char buffer[512];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos
+            && request.size() < MAX_REQUEST_SIZE) {
+        ssize_t bytesRead = recv(clientDescriptor, buffer, sizeof(buffer), 0);
+        if (bytesRead == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<std::size_t>(bytesRead));
+    }
+
+    std::string response;
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+        std::string body = this->collectMetrics();
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n" + body;
+    }
+    else {
+        response = "HTTP/1.1 404 Not Found\r\n"
+                   "Content-Length: 0\r\n"
+                   "Connection: close\r\n\r\n";
+    }
+
+    sendAll(clientDescriptor, response);
+    close(clientDescriptor);
+}
@@ -0,0 +1,70 @@
+/*
+ * MetricsServer.h
+ *
+ * Serves metrics of given providers over HTTP in Prometheus text format (Linux only):
+ *     curl http://127.0.0.1:9464/metrics
+ *
+ * Server listens on loopback interface only. Metrics are collected when request arrives,
+ * on server's own thread, so nothing is computed while nobody is scraping.
+ */
+
+#ifndef METRICSSERVER_H_
+#define METRICSSERVER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MetricsWriter.h"
+
+class MetricsServer {
+public:
+    // Default port of metrics endpoint.
+    static const unsigned short DEFAULT_PORT = 9464;
+
+    /**
+     * Starts listening on 127.0.0.1.
+     *
+     * params:
+     * port - TCP port of the endpoint
+     * providers - objects whose metrics are served. Providers must outlive the server.
+     */
+    MetricsServer(unsigned short port, const std::vector<MetricsProvider*>& providers);
+
+    // Stops serving requests.
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Checks if server socket is open and requests are served.
+    bool isListening() const;
+
+    // Returns metrics of all providers in Prometheus text format (the same as served over HTTP).
+    std::string collectMetrics() const;
+
+private:
+    std::vector<MetricsProvider*> providers;
+
+    // Listening socket and eventfd used to stop serving thread.
+    int listenDescriptor;
+    int wakeupDescriptor;
+
+    std::atomic<bool> serverActive;
+
+    // Ptr to thread serving requests
+    std::unique_ptr<std::thread> serveThreadPtr;
+
+    // Creates listening socket. returns: true on success
+    bool openServerSocket(unsigned short port);
+
+    // Serves requests until server is stopped.
+    void serveRequests();
+
+    // Reads request of a single client, sends response and closes connection.
+    void handleClient(int clientDescriptor);
+};
+
+#endif /* METRICSSERVER_H_ */
@@ -0,0 +1,115 @@
+/*
+ * MetricsWriter.cpp
+ */
+
+#include "MetricsWriter.h"
+
+#include <cstdio>
+
+namespace {
+    // Range of exported histogram buckets - powers of two nanoseconds (1.024 us .. 17.2 s).
+    const unsigned int FIRST_BUCKET_BIT = 10;
+    const unsigned int LAST_BUCKET_BIT = 34;
+
+    const double NANOSECONDS_PER_SECOND = 1e9;
+}
+
+MetricsProvider::~MetricsProvider() {
+    // Interface does not own any resources.
+}
+
+void MetricsWriter::addCounter(const std::string& name, const std::string& help, const std::string& labels,
+                               std::uint64_t value) {
+    char valueText[32];
+    std::snprintf(valueText, sizeof(valueText), "%llu", static_cast<unsigned long long>(value));
+
+    appendSample(this->getFamily(name, help, "counter").samples, name, labels, valueText);
+}
+
+void MetricsWriter::addGauge(const std::string& name, const std::string& help, const std::string& labels, double value) {
+    char valueText[32];
+    std::snprintf(valueText, sizeof(valueText), "%.10g", value);
+
+    appendSample(this->getFamily(name, help, "gauge").samples, name, labels, valueText);
+}
+
+void MetricsWriter::addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                                 const LatencyHistogram& histogram) {
+    LatencyHistogram::Snapshot snapshot = histogram.getSnapshot();
+    std::string& samples = this->getFamily(name, help, "histogram").samples;
+    std::string labelPrefix = labels.empty() ? std::string() : labels + ",";
+    char valueText[32];
+
+    // Buckets are cumulative, "le" is upper bound in seconds.
+    for (unsigned int bit = FIRST_BUCKET_BIT; bit <= LAST_BUCKET_BIT; ++bit) {
+        std::int64_t bound = static_cast<std::int64_t>(1) << bit;
+        char boundText[32];
+        std::snprintf(boundText, sizeof(boundText), "%.9g", static_cast<double>(bound) / NANOSECONDS_PER_SECOND);
+        std::snprintf(valueText, sizeof(valueText), "%llu", static_cast<unsigned long long>(snapshot.getCountBelow(bound)));
+        appendSample(samples, name + "_bucket", labelPrefix + label("le", boundText), valueText);
+    }
+
+    std::snprintf(valueText, sizeof(valueText), "%llu", static_cast<unsigned long long>(snapshot.count));
+    appendSample(samples, name + "_bucket", labelPrefix + label("le", "+Inf"), valueText);
+
+    std::snprintf(valueText, sizeof(valueText), "%.9g", static_cast<double>(snapshot.sum) / NANOSECONDS_PER_SECOND);
+    appendSample(samples, name + "_sum", labels, valueText);
+
+    std::snprintf(valueText, sizeof(valueText), "%llu", static_cast<unsigned long long>(snapshot.count));
+    appendSample(samples, name + "_count", labels, valueText);
+}
+
+std::string MetricsWriter::getText() const {
+    std::string text;
+
+    for (const MetricFamily& family : this->families) {
+        text += "# HELP " + family.name + " " + family.help + "\n";
+        text += "# TYPE " + family.name + " " + family.type + "\n";
+        text += family.samples;
+    }
+    return text;
+}
+
+std::string MetricsWriter::label(const std::string& name, const std::string& value) {
+    std::string text = name + "=\"";
+
+    for (char character : value) {
+        switch (character) {
+        case '\\':
+            text += "\\\\";
+            break;
+        case '"':
+            text += "\\\"";
+            break;
+        case '\n':
+            text += "\\n";
+            break;
+        default:
+            text += character;
+            break;
+        }
+    }
+    text += "\"";
+    return text;
+}
+
+MetricsWriter::MetricFamily& MetricsWriter::getFamily(const std::string& name, const std::string& help, const char* type) {
+    for (MetricFamily& family : this->families) {
+        if (family.name == name) {
+            return family;
+        }
+    }
+
+    this->families.push_back(MetricFamily{ name, help, type, std::string() });
+    return this->families.back();
+}
+
+void MetricsWriter::appendSample(std::string& samples, const std::string& name, const std::string& labels, const char* value) {
+    samples += name;
+    if (!labels.empty()) {
+        samples += "{" + labels + "}";
+    }
+    samples += " ";
+    samples += value;
+    samples += "\n";
+}
@@ -0,0 +1,83 @@
+/*
+ * MetricsWriter.h
+ *
+ * Collects metrics (counters, gauges and latency histograms) and formats them in Prometheus
+ * text exposition format. Objects which expose metrics implement MetricsProvider, metrics are
+ * gathered only when somebody asks for them (see MetricsServer), so keeping them costs nothing
+ * more than updating atomic counters.
+ *
+ * Metric names follow Prometheus conventions: counters end with _total, latencies are exported
+ * in seconds. Samples of one metric coming from many objects (e.g. many ports) are grouped together.
+ */
+
+#ifndef METRICSWRITER_H_
+#define METRICSWRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+class MetricsWriter {
+public:
+    /**
+     * Adds sample of counter (value which only grows).
+     *
+     * params:
+     * name - name of metric
+     * help - description of metric, written once per metric
+     * labels - labels of sample without braces, e.g. label("port", "/dev/ttyACM0"), may be empty
+     * value - current value
+     */
+    void addCounter(const std::string& name, const std::string& help, const std::string& labels, std::uint64_t value);
+
+    // Adds sample of gauge (value which can go up and down), params like in addCounter().
+    void addGauge(const std::string& name, const std::string& help, const std::string& labels, double value);
+
+    /**
+     * Adds histogram of latencies. Buckets are exported for every power of two nanoseconds
+     * from about 1 us to about 17 s, finer resolution is available through LatencyHistogram itself.
+     * Params like in addCounter().
+     */
+    void addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                      const LatencyHistogram& histogram);
+
+    // Returns all added metrics in Prometheus text format.
+    std::string getText() const;
+
+    // Returns single label (name="value") with value escaped, labels are joined with commas.
+    static std::string label(const std::string& name, const std::string& value);
+
+private:
+    // All samples of a single metric.
+    struct MetricFamily {
+        std::string name;
+        std::string help;
+        const char* type;
+        std::string samples;
+    };
+
+    // Families in order of their first sample.
+    std::vector<MetricFamily> families;
+
+    // Returns family with given name, creates it when it does not exist yet.
+    MetricFamily& getFamily(const std::string& name, const std::string& help, const char* type);
+
+    // Appends single sample line.
+    static void appendSample(std::string& samples, const std::string& name, const std::string& labels, const char* value);
+};
+
+// Object that exposes metrics.
+class MetricsProvider {
+public:
+    virtual ~MetricsProvider();
+
+    /**
+     * Adds current values of all metrics of the object. Called from thread serving metrics,
+     * can be called at any time and concurrently with everything else the object does.
+     */
+    virtual void collectMetrics(MetricsWriter& writer) = 0;
+};
+
+#endif /* METRICSWRITER_H_ */
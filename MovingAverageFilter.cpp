@@ -8,10 +8,11 @@
 #include <iostream>
 #include "MovingAverageFilter.h"
 
-MovingAverageFilter::MovingAverageFilter(const std::shared_ptr<Serial>& serialReader, unsigned int filterWindow)
+MovingAverageFilter::MovingAverageFilter(const std::shared_ptr<SampleSource>& serialReader, unsigned int filterWindow)
     :SerialPortDataAnalyzer(serialReader)
-    ,rawValueLegit(false)
-    ,processedValueLegit(false)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,processedResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,averagingWindow(FilterKernel::createAverage(2*filterWindow + 1))
     ,filterWindowWidth(2*filterWindow + 1){
     if (this->registerToSerialReader(this) == false) {
         std::cout << "Error: registering to serial reader failed." << std::endl;
@@ -20,8 +21,9 @@ MovingAverageFilter::MovingAverageFilter(const std::shared_ptr<Serial>& serialRe
 
 MovingAverageFilter::MovingAverageFilter(const std::string& serialName, unsigned int bufferSize, unsigned int filterWindow)
     :SerialPortDataAnalyzer(serialName, bufferSize)
-    ,rawValueLegit(false)
-    ,processedValueLegit(false)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,processedResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,averagingWindow(FilterKernel::createAverage(2*filterWindow + 1))
     ,filterWindowWidth(2*filterWindow + 1){
     if (this->registerToSerialReader(this) == false) {
         std::cout << "Error: registering to serial reader failed." << std::endl;
@@ -33,77 +35,90 @@ MovingAverageFilter::~MovingAverageFilter() {
     this->deregisterFromSerialReader(this);
 }
 
-std::pair<std::time_t, double> MovingAverageFilter::getRawData() {
-    std::scoped_lock dataLock(this->dataMutex);
+std::pair<SampleTimestamp, double> MovingAverageFilter::getRawData() {
+    TimestampedValue result = this->rawResult.load();
 
-    return this->rawValueLegit ? this->currentRawValue : std::pair<std::time_t, double>{ -1,0 };
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
 }
 
-std::pair<std::time_t, double> MovingAverageFilter::getProcessedData() {
-    std::scoped_lock dataLock(this->dataMutex);
+std::pair<SampleTimestamp, double> MovingAverageFilter::getProcessedData() {
+    TimestampedValue result = this->processedResult.load();
 
-    return this->processedValueLegit ? this->currentProcessedValue : std::pair<std::time_t, double>{ -1 ,0 };
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
 }
 
 
-void MovingAverageFilter::fetchNewData(const std::pair<std::time_t, std::string>& data) {
-    if (data.second == "ERROR" || data.second == "CLOSED" || data.second == "INITIALIZING") {
-        // When no numeric value is provided all the values stop being legitimate and filter window is cleared.
-        this->rawValueLegit = false;
-        this->processedValueLegit = false;
+void MovingAverageFilter::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
 
-        std::cout << "No data received - serial port reader is in " << data.second << " state." << std::endl;
+void MovingAverageFilter::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    std::scoped_lock dataLock(this->dataMutex);
 
-        std::scoped_lock dataLock(this->dataMutex);
-        this->valuesInFilterWindow.clear();
-        this->currentRawValue = std::pair<std::time_t, double>{ -1,0 };
-        this->currentProcessedValue = std::pair<std::time_t, double>{ -1,0 };
+    // Latest value received after the latest status reading.
+    const SerialSample* latestValue = nullptr;
 
-    }
-    else {
-        try {
-            double newValue = std::stod(data.second); // If there is anything wrong with data, exception will be thrown there
-            
-            std::scoped_lock dataLock(this->dataMutex);
-            this->currentRawValue.first = data.first;
-            this->currentRawValue.second = newValue;
-
-            if (this->rawValueLegit == false) {
-                this->rawValueLegit = true;
-            }
+    // Subscribers get every filtered value, not only the latest one.
+    bool resultsSubscribed = this->resultPublisher.hasSubscribers();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const SerialSample& sample = samples[i];
 
-            if (this->valuesInFilterWindow.size() == this->filterWindowWidth) {
-                this->valuesInFilterWindow.emplace(this->valuesInFilterWindow.begin(), data.first, newValue);
-                this->valuesInFilterWindow.pop_back();
-                this->processData();
+        if (sample.status != SampleStatus::VALUE) {
+            this->resetWindow(sample.status);
+            latestValue = nullptr;
+
+            if (resultsSubscribed) {
+                this->newResults.push_back(sample);
             }
-            else {
-                this->valuesInFilterWindow.emplace(this->valuesInFilterWindow.begin(), data.first, newValue);
-                if (this->valuesInFilterWindow.size() == this->filterWindowWidth) {
-                    this->processData();
-                    this->processedValueLegit = true;
-                }
+        }
+        else {
+            // Window drops its oldest value by itself, average is computed once for the whole block
+            // unless subscribers need all of them.
+            this->averagingWindow->push(sample.timestamp, sample.value);
+            latestValue = &sample;
+
+            if (resultsSubscribed && this->averagingWindow->isFull()) {
+                this->newResults.push_back(SerialSample{ this->averagingWindow->getCenterTimestamp(),
+                                                         this->averagingWindow->getResult(),
+                                                         SampleStatus::VALUE, sample.portId });
             }
         }
-        catch (const std::exception& e) {
-            std::cout << "Error during processing data from serial port - wrong value format or value out of range" << std::endl;
+    }
+
+    // Only the state after the whole block is published.
+    if (latestValue != nullptr) {
+        this->rawResult.store(TimestampedValue{ latestValue->timestamp, latestValue->value });
+
+        if (this->averagingWindow->isFull()) {
+            this->processData();
         }
     }
 
+    if (!this->newResults.empty()) {
+        this->resultPublisher.publish(this->newResults.data(), this->newResults.size());
+        this->newResults.clear();
+    }
 }
 
-void MovingAverageFilter::processData() {
-    double sum = 0;
+void MovingAverageFilter::resetWindow(SampleStatus status) {
+    // When no numeric value is provided all the values stop being legitimate and filter window is cleared.
+    this->rawResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    this->processedResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
 
-    for(std::pair<std::time_t, double> vectorValue : this->valuesInFilterWindow) {
-        sum = sum + vectorValue.second;
+    if (status == SampleStatus::RECONNECTED) {
+        std::cout << "Serial port reconnected - filter window restarted." << std::endl;
+    }
+    else {
+        std::cout << "No data received - serial port reader is in " << sampleStatusName(status) << " state." << std::endl;
     }
 
-    double averageValue = (double) sum / (double) this->filterWindowWidth;
+    this->averagingWindow->clear();
+}
 
+void MovingAverageFilter::processData() {
     // Moving average filter cannot filter latest received value, it will always have little delay.
-    this->currentProcessedValue.first = this->valuesInFilterWindow[(this->filterWindowWidth)/2].first;
-    this->currentProcessedValue.second = averageValue;
+    this->processedResult.store(TimestampedValue{ this->averagingWindow->getCenterTimestamp(), this->averagingWindow->getResult() });
 }
 
 
@@ -10,10 +10,12 @@
 #ifndef MOVINGAVERAGEFILTER_H_
 #define MOVINGAVERAGEFILTER_H_
 
-#include <vector>
 #include <mutex>
 #include <atomic>
+#include <vector>
+#include "SeqLock.h"
 #include "SerialPortDataAnalyzer.h"
+#include "FilterKernel.h"
 
 class MovingAverageFilter: public SerialPortDataAnalyzer {
 public:
@@ -22,10 +24,10 @@ public:
      * Creates MovingAverageFilter with serialReader provided.
      *
      * params:
-     * serialReader - serial reader object
+     * serialReader - serial reader object or other source of readings (see SampleSource)
      * filterWindow - filter window size presented as difference between center and farthest position
      */
-    MovingAverageFilter(const std::shared_ptr<Serial>& serialReader, unsigned int filterWindow);
+    MovingAverageFilter(const std::shared_ptr<SampleSource>& serialReader, unsigned int filterWindow);
 
     /**
      * Creates MovingAverageFilter and creates new serial reader..
@@ -46,44 +48,58 @@ public:
      *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet,
      *  or error occured.
      */
-    virtual std::pair<std::time_t, double> getRawData();
+    virtual std::pair<SampleTimestamp, double> getRawData();
 
     /**
      *  Get latest processed read from serial port with timestamp.
      *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet
      *  or error occured.
      */
-    virtual std::pair<std::time_t, double> getProcessedData();
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
 
 private:
 
-    // Latest raw value - this value will always be equal to first value from
-    // valuesInFilterWindow (as long as rawValueLegit is true) but is declared
-    // separately for clarity.
-    std::pair<std::time_t, double> currentRawValue;
-    // Latest filtered value.
-    std::pair<std::time_t, double> currentProcessedValue;
-    // Vector of x latest read values needed to filter data.
-    std::vector<std::pair<std::time_t, double>> valuesInFilterWindow;
-
-    // Flags indicating whether results are legitimate already (enough amount of readings was gathered)
-    std::atomic<bool> rawValueLegit;
-    std::atomic<bool> processedValueLegit;
+    // Latest raw value and latest filtered value ({-1,0} when results are not legitimate yet).
+    // Written only by fetchNewBatch(), getters read them without locking, so polling
+    // consumers never block filtering.
+    SeqLock<TimestampedValue> rawResult;
+    SeqLock<TimestampedValue> processedResult;
+
+    // Window of x latest read values needed to filter data, kernel specialized at compile time
+    // for common widths (see FilterKernel).
+    std::unique_ptr<FilterKernel> averagingWindow;
+
     // Value storing desired size of filter length.
     unsigned int filterWindowWidth;
 
-    // Mutex to synchronise access to data (fetchNewData is called from different threads)
+    // Mutex to synchronise access to filter window (fetchNewData is called from different threads)
     std::mutex dataMutex;
 
+    // Values filtered from the current block, published to subscribers after it (see subscribe()).
+    std::vector<SerialSample> newResults;
+
     /**
      * Method used by Serial object to send latest data to analyzer.
      *
-     * param: data - freshly received data from serial port reader.
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, whole block is filtered
+     * under a single lock.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    /**
+     * Drops collected values after status reading (error, reconnection etc.).
+     * Method is not thread safe, lock mutex before calling.
      */
-    virtual void fetchNewData(const std::pair<std::time_t, std::string>& data);
+    void resetWindow(SampleStatus status);
 
     /**
-     * That method applies moving average filtering algorithm to received data.
+     * That method applies moving average filtering algorithm to received data and publishes the result.
+     * Method is not thread safe, lock mutex before calling.
      */
     void processData();
 
@@ -0,0 +1,25 @@
+/*
+ * MovingAverageStage.cpp
+ */
+
+#include "MovingAverageStage.h"
+
+MovingAverageStage::MovingAverageStage(unsigned int filterWindow)
+    :averagingWindow(FilterKernel::createAverage(2*filterWindow + 1)) {
+}
+
+bool MovingAverageStage::process(const TimestampedValue& input, TimestampedValue& output) {
+    this->averagingWindow->push(input.timestamp, input.value);
+
+    if (!this->averagingWindow->isFull()) {
+        return false;
+    }
+
+    output.timestamp = this->averagingWindow->getCenterTimestamp();
+    output.value = this->averagingWindow->getResult();
+    return true;
+}
+
+void MovingAverageStage::reset() {
+    this->averagingWindow->clear();
+}
@@ -0,0 +1,30 @@
+/*
+ * MovingAverageStage.h
+ *
+ * Mean of the last 2*filterWindow + 1 values, with timestamp of the middle one.
+ * Produces output once the window is full.
+ */
+
+#ifndef MOVINGAVERAGESTAGE_H_
+#define MOVINGAVERAGESTAGE_H_
+
+#include <memory>
+
+#include "FilterKernel.h"
+#include "FilterStage.h"
+
+class MovingAverageStage: public FilterStage {
+public:
+    // filterWindow - filter window size presented as difference between center and farthest position
+    explicit MovingAverageStage(unsigned int filterWindow);
+
+    virtual bool process(const TimestampedValue& input, TimestampedValue& output);
+
+    virtual void reset();
+
+private:
+    // Window of latest values (see FilterKernel).
+    std::unique_ptr<FilterKernel> averagingWindow;
+};
+
+#endif /* MOVINGAVERAGESTAGE_H_ */
@@ -0,0 +1,190 @@
+/*
+ * MultiChannelFilter.cpp
+ */
+
+#include "MultiChannelFilter.h"
+
+#include <algorithm>
+#include <iostream>
+
+MultiChannelFilter::MultiChannelFilter(const std::shared_ptr<SampleSource>& serialReader, std::size_t channelCount,
+                                       unsigned int filterWindow, Type type)
+    :SerialPortDataAnalyzer(serialReader)
+    ,channelCount(std::max<std::size_t>(channelCount, 1))
+    ,channelWindows((type == Type::MEDIAN) ? ChannelKernel::createMedian(2*filterWindow + 1, this->channelCount) :
+                                             ChannelKernel::createAverage(2*filterWindow + 1, this->channelCount))
+    ,pendingRow(this->channelCount, 0)
+    ,pendingTimestamp(INVALID_TIMESTAMP)
+    ,pendingChannel(0)
+    ,completedRow(this->channelCount, 0)
+    ,droppedRowCount(0)
+    ,rawTimestamp(INVALID_TIMESTAMP)
+    ,rawRow(this->channelCount, 0)
+    ,processedTimestamp(INVALID_TIMESTAMP)
+    ,processedRow(this->channelCount, 0)
+    ,filteredRow(this->channelCount, 0) {
+    if (this->registerToSerialReader(this) == false) {
+        std::cout << "Error: registering to serial reader failed." << std::endl;
+    }
+}
+
+MultiChannelFilter::~MultiChannelFilter() {
+    this->deregisterFromSerialReader(this);
+}
+
+std::size_t MultiChannelFilter::getChannelCount() const {
+    return this->channelCount;
+}
+
+SampleTimestamp MultiChannelFilter::getRawChannels(std::vector<double>& values) {
+    std::scoped_lock resultLock(this->resultMutex);
+
+    values = this->rawRow;
+    return this->rawTimestamp;
+}
+
+SampleTimestamp MultiChannelFilter::getProcessedChannels(std::vector<double>& values) {
+    std::scoped_lock resultLock(this->resultMutex);
+
+    values = this->processedRow;
+    return this->processedTimestamp;
+}
+
+std::pair<SampleTimestamp, double> MultiChannelFilter::getRawData() {
+    std::scoped_lock resultLock(this->resultMutex);
+
+    return std::pair<SampleTimestamp, double>{ this->rawTimestamp, this->rawRow.front() };
+}
+
+std::pair<SampleTimestamp, double> MultiChannelFilter::getProcessedData() {
+    std::scoped_lock resultLock(this->resultMutex);
+
+    return std::pair<SampleTimestamp, double>{ this->processedTimestamp, this->processedRow.front() };
+}
+
+std::uint64_t MultiChannelFilter::getDroppedRowCount() const {
+    return this->droppedRowCount.load(std::memory_order_relaxed);
+}
+
+void MultiChannelFilter::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
+
+void MultiChannelFilter::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    std::scoped_lock dataLock(this->dataMutex);
+
+    // Latest message completed after the latest status reading.
+    const SerialSample* latestRowEnd = nullptr;
+
+    // Subscribers get filtered values of every message, not only of the latest one.
+    bool resultsSubscribed = this->resultPublisher.hasSubscribers();
+    // True when filteredRow holds results of the latest message already.
+    bool filteredRowCurrent = false;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const SerialSample& sample = samples[i];
+
+        if (sample.status != SampleStatus::VALUE) {
+            this->resetWindow(sample.status);
+            latestRowEnd = nullptr;
+
+            if (resultsSubscribed) {
+                this->newResults.push_back(sample);
+            }
+        }
+        else if (this->collectChannel(sample)) {
+            // Windows drop their oldest values by themselves, filtering is done once for the whole block
+            // unless subscribers need all results.
+            this->channelWindows->push(sample.timestamp, this->completedRow.data());
+            latestRowEnd = &sample;
+            filteredRowCurrent = false;
+
+            if (resultsSubscribed && this->channelWindows->isFull()) {
+                this->channelWindows->computeResults(this->filteredRow.data());
+                filteredRowCurrent = true;
+
+                SampleTimestamp centerTimestamp = this->channelWindows->getCenterTimestamp();
+                for (std::size_t channel = 0; channel < this->channelCount; ++channel) {
+                    this->newResults.push_back(SerialSample{ centerTimestamp, this->filteredRow[channel], SampleStatus::VALUE,
+                                                             sample.portId, static_cast<std::uint16_t>(channel) });
+                }
+            }
+        }
+    }
+
+    // Only the state after the whole block is published.
+    if (latestRowEnd != nullptr) {
+        bool windowFull = this->channelWindows->isFull();
+        if (windowFull && !filteredRowCurrent) {
+            this->channelWindows->computeResults(this->filteredRow.data());
+        }
+
+        std::scoped_lock resultLock(this->resultMutex);
+        this->rawTimestamp = latestRowEnd->timestamp;
+        this->rawRow = this->completedRow;
+        if (windowFull) {
+            // Filter cannot filter latest received message, it will always have little delay.
+            this->processedTimestamp = this->channelWindows->getCenterTimestamp();
+            this->processedRow = this->filteredRow;
+        }
+    }
+
+    if (!this->newResults.empty()) {
+        this->resultPublisher.publish(this->newResults.data(), this->newResults.size());
+        this->newResults.clear();
+    }
+}
+
+bool MultiChannelFilter::receivesAllChannels() const {
+    return true;
+}
+
+bool MultiChannelFilter::collectChannel(const SerialSample& sample) {
+    if (sample.channel == 0) {
+        this->dropPendingRow();
+        this->pendingTimestamp = sample.timestamp;
+    }
+    else if (sample.channel != this->pendingChannel || sample.timestamp != this->pendingTimestamp) {
+        // Reading does not continue collected message (lost readings, wrong channelCount
+        // or DROP_OLDEST policy) - the whole message is skipped.
+        this->dropPendingRow();
+        return false;
+    }
+
+    this->pendingRow[this->pendingChannel] = sample.value;
+    if (++this->pendingChannel < this->channelCount) {
+        return false;
+    }
+
+    this->pendingChannel = 0;
+    this->pendingRow.swap(this->completedRow);
+    return true;
+}
+
+void MultiChannelFilter::dropPendingRow() {
+    if (this->pendingChannel != 0) {
+        this->droppedRowCount.fetch_add(1, std::memory_order_relaxed);
+        this->pendingChannel = 0;
+    }
+}
+
+void MultiChannelFilter::resetWindow(SampleStatus status) {
+    // When no numeric value is provided all the values stop being legitimate and filter windows are cleared.
+    {
+        std::scoped_lock resultLock(this->resultMutex);
+        this->rawTimestamp = INVALID_TIMESTAMP;
+        std::fill(this->rawRow.begin(), this->rawRow.end(), 0);
+        this->processedTimestamp = INVALID_TIMESTAMP;
+        std::fill(this->processedRow.begin(), this->processedRow.end(), 0);
+    }
+
+    if (status == SampleStatus::RECONNECTED) {
+        std::cout << "Serial port reconnected - filter windows restarted." << std::endl;
+    }
+    else {
+        std::cout << "No data received - serial port reader is in " << sampleStatusName(status) << " state." << std::endl;
+    }
+
+    this->dropPendingRow();
+    this->channelWindows->clear();
+}
@@ -0,0 +1,151 @@
+/*
+ * MultiChannelFilter.h
+ *
+ * MultiChannelFilter applies median or moving average filtering to every channel of multi-channel
+ * device (see FrameFormat::multiChannel) at once. Message is parsed once by serial reader,
+ * channels are collected back into rows and filtered together (see ChannelKernel),
+ * so N channels do not need N analyzers.
+ *
+ * Subscribers (see subscribe()) get filtered values of every message as channelCount consecutive samples
+ * with the same timestamp, numbered with SerialSample::channel.
+ */
+
+#ifndef MULTICHANNELFILTER_H_
+#define MULTICHANNELFILTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ChannelKernel.h"
+#include "SerialPortDataAnalyzer.h"
+
+class MultiChannelFilter: public SerialPortDataAnalyzer {
+public:
+
+    // Filtering applied to every channel.
+    enum class Type {
+        MEDIAN,
+        MOVING_AVERAGE
+    };
+
+    /**
+     * Creates MultiChannelFilter with serialReader provided.
+     *
+     * params:
+     * serialReader - serial reader object or other source of readings (see SampleSource)
+     * channelCount - amount of values in every message, the same as FrameFormat::channelCount of the reader
+     * filterWindow - filter window size presented as difference between center and farthest position
+     * type - filtering applied to every channel
+     */
+    MultiChannelFilter(const std::shared_ptr<SampleSource>& serialReader, std::size_t channelCount,
+                       unsigned int filterWindow, Type type);
+
+    virtual ~MultiChannelFilter();
+
+    // Returns amount of filtered channels.
+    std::size_t getChannelCount() const;
+
+    /**
+     * Get latest message with values of all channels.
+     * param: values - filled with channelCount values (zeros when result is not legitimate)
+     * returns: timestamp of message, INVALID_TIMESTAMP when any data have not been received yet
+     * or error occured.
+     */
+    SampleTimestamp getRawChannels(std::vector<double>& values);
+
+    /**
+     * Get latest filtered values of all channels.
+     * param: values - filled with channelCount values (zeros when result is not legitimate)
+     * returns: timestamp of filtered message, INVALID_TIMESTAMP when window is not filled yet
+     * or error occured.
+     */
+    SampleTimestamp getProcessedChannels(std::vector<double>& values);
+
+    /**
+     *  Get latest raw value of channel 0 with timestamp.
+     *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet,
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getRawData();
+
+    /**
+     *  Get latest filtered value of channel 0 with timestamp.
+     *  returns: latest processed data with timestamp or (-1,0) when any data have not been received yet
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
+
+    // Returns amount of messages dropped because some of their channels were missing.
+    std::uint64_t getDroppedRowCount() const;
+
+private:
+
+    std::size_t channelCount;
+
+    // Windows of latest values of all channels.
+    std::unique_ptr<ChannelKernel> channelWindows;
+
+    // Message being collected from consecutive channel readings.
+    std::vector<double> pendingRow;
+    SampleTimestamp pendingTimestamp;
+    // Next expected channel, 0 when no message is being collected.
+    std::size_t pendingChannel;
+    // Latest complete message (swapped with pendingRow when message is completed).
+    std::vector<double> completedRow;
+
+    std::atomic<std::uint64_t> droppedRowCount;
+
+    // Mutex to synchronise access to filter window (fetchNewData is called from different threads)
+    std::mutex dataMutex;
+
+    // Latest raw and filtered messages (INVALID_TIMESTAMP when results are not legitimate yet).
+    // Rows are too big for SeqLock, getters copy them under resultMutex.
+    std::mutex resultMutex;
+    SampleTimestamp rawTimestamp;
+    std::vector<double> rawRow;
+    SampleTimestamp processedTimestamp;
+    std::vector<double> processedRow;
+
+    // Filtered values computed by channelWindows, published under resultMutex.
+    std::vector<double> filteredRow;
+
+    // Filtered values produced from the current block, one sample per channel, published to subscribers
+    // after it (see subscribe()).
+    std::vector<SerialSample> newResults;
+
+    /**
+     * Method used by Serial object to send latest data to analyzer.
+     *
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, whole block is filtered
+     * under a single lock.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    // Every channel of multi-channel messages is needed.
+    virtual bool receivesAllChannels() const;
+
+    /**
+     * Adds channel reading to collected message, complete message is moved to completedRow.
+     * returns: true when message was completed.
+     * Method is not thread safe, lock mutex before calling.
+     */
+    bool collectChannel(const SerialSample& sample);
+
+    // Drops message being collected, counts it when some channels were already collected.
+    void dropPendingRow();
+
+    /**
+     * Drops collected values after status reading (error, reconnection etc.).
+     * Method is not thread safe, lock mutex before calling.
+     */
+    void resetWindow(SampleStatus status);
+};
+
+#endif /* MULTICHANNELFILTER_H_ */
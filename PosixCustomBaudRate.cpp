@@ -0,0 +1,27 @@
+/*
+ * PosixCustomBaudRate.cpp
+ *
+ * Non-standard baud rates for Linux. Uses termios2 structure from kernel headers,
+ * which cannot be included together with <termios.h>.
+ */
+
+#include "PosixSerialTransport.h"
+
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+bool PosixSerialTransport::applyCustomBaudRate(int portDescriptor, unsigned int baudRate) {
+    struct termios2 portSettings;
+
+    if (ioctl(portDescriptor, TCGETS2, &portSettings) != 0) {
+        return false;
+    }
+
+    // BOTHER means that speed is given directly in c_ispeed/c_ospeed fields.
+    portSettings.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    portSettings.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    portSettings.c_ispeed = baudRate;
+    portSettings.c_ospeed = baudRate;
+
+    return ioctl(portDescriptor, TCSETS2, &portSettings) == 0;
+}
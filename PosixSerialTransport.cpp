@@ -0,0 +1,354 @@
+/*
+ * PosixSerialTransport.cpp
+ */
+
+#include "PosixSerialTransport.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+    struct StandardBaudRate {
+        unsigned int baudRate;
+        speed_t speed;
+    };
+
+    // Rates which have their own termios constant, other ones are set through termios2.
+    const StandardBaudRate STANDARD_BAUD_RATES[] = {
+        { 1200, B1200 }, { 2400, B2400 }, { 4800, B4800 }, { 9600, B9600 }, { 19200, B19200 },
+        { 38400, B38400 }, { 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+        { 460800, B460800 }, { 500000, B500000 }, { 576000, B576000 }, { 921600, B921600 },
+        { 1000000, B1000000 }, { 1152000, B1152000 }, { 1500000, B1500000 }, { 2000000, B2000000 },
+        { 2500000, B2500000 }, { 3000000, B3000000 }, { 3500000, B3500000 }, { 4000000, B4000000 }
+    };
+
+    // Granularity of waiting for the rest of a burst.
+    const int BURST_POLL_SLICE_MS = 1;
+
+    // Returns termios constant for given rate, B0 when rate is not standard.
+    speed_t findStandardSpeed(unsigned int baudRate) {
+        for (const StandardBaudRate& standardRate : STANDARD_BAUD_RATES) {
+            if (standardRate.baudRate == baudRate) {
+                return standardRate.speed;
+            }
+        }
+        return B0;
+    }
+
+    tcflag_t characterSizeFlag(unsigned int dataBits) {
+        switch (dataBits) {
+        case 5:
+            return CS5;
+        case 6:
+            return CS6;
+        case 7:
+            return CS7;
+        default:
+            return CS8;
+        }
+    }
+}
+
+PosixSerialTransport::PosixSerialTransport()
+    :portDescriptor(-1)
+    ,epollDescriptor(-1)
+    ,wakeupDescriptor(-1) {
+    this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    this->wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (this->epollDescriptor == -1 || this->wakeupDescriptor == -1) {
+        std::cout << "ERROR: could not create epoll instance for serial port." << std::endl;
+    }
+    else {
+        epoll_event wakeupEvent = {};
+        wakeupEvent.events = EPOLLIN;
+        wakeupEvent.data.fd = this->wakeupDescriptor;
+        epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->wakeupDescriptor, &wakeupEvent);
+    }
+}
+
+PosixSerialTransport::~PosixSerialTransport() {
+    this->close();
+
+    if (this->wakeupDescriptor != -1) {
+        ::close(this->wakeupDescriptor);
+    }
+    if (this->epollDescriptor != -1) {
+        ::close(this->epollDescriptor);
+    }
+}
+
+bool PosixSerialTransport::open(const std::string& portDesc, const SerialPortSettings& settings) {
+    if (this->epollDescriptor == -1 || this->wakeupDescriptor == -1) {
+        return false;
+    }
+
+    this->close();
+    this->settings = settings;
+
+    this->portDescriptor = ::open(portDesc.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (this->portDescriptor == -1) {
+        if (errno == ENOENT) {
+            std::cout << "ERROR: Handle was not attached. Reason: " << portDesc << " not available." << std::endl;
+        }
+        else {
+            std::cout << "ERROR: could not open " << portDesc << "." << std::endl;
+        }
+        return false;
+    }
+
+    if (!this->configurePort()) {
+        std::cout << "ALERT: Could not set Serial Port parameters" << std::endl;
+        this->close();
+        return false;
+    }
+
+    epoll_event portEvent = {};
+    portEvent.events = EPOLLIN;
+    portEvent.data.fd = this->portDescriptor;
+    if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->portDescriptor, &portEvent) == -1) {
+        std::cout << "ERROR: could not watch " << portDesc << " for incoming data." << std::endl;
+        this->close();
+        return false;
+    }
+
+    return true;
+}
+
+void PosixSerialTransport::close() {
+    if (this->portDescriptor != -1) {
+        epoll_ctl(this->epollDescriptor, EPOLL_CTL_DEL, this->portDescriptor, nullptr);
+        ::close(this->portDescriptor);
+        this->portDescriptor = -1;
+    }
+}
+
+bool PosixSerialTransport::isOpen() const {
+    return this->portDescriptor != -1;
+}
+
+SerialTransport::WaitResult PosixSerialTransport::waitForData(int timeoutMs) {
+    if (this->portDescriptor == -1) {
+        return WaitResult::FAILURE;
+    }
+
+    epoll_event events[2];
+    int eventCount = epoll_wait(this->epollDescriptor, events, 2, timeoutMs);
+
+    if (eventCount == -1) {
+        return (errno == EINTR) ? WaitResult::INTERRUPTED : WaitResult::FAILURE;
+    }
+    if (eventCount == 0) {
+        return WaitResult::TIMEOUT;
+    }
+
+    bool dataAvailable = false;
+    bool portFailed = false;
+    bool interrupted = false;
+
+    for (int i = 0; i < eventCount; ++i) {
+        if (events[i].data.fd == this->wakeupDescriptor) {
+            std::uint64_t counter;
+            while (::read(this->wakeupDescriptor, &counter, sizeof(counter)) > 0) {
+                // Drain all pending wake ups.
+            }
+            interrupted = true;
+        }
+        else if (events[i].events & EPOLLIN) {
+            // Even if hang up was reported too, remaining bytes are read first.
+            dataAvailable = true;
+        }
+        else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            portFailed = true;
+        }
+    }
+
+    if (interrupted) {
+        return WaitResult::INTERRUPTED;
+    }
+    if (dataAvailable) {
+        return this->waitForBurst() ? WaitResult::DATA_AVAILABLE : WaitResult::INTERRUPTED;
+    }
+    return portFailed ? WaitResult::FAILURE : WaitResult::TIMEOUT;
+}
+
+long PosixSerialTransport::readAvailable(char* buffer, std::size_t capacity) {
+    if (this->portDescriptor == -1) {
+        return -1;
+    }
+
+    std::size_t totalRead = 0;
+
+    // Drain driver buffer - keep reading until it is empty or our buffer is full.
+    while (totalRead < capacity) {
+        ssize_t bytesRead = ::read(this->portDescriptor, buffer + totalRead, capacity - totalRead);
+
+        if (bytesRead > 0) {
+            totalRead += static_cast<std::size_t>(bytesRead);
+        }
+        else if (bytesRead == 0) {
+            // End of file on tty means that device was disconnected.
+            return (totalRead > 0) ? static_cast<long>(totalRead) : -1;
+        }
+        else if (errno == EINTR) {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        else {
+            return (totalRead > 0) ? static_cast<long>(totalRead) : -1;
+        }
+    }
+
+    return static_cast<long>(totalRead);
+}
+
+bool PosixSerialTransport::waitForBurst() {
+    if (this->settings.minimumReadBytes <= 1 || this->settings.interByteTimeoutMs <= 0) {
+        return true;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    const std::chrono::milliseconds interByteTimeout(this->settings.interByteTimeoutMs);
+
+    int bufferedBytes = 0;
+    Clock::time_point lastArrival = Clock::now();
+
+    // Port descriptor stays readable the whole time, so only wake up descriptor is watched
+    // and amount of buffered bytes is checked after every slice.
+    pollfd wakeupEvent = {};
+    wakeupEvent.fd = this->wakeupDescriptor;
+    wakeupEvent.events = POLLIN;
+
+    while (true) {
+        int currentBytes = 0;
+        if (ioctl(this->portDescriptor, FIONREAD, &currentBytes) != 0) {
+            // Let readAvailable() find out what is wrong.
+            return true;
+        }
+        if (currentBytes >= static_cast<int>(this->settings.minimumReadBytes)) {
+            return true;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (currentBytes != bufferedBytes) {
+            // Inter-byte timer restarts with every new byte, like VTIME.
+            bufferedBytes = currentBytes;
+            lastArrival = now;
+        }
+        else if (now - lastArrival >= interByteTimeout) {
+            return true;
+        }
+
+        if (poll(&wakeupEvent, 1, BURST_POLL_SLICE_MS) > 0) {
+            // interrupt() was called - eventfd is drained by the next waitForData().
+            return false;
+        }
+    }
+}
+
+void PosixSerialTransport::interrupt() {
+    if (this->wakeupDescriptor != -1) {
+        std::uint64_t increment = 1;
+        ssize_t result = ::write(this->wakeupDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+}
+
+int PosixSerialTransport::getPollDescriptor() const {
+    return this->portDescriptor;
+}
+
+bool PosixSerialTransport::configurePort() {
+    termios portSettings = {};
+
+    if (tcgetattr(this->portDescriptor, &portSettings) != 0) {
+        return false;
+    }
+
+    // Raw mode - no echo, no line editing, no special characters handling.
+    cfmakeraw(&portSettings);
+
+    speed_t standardSpeed = findStandardSpeed(this->settings.baudRate);
+    if (standardSpeed != B0) {
+        cfsetispeed(&portSettings, standardSpeed);
+        cfsetospeed(&portSettings, standardSpeed);
+    }
+    else {
+        // Placeholder, actual rate is set through termios2 below.
+        cfsetispeed(&portSettings, B38400);
+        cfsetospeed(&portSettings, B38400);
+    }
+
+    // Character format
+    portSettings.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS);
+    portSettings.c_cflag |= characterSizeFlag(this->settings.dataBits) | CLOCAL | CREAD;
+
+    if (this->settings.parity != SerialPortSettings::Parity::NONE) {
+        portSettings.c_cflag |= PARENB;
+        if (this->settings.parity == SerialPortSettings::Parity::ODD) {
+            portSettings.c_cflag |= PARODD;
+        }
+        // Drop characters with parity errors instead of passing them further.
+        portSettings.c_iflag |= INPCK;
+        portSettings.c_iflag &= ~(IGNPAR | PARMRK);
+    }
+
+    if (this->settings.stopBits == SerialPortSettings::StopBits::TWO) {
+        portSettings.c_cflag |= CSTOPB;
+    }
+
+    // Flow control
+    portSettings.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if (this->settings.flowControl == SerialPortSettings::FlowControl::HARDWARE) {
+        portSettings.c_cflag |= CRTSCTS;
+    }
+    else if (this->settings.flowControl == SerialPortSettings::FlowControl::SOFTWARE) {
+        portSettings.c_iflag |= IXON | IXOFF;
+    }
+
+    // Port is non-blocking and epoll decides when to read, so read() should return immediately.
+    // Wake up semantics from settings are handled by waitForData().
+    portSettings.c_cc[VMIN] = 0;
+    portSettings.c_cc[VTIME] = 0;
+
+    if (tcsetattr(this->portDescriptor, TCSANOW, &portSettings) != 0) {
+        return false;
+    }
+
+    if (standardSpeed == B0 && !applyCustomBaudRate(this->portDescriptor, this->settings.baudRate)) {
+        std::cout << "ERROR: baud rate " << this->settings.baudRate << " is not supported by the port." << std::endl;
+        return false;
+    }
+
+    // Modem lines and latency mode are not supported by every device (e.g. pseudo-terminals),
+    // failures are ignored.
+    int dtrFlag = TIOCM_DTR;
+    ioctl(this->portDescriptor, this->settings.dtrEnabled ? TIOCMBIS : TIOCMBIC, &dtrFlag);
+
+    if (this->settings.lowLatency) {
+        serial_struct serialInfo = {};
+        if (ioctl(this->portDescriptor, TIOCGSERIAL, &serialInfo) == 0) {
+            serialInfo.flags |= ASYNC_LOW_LATENCY;
+            ioctl(this->portDescriptor, TIOCSSERIAL, &serialInfo);
+        }
+    }
+
+    // Flush any remaining characters in the buffers
+    tcflush(this->portDescriptor, TCIOFLUSH);
+
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * PosixSerialTransport.h
+ *
+ * Serial port transport for Linux based on termios. Port is opened in non-blocking mode,
+ * epoll is used to wait for incoming bytes and every wake up drains all bytes that
+ * are available in driver buffer.
+ */
+
+#ifndef POSIXSERIALTRANSPORT_H_
+#define POSIXSERIALTRANSPORT_H_
+
+#include "SerialTransport.h"
+
+class PosixSerialTransport: public SerialTransport {
+public:
+    PosixSerialTransport();
+
+    virtual ~PosixSerialTransport();
+
+    virtual bool open(const std::string& portDesc, const SerialPortSettings& settings);
+
+    virtual void close();
+
+    virtual bool isOpen() const;
+
+    virtual WaitResult waitForData(int timeoutMs);
+
+    virtual long readAvailable(char* buffer, std::size_t capacity);
+
+    virtual void interrupt();
+
+    virtual int getPollDescriptor() const;
+
+private:
+    // File descriptor of opened tty device, -1 when closed.
+    int portDescriptor;
+
+    // Epoll instance watching port descriptor and wake up descriptor.
+    int epollDescriptor;
+
+    // Eventfd used to interrupt waitForData().
+    int wakeupDescriptor;
+
+    // Settings given to the latest open() call.
+    SerialPortSettings settings;
+
+    /**
+     * Applies line settings (raw mode, baud rate, character format, flow control, DTR) to opened port.
+     * returns: true on success, false otherwise
+     */
+    bool configurePort();
+
+    /**
+     * Waits until minimumReadBytes are buffered or no byte arrives for interByteTimeoutMs.
+     * returns: false when wait was interrupted
+     */
+    bool waitForBurst();
+
+    /**
+     * Sets baud rate that has no Bxxx constant (Linux termios2 interface). Defined in separate
+     * translation unit, because kernel headers it needs conflict with <termios.h>.
+     * returns: true on success, false otherwise
+     */
+    static bool applyCustomBaudRate(int portDescriptor, unsigned int baudRate);
+};
+
+#endif /* POSIXSERIALTRANSPORT_H_ */
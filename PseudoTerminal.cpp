@@ -0,0 +1,75 @@
+/*
+ * PseudoTerminal.cpp
+ */
+
+#include "PseudoTerminal.h"
+
+#include <cerrno>
+#include <iostream>
+
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+PseudoTerminal::PseudoTerminal()
+    :masterDescriptor(-1)
+    ,slaveDescriptor(-1) {
+    char nameBuffer[128] = {0};
+
+    if (openpty(&this->masterDescriptor, &this->slaveDescriptor, nameBuffer, nullptr, nullptr) == -1) {
+        std::cout << "ERROR: could not open pseudo-terminal pair." << std::endl;
+        this->masterDescriptor = -1;
+        this->slaveDescriptor = -1;
+    }
+    else {
+        // Raw mode on both sides, so bytes are passed through unchanged.
+        termios settings = {};
+        tcgetattr(this->slaveDescriptor, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(this->slaveDescriptor, TCSANOW, &settings);
+
+        this->slaveName = nameBuffer;
+    }
+}
+
+PseudoTerminal::~PseudoTerminal() {
+    if (this->slaveDescriptor != -1) {
+        close(this->slaveDescriptor);
+    }
+    if (this->masterDescriptor != -1) {
+        close(this->masterDescriptor);
+    }
+}
+
+bool PseudoTerminal::isOpen() const {
+    return this->masterDescriptor != -1;
+}
+
+const std::string& PseudoTerminal::getSlaveName() const {
+    return this->slaveName;
+}
+
+bool PseudoTerminal::write(const char* data, std::size_t length) {
+    if (this->masterDescriptor == -1) {
+        return false;
+    }
+
+    std::size_t totalWritten = 0;
+    while (totalWritten < length) {
+        ssize_t bytesWritten = ::write(this->masterDescriptor, data + totalWritten, length - totalWritten);
+        if (bytesWritten > 0) {
+            totalWritten += static_cast<std::size_t>(bytesWritten);
+        }
+        else if (bytesWritten == -1 && errno == EINTR) {
+            continue;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int PseudoTerminal::getMasterDescriptor() const {
+    return this->masterDescriptor;
+}
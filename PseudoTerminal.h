@@ -0,0 +1,53 @@
+/*
+ * PseudoTerminal.h
+ *
+ * Pair of connected pseudo-terminal devices (Linux only). Slave side behaves like
+ * real serial port and can be opened by Serial object using getSlaveName(), everything
+ * written to master side shows up there. Allows running whole reading pipeline
+ * without any hardware attached.
+ */
+
+#ifndef PSEUDOTERMINAL_H_
+#define PSEUDOTERMINAL_H_
+
+#include <cstddef>
+#include <string>
+
+class PseudoTerminal {
+public:
+    // Opens new pseudo-terminal pair, check isOpen() for result.
+    PseudoTerminal();
+
+    ~PseudoTerminal();
+
+    PseudoTerminal(const PseudoTerminal&) = delete;
+    PseudoTerminal& operator=(const PseudoTerminal&) = delete;
+
+    // Checks if pair was opened successfully.
+    bool isOpen() const;
+
+    // Returns path of slave device ("/dev/pts/N") which should be passed to Serial.
+    const std::string& getSlaveName() const;
+
+    /**
+     * Writes data to master side, so it can be read from slave device.
+     * Blocks until everything is written.
+     *
+     * returns: true on success, false otherwise
+     */
+    bool write(const char* data, std::size_t length);
+
+    // Returns descriptor of master side (e.g. for custom polling).
+    int getMasterDescriptor() const;
+
+private:
+    // Master side descriptor, -1 when pair could not be opened.
+    int masterDescriptor;
+
+    // Slave side is kept opened, so master never sees hang up when reader reopens the port.
+    int slaveDescriptor;
+
+    std::string slaveName;
+};
+
+#endif /* PSEUDOTERMINAL_H_ */
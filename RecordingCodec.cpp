@@ -0,0 +1,366 @@
+/*
+ * RecordingCodec.cpp
+ */
+
+#include "RecordingCodec.h"
+
+#include <cstring>
+
+namespace {
+    const char FILE_MAGIC[8] = { 'S', 'E', 'R', 'I', 'A', 'L', 'R', 'C' };
+    const char FOOTER_MAGIC[8] = { 'S', 'E', 'R', 'I', 'A', 'L', 'I', 'X' };
+    const std::uint32_t BLOCK_MAGIC = 0x4B4C4253; // "SBLK"
+
+    std::uint64_t zigzagEncode(std::int64_t value) {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t zigzagDecode(std::uint64_t value) {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::uint64_t doubleBits(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double bitsToDouble(std::uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+const std::uint32_t RecordingCodec::FORMAT_VERSION;
+const std::size_t RecordingCodec::FILE_HEADER_SIZE;
+const std::size_t RecordingCodec::BLOCK_HEADER_SIZE;
+const std::size_t RecordingCodec::INDEX_ENTRY_SIZE;
+const std::size_t RecordingCodec::FOOTER_SIZE;
+
+void RecordingCodec::writeFileHeader(const FileHeader& header, std::vector<char>& output) {
+    output.insert(output.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    putUint32(header.version, output);
+    putUint32(0, output);
+    putUint64(static_cast<std::uint64_t>(header.wallClockOffset), output);
+}
+
+bool RecordingCodec::readFileHeader(const char* data, std::size_t size, FileHeader& header) {
+    if (size < FILE_HEADER_SIZE || std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    header.version = getUint32(data + 8);
+    header.wallClockOffset = static_cast<std::int64_t>(getUint64(data + 16));
+    // Older versions lack only columns which are optional for decoder.
+    return header.version >= 1 && header.version <= FORMAT_VERSION;
+}
+
+RecordingCodec::BlockHeader RecordingCodec::encodeBlock(const SerialSample* samples, std::size_t count,
+                                                        std::vector<char>& output) {
+    BlockHeader header{ static_cast<std::uint32_t>(count), 0, 0, INVALID_TIMESTAMP, INVALID_TIMESTAMP };
+
+    // Header is filled in after payload is encoded.
+    std::size_t headerPosition = output.size();
+    output.resize(output.size() + BLOCK_HEADER_SIZE);
+    std::size_t payloadPosition = output.size();
+
+    // Timestamps column.
+    SampleTimestamp previousTimestamp = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        SampleTimestamp timestamp = samples[i].timestamp;
+        putVarint(zigzagEncode(timestamp - previousTimestamp), output);
+        previousTimestamp = timestamp;
+
+        if (timestamp != INVALID_TIMESTAMP) {
+            if (header.firstTimestamp == INVALID_TIMESTAMP || timestamp < header.firstTimestamp) {
+                header.firstTimestamp = timestamp;
+            }
+            if (timestamp > header.lastTimestamp) {
+                header.lastTimestamp = timestamp;
+            }
+        }
+    }
+
+    // Values column - neighbouring readings usually differ only in the low mantissa bytes,
+    // so control byte (trailing zero bytes << 4 | stored bytes) is followed by the changed bytes only.
+    std::uint64_t previousBits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t bits = doubleBits(samples[i].value);
+        std::uint64_t difference = bits ^ previousBits;
+        previousBits = bits;
+
+        unsigned int trailingZeroBytes = 0;
+        unsigned int storedBytes = 0;
+        if (difference != 0) {
+            while ((difference & 0xFF) == 0) {
+                difference >>= 8;
+                ++trailingZeroBytes;
+            }
+            for (std::uint64_t rest = difference; rest != 0; rest >>= 8) {
+                ++storedBytes;
+            }
+        }
+
+        output.push_back(static_cast<char>((trailingZeroBytes << 4) | storedBytes));
+        for (unsigned int byte = 0; byte < storedBytes; ++byte) {
+            output.push_back(static_cast<char>(difference >> (8 * byte)));
+        }
+    }
+
+    // Statuses column - runs of equal statuses.
+    for (std::size_t i = 0; i < count;) {
+        std::size_t runEnd = i + 1;
+        while (runEnd < count && samples[runEnd].status == samples[i].status) {
+            ++runEnd;
+        }
+        output.push_back(static_cast<char>(samples[i].status));
+        putVarint(runEnd - i, output);
+        i = runEnd;
+    }
+
+    // Port ids column - runs of equal ids.
+    for (std::size_t i = 0; i < count;) {
+        std::size_t runEnd = i + 1;
+        while (runEnd < count && samples[runEnd].portId == samples[i].portId) {
+            ++runEnd;
+        }
+        putVarint(samples[i].portId, output);
+        putVarint(runEnd - i, output);
+        i = runEnd;
+    }
+
+    // Channels column - runs of equal differences to previous channel (single value messages make
+    // a single run of 0, channels of multi-channel messages - runs of 1 broken by the return to 0).
+    std::uint16_t previousChannel = 0;
+    for (std::size_t i = 0; i < count;) {
+        std::int64_t difference = static_cast<std::int64_t>(samples[i].channel) - previousChannel;
+        std::size_t runEnd = i + 1;
+        while (runEnd < count &&
+               static_cast<std::int64_t>(samples[runEnd].channel) - samples[runEnd - 1].channel == difference) {
+            ++runEnd;
+        }
+        putVarint(zigzagEncode(difference), output);
+        putVarint(runEnd - i, output);
+        previousChannel = samples[runEnd - 1].channel;
+        i = runEnd;
+    }
+
+    header.payloadSize = static_cast<std::uint32_t>(output.size() - payloadPosition);
+    header.checksum = computeChecksum(output.data() + payloadPosition, header.payloadSize);
+
+    std::vector<char> headerBytes;
+    headerBytes.reserve(BLOCK_HEADER_SIZE);
+    putUint32(BLOCK_MAGIC, headerBytes);
+    putUint32(header.sampleCount, headerBytes);
+    putUint32(header.payloadSize, headerBytes);
+    putUint32(header.checksum, headerBytes);
+    putUint64(static_cast<std::uint64_t>(header.firstTimestamp), headerBytes);
+    putUint64(static_cast<std::uint64_t>(header.lastTimestamp), headerBytes);
+    std::memcpy(output.data() + headerPosition, headerBytes.data(), BLOCK_HEADER_SIZE);
+
+    return header;
+}
+
+bool RecordingCodec::readBlockHeader(const char* data, std::size_t size, BlockHeader& header) {
+    if (size < BLOCK_HEADER_SIZE || getUint32(data) != BLOCK_MAGIC) {
+        return false;
+    }
+
+    header.sampleCount = getUint32(data + 4);
+    header.payloadSize = getUint32(data + 8);
+    header.checksum = getUint32(data + 12);
+    header.firstTimestamp = static_cast<SampleTimestamp>(getUint64(data + 16));
+    header.lastTimestamp = static_cast<SampleTimestamp>(getUint64(data + 24));
+    return header.sampleCount > 0;
+}
+
+bool RecordingCodec::decodeBlock(const BlockHeader& header, const char* payload, std::vector<SerialSample>& samples) {
+    if (computeChecksum(payload, header.payloadSize) != header.checksum) {
+        return false;
+    }
+
+    const char* position = payload;
+    const char* end = payload + header.payloadSize;
+    std::size_t firstSample = samples.size();
+    std::size_t count = header.sampleCount;
+    samples.resize(firstSample + count);
+    SerialSample* decodedSamples = samples.data() + firstSample;
+
+    SampleTimestamp previousTimestamp = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t encodedDifference = 0;
+        if (!getVarint(position, end, encodedDifference)) {
+            samples.resize(firstSample);
+            return false;
+        }
+        previousTimestamp += zigzagDecode(encodedDifference);
+        decodedSamples[i].timestamp = previousTimestamp;
+    }
+
+    std::uint64_t previousBits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (position == end) {
+            samples.resize(firstSample);
+            return false;
+        }
+        unsigned char control = static_cast<unsigned char>(*position++);
+        unsigned int trailingZeroBytes = control >> 4;
+        unsigned int storedBytes = control & 0x0F;
+        if (storedBytes + trailingZeroBytes > 8 || static_cast<std::size_t>(end - position) < storedBytes) {
+            samples.resize(firstSample);
+            return false;
+        }
+
+        std::uint64_t difference = 0;
+        for (unsigned int byte = 0; byte < storedBytes; ++byte) {
+            difference |= static_cast<std::uint64_t>(static_cast<unsigned char>(*position++)) << (8 * byte);
+        }
+        previousBits ^= difference << (8 * trailingZeroBytes);
+        decodedSamples[i].value = bitsToDouble(previousBits);
+    }
+
+    for (std::size_t i = 0; i < count;) {
+        std::uint64_t runLength = 0;
+        if (position == end) {
+            samples.resize(firstSample);
+            return false;
+        }
+        SampleStatus status = static_cast<SampleStatus>(*position++);
+        if (!getVarint(position, end, runLength) || runLength == 0 || runLength > count - i) {
+            samples.resize(firstSample);
+            return false;
+        }
+        for (std::uint64_t run = 0; run < runLength; ++run) {
+            decodedSamples[i++].status = status;
+        }
+    }
+
+    for (std::size_t i = 0; i < count;) {
+        std::uint64_t portId = 0;
+        std::uint64_t runLength = 0;
+        if (!getVarint(position, end, portId) || !getVarint(position, end, runLength) ||
+                runLength == 0 || runLength > count - i) {
+            samples.resize(firstSample);
+            return false;
+        }
+        for (std::uint64_t run = 0; run < runLength; ++run) {
+            decodedSamples[i++].portId = static_cast<PortId>(portId);
+        }
+    }
+
+    // Blocks written by format version 1 end here, their readings keep channel 0.
+    std::int64_t channel = 0;
+    for (std::size_t i = 0; i < count && position != end;) {
+        std::uint64_t encodedDifference = 0;
+        std::uint64_t runLength = 0;
+        if (!getVarint(position, end, encodedDifference) || !getVarint(position, end, runLength) ||
+                runLength == 0 || runLength > count - i) {
+            samples.resize(firstSample);
+            return false;
+        }
+        std::int64_t difference = zigzagDecode(encodedDifference);
+        for (std::uint64_t run = 0; run < runLength; ++run) {
+            channel += difference;
+            if (channel < 0 || channel > 0xFFFF) {
+                samples.resize(firstSample);
+                return false;
+            }
+            decodedSamples[i++].channel = static_cast<std::uint16_t>(channel);
+        }
+    }
+
+    return true;
+}
+
+void RecordingCodec::writeIndex(const std::vector<IndexEntry>& index, std::uint64_t indexOffset, std::vector<char>& output) {
+    for (const IndexEntry& entry : index) {
+        putUint64(entry.offset, output);
+        putUint32(entry.sampleCount, output);
+        putUint32(0, output);
+        putUint64(static_cast<std::uint64_t>(entry.firstTimestamp), output);
+        putUint64(static_cast<std::uint64_t>(entry.lastTimestamp), output);
+    }
+
+    putUint64(indexOffset, output);
+    putUint64(index.size(), output);
+    output.insert(output.end(), FOOTER_MAGIC, FOOTER_MAGIC + sizeof(FOOTER_MAGIC));
+}
+
+bool RecordingCodec::readFooter(const char* data, std::uint64_t& indexOffset, std::uint64_t& blockCount) {
+    if (std::memcmp(data + 16, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) {
+        return false;
+    }
+
+    indexOffset = getUint64(data);
+    blockCount = getUint64(data + 8);
+    return true;
+}
+
+RecordingCodec::IndexEntry RecordingCodec::readIndexEntry(const char* data) {
+    IndexEntry entry;
+    entry.offset = getUint64(data);
+    entry.sampleCount = getUint32(data + 8);
+    entry.firstTimestamp = static_cast<SampleTimestamp>(getUint64(data + 16));
+    entry.lastTimestamp = static_cast<SampleTimestamp>(getUint64(data + 24));
+    return entry;
+}
+
+void RecordingCodec::putUint32(std::uint32_t value, std::vector<char>& output) {
+    for (int byte = 0; byte < 4; ++byte) {
+        output.push_back(static_cast<char>(value >> (8 * byte)));
+    }
+}
+
+void RecordingCodec::putUint64(std::uint64_t value, std::vector<char>& output) {
+    for (int byte = 0; byte < 8; ++byte) {
+        output.push_back(static_cast<char>(value >> (8 * byte)));
+    }
+}
+
+std::uint32_t RecordingCodec::getUint32(const char* data) {
+    std::uint32_t value = 0;
+    for (int byte = 0; byte < 4; ++byte) {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[byte])) << (8 * byte);
+    }
+    return value;
+}
+
+std::uint64_t RecordingCodec::getUint64(const char* data) {
+    std::uint64_t value = 0;
+    for (int byte = 0; byte < 8; ++byte) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[byte])) << (8 * byte);
+    }
+    return value;
+}
+
+void RecordingCodec::putVarint(std::uint64_t value, std::vector<char>& output) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<char>(value));
+}
+
+bool RecordingCodec::getVarint(const char*& position, const char* end, std::uint64_t& value) {
+    value = 0;
+
+    for (unsigned int shift = 0; shift < 64 && position != end; shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(*position++);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint32_t RecordingCodec::computeChecksum(const char* data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,120 @@
+/*
+ * RecordingCodec.h
+ *
+ * Binary layout of recording files written by RecordingWriter and read by RecordingReader.
+ *
+ * File layout (all numbers little endian):
+ *   file header | block | block | ... | block index | footer
+ *
+ * Every block holds up to RecordingWriter::BLOCK_SAMPLES readings stored column by column:
+ * - timestamps - zigzag varint of difference to previous timestamp,
+ * - values - XOR with previous value, only its non-zero bytes are stored,
+ * - statuses and port ids - run length encoded,
+ * - channels - run length encoded difference to previous channel (format version 2, version 1
+ *   files have no channel column - all readings are channel 0).
+ * Block header holds amount of readings, payload size and checksum, and the smallest and the biggest
+ * timestamp in the block. Index (copy of block headers with their file offsets) and footer are written
+ * when file is closed. When they are missing (e.g. application crashed), reader rebuilds index
+ * by walking block headers and skips torn block at the end of the file.
+ */
+
+#ifndef RECORDINGCODEC_H_
+#define RECORDINGCODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SampleClock.h"
+#include "SerialSample.h"
+
+class RecordingCodec {
+public:
+    static const std::uint32_t FORMAT_VERSION = 2;
+
+    static const std::size_t FILE_HEADER_SIZE = 24;
+    static const std::size_t BLOCK_HEADER_SIZE = 32;
+    static const std::size_t INDEX_ENTRY_SIZE = 32;
+    static const std::size_t FOOTER_SIZE = 24;
+
+    struct FileHeader {
+        std::uint32_t version;
+        // Value added to sample timestamps to get nanoseconds since Unix epoch.
+        std::int64_t wallClockOffset;
+    };
+
+    struct BlockHeader {
+        std::uint32_t sampleCount;
+        std::uint32_t payloadSize;
+        std::uint32_t checksum;
+        // Range of valid timestamps in the block, INVALID_TIMESTAMP when block has only status readings.
+        SampleTimestamp firstTimestamp;
+        SampleTimestamp lastTimestamp;
+    };
+
+    struct IndexEntry {
+        // Offset of block header from the beginning of the file.
+        std::uint64_t offset;
+        std::uint32_t sampleCount;
+        SampleTimestamp firstTimestamp;
+        SampleTimestamp lastTimestamp;
+    };
+
+    // Appends file header to output.
+    static void writeFileHeader(const FileHeader& header, std::vector<char>& output);
+
+    // Reads file header. Returns - false when data does not start with valid header
+    static bool readFileHeader(const char* data, std::size_t size, FileHeader& header);
+
+    /**
+     * Encodes readings as a single block (header and payload) appended to output.
+     *
+     * params:
+     * samples, count - readings to encode, at least 1
+     * output - buffer the block is appended to
+     * returns: header of encoded block
+     */
+    static BlockHeader encodeBlock(const SerialSample* samples, std::size_t count, std::vector<char>& output);
+
+    // Reads block header. Returns - false when data does not start with valid block header
+    static bool readBlockHeader(const char* data, std::size_t size, BlockHeader& header);
+
+    /**
+     * Decodes block payload, readings are appended to samples.
+     *
+     * params:
+     * header - header of the block
+     * payload - header.payloadSize bytes following block header
+     * samples - output vector
+     * returns: false when payload is corrupted (checksum or encoding does not match)
+     */
+    static bool decodeBlock(const BlockHeader& header, const char* payload, std::vector<SerialSample>& samples);
+
+    // Appends block index and footer to output. indexOffset - file offset where index starts
+    static void writeIndex(const std::vector<IndexEntry>& index, std::uint64_t indexOffset, std::vector<char>& output);
+
+    /**
+     * Reads footer from the last FOOTER_SIZE bytes of the file.
+     * returns: false when footer is missing
+     */
+    static bool readFooter(const char* data, std::uint64_t& indexOffset, std::uint64_t& blockCount);
+
+    // Reads single index entry (INDEX_ENTRY_SIZE bytes).
+    static IndexEntry readIndexEntry(const char* data);
+
+private:
+    static void putUint32(std::uint32_t value, std::vector<char>& output);
+    static void putUint64(std::uint64_t value, std::vector<char>& output);
+    static std::uint32_t getUint32(const char* data);
+    static std::uint64_t getUint64(const char* data);
+
+    static void putVarint(std::uint64_t value, std::vector<char>& output);
+
+    // Reads varint, moves position forward. Returns - false when varint does not end before end
+    static bool getVarint(const char*& position, const char* end, std::uint64_t& value);
+
+    // FNV-1a hash of the payload.
+    static std::uint32_t computeChecksum(const char* data, std::size_t size);
+};
+
+#endif /* RECORDINGCODEC_H_ */
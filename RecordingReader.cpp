@@ -0,0 +1,178 @@
+/*
+ * RecordingReader.cpp
+ */
+
+#include "RecordingReader.h"
+
+#include <algorithm>
+#include <iostream>
+
+RecordingReader::RecordingReader(const std::string& fileName)
+    :file(fileName)
+    ,fileSize(0)
+    ,headerValid(false)
+    ,recovered(false)
+    ,fileHeader{ 0, 0 }
+    ,sampleCount(0) {
+    if (!this->file.isOpen()) {
+        // Mapping reports reason of failure by itself.
+        return;
+    }
+    this->fileSize = this->file.getSize();
+
+    const char* headerData = this->getBytes(0, RecordingCodec::FILE_HEADER_SIZE);
+    if (headerData == nullptr ||
+            !RecordingCodec::readFileHeader(headerData, RecordingCodec::FILE_HEADER_SIZE, this->fileHeader)) {
+        std::cout << "ERROR: " << fileName << " is not a recording file or its version is not supported." << std::endl;
+        return;
+    }
+    this->headerValid = true;
+
+    if (!this->loadIndex()) {
+        this->rebuildIndex();
+        this->recovered = true;
+        std::cout << "Recording " << fileName << " was not closed properly, " << this->blockIndex.size()
+                  << " blocks recovered." << std::endl;
+    }
+
+    SampleTimestamp latestTimestamp = INVALID_TIMESTAMP;
+    this->latestTimestamps.reserve(this->blockIndex.size());
+    for (const RecordingCodec::IndexEntry& entry : this->blockIndex) {
+        latestTimestamp = std::max(latestTimestamp, entry.lastTimestamp);
+        this->latestTimestamps.push_back(latestTimestamp);
+        this->sampleCount += entry.sampleCount;
+    }
+}
+
+bool RecordingReader::isOpen() const {
+    return this->headerValid;
+}
+
+bool RecordingReader::wasRecovered() const {
+    return this->recovered;
+}
+
+std::int64_t RecordingReader::getWallClockOffset() const {
+    return this->fileHeader.wallClockOffset;
+}
+
+std::size_t RecordingReader::getBlockCount() const {
+    return this->blockIndex.size();
+}
+
+std::uint64_t RecordingReader::getSampleCount() const {
+    return this->sampleCount;
+}
+
+const RecordingCodec::IndexEntry& RecordingReader::getBlockInfo(std::size_t blockNumber) const {
+    return this->blockIndex.at(blockNumber);
+}
+
+std::size_t RecordingReader::findBlock(SampleTimestamp timestamp) const {
+    return static_cast<std::size_t>(std::lower_bound(this->latestTimestamps.begin(), this->latestTimestamps.end(), timestamp)
+                                    - this->latestTimestamps.begin());
+}
+
+bool RecordingReader::readBlock(std::size_t blockNumber, std::vector<SerialSample>& samples) {
+    if (blockNumber >= this->blockIndex.size()) {
+        return false;
+    }
+
+    const RecordingCodec::IndexEntry& entry = this->blockIndex[blockNumber];
+    RecordingCodec::BlockHeader header;
+    const char* headerData = this->getBytes(entry.offset, RecordingCodec::BLOCK_HEADER_SIZE);
+    if (headerData == nullptr ||
+            !RecordingCodec::readBlockHeader(headerData, RecordingCodec::BLOCK_HEADER_SIZE, header)) {
+        return false;
+    }
+
+    const char* payload = this->getBytes(entry.offset + RecordingCodec::BLOCK_HEADER_SIZE, header.payloadSize);
+    return (payload != nullptr) && RecordingCodec::decodeBlock(header, payload, samples);
+}
+
+bool RecordingReader::readRange(SampleTimestamp from, SampleTimestamp to, std::vector<SerialSample>& samples) {
+    std::vector<SerialSample> blockSamples;
+    bool inRange = false;
+
+    for (std::size_t blockNumber = this->findBlock(from); blockNumber < this->blockIndex.size(); ++blockNumber) {
+        SampleTimestamp blockStart = this->blockIndex[blockNumber].firstTimestamp;
+        if (blockStart != INVALID_TIMESTAMP && blockStart > to) {
+            break;
+        }
+
+        blockSamples.clear();
+        if (!this->readBlock(blockNumber, blockSamples)) {
+            return false;
+        }
+
+        for (const SerialSample& sample : blockSamples) {
+            if (sample.timestamp != INVALID_TIMESTAMP) {
+                inRange = (sample.timestamp >= from && sample.timestamp <= to);
+            }
+            if (inRange) {
+                samples.push_back(sample);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RecordingReader::loadIndex() {
+    if (this->fileSize < RecordingCodec::FILE_HEADER_SIZE + RecordingCodec::FOOTER_SIZE) {
+        return false;
+    }
+
+    std::uint64_t indexOffset = 0;
+    std::uint64_t blockCount = 0;
+    if (!RecordingCodec::readFooter(this->getBytes(this->fileSize - RecordingCodec::FOOTER_SIZE, RecordingCodec::FOOTER_SIZE),
+                                    indexOffset, blockCount)) {
+        return false;
+    }
+
+    if (indexOffset < RecordingCodec::FILE_HEADER_SIZE ||
+            indexOffset + blockCount * RecordingCodec::INDEX_ENTRY_SIZE + RecordingCodec::FOOTER_SIZE != this->fileSize) {
+        return false;
+    }
+
+    const char* indexData = this->getBytes(indexOffset, blockCount * RecordingCodec::INDEX_ENTRY_SIZE);
+
+    this->blockIndex.reserve(static_cast<std::size_t>(blockCount));
+    for (std::uint64_t i = 0; i < blockCount; ++i) {
+        this->blockIndex.push_back(RecordingCodec::readIndexEntry(indexData + i * RecordingCodec::INDEX_ENTRY_SIZE));
+    }
+    return true;
+}
+
+void RecordingReader::rebuildIndex() {
+    this->blockIndex.clear();
+
+    std::uint64_t offset = RecordingCodec::FILE_HEADER_SIZE;
+    std::vector<SerialSample> blockSamples;
+
+    while (offset + RecordingCodec::BLOCK_HEADER_SIZE <= this->fileSize) {
+        RecordingCodec::BlockHeader header;
+        if (!RecordingCodec::readBlockHeader(this->getBytes(offset, RecordingCodec::BLOCK_HEADER_SIZE),
+                                             RecordingCodec::BLOCK_HEADER_SIZE, header)) {
+            break;
+        }
+
+        // Block written only partially before crash fails here.
+        blockSamples.clear();
+        const char* payload = this->getBytes(offset + RecordingCodec::BLOCK_HEADER_SIZE, header.payloadSize);
+        if (payload == nullptr || !RecordingCodec::decodeBlock(header, payload, blockSamples)) {
+            break;
+        }
+
+        this->blockIndex.push_back(RecordingCodec::IndexEntry{ offset, header.sampleCount,
+                                                               header.firstTimestamp, header.lastTimestamp });
+        offset += RecordingCodec::BLOCK_HEADER_SIZE + header.payloadSize;
+    }
+}
+
+const char* RecordingReader::getBytes(std::uint64_t offset, std::uint64_t size) const {
+    if (offset > this->fileSize || size > this->fileSize - offset) {
+        return nullptr;
+    }
+    return this->file.getData() + offset;
+}
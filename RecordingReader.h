@@ -0,0 +1,99 @@
+/*
+ * RecordingReader.h
+ *
+ * Reads recording files written by RecordingWriter. File is memory mapped and blocks are decoded
+ * straight from the mapping. Block index is loaded when file is opened, so reading a time range
+ * decodes only blocks which can contain it. Recording that was not closed properly (no index)
+ * can be read as well - index is rebuilt and torn block at the end is skipped.
+ */
+
+#ifndef RECORDINGREADER_H_
+#define RECORDINGREADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "RecordingCodec.h"
+#include "SerialSample.h"
+
+class RecordingReader {
+public:
+    // Opens recording and loads its index, check isOpen() for result.
+    explicit RecordingReader(const std::string& fileName);
+
+    // Checks if file is opened and has valid header.
+    bool isOpen() const;
+
+    // Returns true when index was rebuilt, because file was not closed properly.
+    bool wasRecovered() const;
+
+    // Returns value which added to timestamps of the recording gives nanoseconds since Unix epoch.
+    std::int64_t getWallClockOffset() const;
+
+    // Returns amount of blocks in the recording.
+    std::size_t getBlockCount() const;
+
+    // Returns amount of readings in the recording.
+    std::uint64_t getSampleCount() const;
+
+    // Returns index entry of given block (file offset, amount of readings, time range).
+    const RecordingCodec::IndexEntry& getBlockInfo(std::size_t blockNumber) const;
+
+    /**
+     * Finds the first block that can contain readings captured at given time or later.
+     * returns: block number, getBlockCount() when all readings are older
+     */
+    std::size_t findBlock(SampleTimestamp timestamp) const;
+
+    /**
+     * Decodes single block.
+     *
+     * params:
+     * blockNumber - number of block
+     * samples - readings of the block are appended to that vector
+     * returns: false when block does not exist or is corrupted
+     */
+    bool readBlock(std::size_t blockNumber, std::vector<SerialSample>& samples);
+
+    /**
+     * Reads readings captured in given time range. Status readings are included when they
+     * follow a reading from that range.
+     *
+     * params:
+     * from, to - time range (inclusive)
+     * samples - readings are appended to that vector in recorded order
+     * returns: false when one of the blocks is corrupted
+     */
+    bool readRange(SampleTimestamp from, SampleTimestamp to, std::vector<SerialSample>& samples);
+
+private:
+    MappedFile file;
+    std::uint64_t fileSize;
+
+    bool headerValid;
+    bool recovered;
+
+    RecordingCodec::FileHeader fileHeader;
+
+    std::vector<RecordingCodec::IndexEntry> blockIndex;
+
+    // The biggest last timestamp of blocks up to given one - non decreasing even when readings
+    // of different ports were recorded slightly out of order, so it can be binary searched.
+    std::vector<SampleTimestamp> latestTimestamps;
+
+    std::uint64_t sampleCount;
+
+    // Reads index written by RecordingWriter::close(). Returns - false when file has no valid index
+    bool loadIndex();
+
+    // Builds index by walking block headers, stops at the first invalid block.
+    void rebuildIndex();
+
+    // Returns pointer to size bytes at given offset, nullptr when file is shorter.
+    const char* getBytes(std::uint64_t offset, std::uint64_t size) const;
+};
+
+#endif /* RECORDINGREADER_H_ */
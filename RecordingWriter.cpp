@@ -0,0 +1,183 @@
+/*
+ * RecordingWriter.cpp
+ */
+
+#include "RecordingWriter.h"
+
+#include <algorithm>
+#include <iostream>
+
+const std::size_t RecordingWriter::BLOCK_SAMPLES;
+const std::size_t RecordingWriter::WRITE_BUFFER_SIZE;
+
+RecordingWriter::RecordingWriter(const std::string& fileName, std::chrono::milliseconds flushInterval)
+    :fileName(fileName)
+    ,flushInterval(flushInterval)
+    ,lastFlushTime(std::chrono::steady_clock::now())
+    ,fileOffset(0)
+    ,sampleCount(0)
+    ,writeRequested(false)
+    ,writerActive(false)
+    ,writeFailed(false) {
+    this->file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!this->file.is_open()) {
+        std::cout << "ERROR: could not create recording file " << fileName << std::endl;
+        return;
+    }
+
+    this->pendingBlock.reserve(BLOCK_SAMPLES);
+    this->encodedData.reserve(WRITE_BUFFER_SIZE);
+
+    // Header goes to disk together with the first blocks.
+    RecordingCodec::FileHeader header{ RecordingCodec::FORMAT_VERSION, SampleClock::toWallClockNanoseconds(0) };
+    RecordingCodec::writeFileHeader(header, this->encodedData);
+    this->fileOffset = this->encodedData.size();
+
+    this->writerActive = true;
+    this->writerThread = std::thread([this] {this->runWriter(); });
+}
+
+RecordingWriter::~RecordingWriter() {
+    this->close();
+}
+
+bool RecordingWriter::isOpen() const {
+    return this->file.is_open();
+}
+
+void RecordingWriter::append(const SerialSample* samples, std::size_t count) {
+    if (!this->isOpen()) {
+        return;
+    }
+
+    std::size_t appended = 0;
+    while (appended < count) {
+        std::size_t chunk = std::min(count - appended, BLOCK_SAMPLES - this->pendingBlock.size());
+        this->pendingBlock.insert(this->pendingBlock.end(), samples + appended, samples + appended + chunk);
+        appended += chunk;
+
+        if (this->pendingBlock.size() == BLOCK_SAMPLES) {
+            this->encodePendingBlock();
+        }
+    }
+    this->sampleCount += count;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (this->encodedData.size() >= WRITE_BUFFER_SIZE) {
+        this->handOver();
+        this->lastFlushTime = now;
+    }
+    else if (now - this->lastFlushTime >= this->flushInterval) {
+        // Readings arrive slowly - do not keep them in memory for long, even if block is not full.
+        this->encodePendingBlock();
+        this->handOver();
+        this->lastFlushTime = now;
+    }
+}
+
+void RecordingWriter::flush() {
+    if (!this->isOpen()) {
+        return;
+    }
+
+    this->encodePendingBlock();
+    this->handOver();
+    this->waitForWriter();
+    this->lastFlushTime = std::chrono::steady_clock::now();
+}
+
+void RecordingWriter::close() {
+    if (!this->isOpen()) {
+        return;
+    }
+
+    this->encodePendingBlock();
+    RecordingCodec::writeIndex(this->blockIndex, this->fileOffset, this->encodedData);
+    this->handOver();
+
+    {
+        std::scoped_lock writerLock(this->writerMutex);
+        this->writerActive = false;
+    }
+    this->writerNotifier.notify_all();
+    this->writerThread.join();
+
+    this->file.close();
+}
+
+std::uint64_t RecordingWriter::getSampleCount() const {
+    return this->sampleCount;
+}
+
+std::uint64_t RecordingWriter::getWrittenBytes() const {
+    return this->fileOffset;
+}
+
+void RecordingWriter::runWriter() {
+    std::unique_lock<std::mutex> writerLock(this->writerMutex);
+
+    while (true) {
+        this->writerNotifier.wait(writerLock, [this] {
+            return this->writeRequested || !this->writerActive;
+        });
+
+        if (!this->writeRequested) {
+            // Stopped and everything is written.
+            return;
+        }
+
+        // Producer does not touch writeBuffer while writeRequested is set.
+        writerLock.unlock();
+        this->file.write(this->writeBuffer.data(), static_cast<std::streamsize>(this->writeBuffer.size()));
+        this->file.flush();
+        bool writeSucceeded = this->file.good();
+        writerLock.lock();
+
+        if (!writeSucceeded && !this->writeFailed) {
+            this->writeFailed = true;
+            std::cout << "ERROR: writing to recording file " << this->fileName << " failed." << std::endl;
+        }
+
+        this->writeBuffer.clear();
+        this->writeRequested = false;
+        this->writerNotifier.notify_all();
+    }
+}
+
+void RecordingWriter::encodePendingBlock() {
+    if (this->pendingBlock.empty()) {
+        return;
+    }
+
+    RecordingCodec::BlockHeader header = RecordingCodec::encodeBlock(this->pendingBlock.data(), this->pendingBlock.size(),
+                                                                     this->encodedData);
+    this->blockIndex.push_back(RecordingCodec::IndexEntry{ this->fileOffset, header.sampleCount,
+                                                           header.firstTimestamp, header.lastTimestamp });
+    this->fileOffset += RecordingCodec::BLOCK_HEADER_SIZE + header.payloadSize;
+    this->pendingBlock.clear();
+}
+
+void RecordingWriter::handOver() {
+    if (this->encodedData.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> writerLock(this->writerMutex);
+    // Double buffering - waits only when disk is slower than incoming readings.
+    this->writerNotifier.wait(writerLock, [this] {
+        return !this->writeRequested;
+    });
+
+    // Empty writeBuffer keeps its capacity, so buffers are reused.
+    this->encodedData.swap(this->writeBuffer);
+    this->writeRequested = true;
+    writerLock.unlock();
+    this->writerNotifier.notify_all();
+}
+
+void RecordingWriter::waitForWriter() {
+    std::unique_lock<std::mutex> writerLock(this->writerMutex);
+    this->writerNotifier.wait(writerLock, [this] {
+        return !this->writeRequested;
+    });
+}
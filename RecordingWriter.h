@@ -0,0 +1,133 @@
+/*
+ * RecordingWriter.h
+ *
+ * Writes readings into binary recording file (see RecordingCodec for layout).
+ *
+ * Readings are collected into blocks of BLOCK_SAMPLES, every full block is compressed into
+ * a memory buffer and only buffers of WRITE_BUFFER_SIZE are written to disk - by a background
+ * thread, so appending never waits for the disk unless the disk does not keep up at all.
+ * Block index for time range seeks is written when file is closed.
+ *
+ * append() and flush() have to be called from a single thread (e.g. by a single analyzer).
+ */
+
+#ifndef RECORDINGWRITER_H_
+#define RECORDINGWRITER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RecordingCodec.h"
+#include "SerialSample.h"
+
+class RecordingWriter {
+public:
+    // Maximal amount of readings in a single block.
+    static const std::size_t BLOCK_SAMPLES = 4096;
+
+    // Amount of encoded data collected before it is given to the background thread.
+    static const std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+    /**
+     * Creates (or truncates) recording file, check isOpen() for result.
+     *
+     * params:
+     * fileName - path of recording file
+     * flushInterval - the longest time readings are kept in memory when they arrive slowly,
+     *                 checked on every append()
+     */
+    explicit RecordingWriter(const std::string& fileName,
+                             std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000));
+
+    // Closes file (writes remaining readings and index).
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    // Checks if file is opened.
+    bool isOpen() const;
+
+    /**
+     * Adds readings to the recording.
+     *
+     * params:
+     * samples - readings in order of arrival (values and status readings)
+     * count - amount of readings
+     */
+    void append(const SerialSample* samples, std::size_t count);
+
+    // Encodes collected readings (even incomplete block) and waits until everything is on disk.
+    void flush();
+
+    // Writes remaining readings, block index and closes file. Does nothing when file is closed.
+    void close();
+
+    // Returns amount of readings appended so far.
+    std::uint64_t getSampleCount() const;
+
+    // Returns size of encoded recording so far (written to disk or waiting for it).
+    std::uint64_t getWrittenBytes() const;
+
+private:
+    std::string fileName;
+    std::ofstream file;
+
+    std::chrono::milliseconds flushInterval;
+    std::chrono::steady_clock::time_point lastFlushTime;
+
+    // Readings of the block being collected.
+    std::vector<SerialSample> pendingBlock;
+
+    // Encoded blocks not given to background thread yet.
+    std::vector<char> encodedData;
+
+    // Index of all encoded blocks.
+    std::vector<RecordingCodec::IndexEntry> blockIndex;
+
+    // File offset of the next encoded byte.
+    std::atomic<std::uint64_t> fileOffset;
+
+    std::atomic<std::uint64_t> sampleCount;
+
+    // Protects writeBuffer, writeRequested, writerActive and writeFailed.
+    std::mutex writerMutex;
+
+    // Signalled when buffer is given to background thread or it finishes writing.
+    std::condition_variable writerNotifier;
+
+    // Buffer being written by background thread.
+    std::vector<char> writeBuffer;
+
+    // True while writeBuffer waits for background thread or is being written.
+    bool writeRequested;
+
+    bool writerActive;
+
+    // Set after the first failed write, error is printed only once.
+    bool writeFailed;
+
+    std::thread writerThread;
+
+    // Writes buffers given by handOver() until writer is stopped.
+    void runWriter();
+
+    // Encodes pendingBlock and adds it to the index.
+    void encodePendingBlock();
+
+    // Gives encodedData to background thread, waits when it is still busy with previous buffer.
+    void handOver();
+
+    // Waits until background thread writes everything it was given.
+    void waitForWriter();
+};
+
+#endif /* RECORDINGWRITER_H_ */
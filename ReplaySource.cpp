@@ -0,0 +1,209 @@
+/*
+ * ReplaySource.cpp
+ */
+
+#include "ReplaySource.h"
+#include "RecordingWriter.h"
+#include "SerialPortDataAnalyzer.h"
+
+#include <iostream>
+
+constexpr double ReplaySource::MAX_SPEED;
+
+ReplaySource::ReplaySource(const std::string& fileName, double speedMultiplier, std::size_t dispatchThreads)
+    :reader(fileName)
+    ,speedMultiplier(speedMultiplier > 0 ? speedMultiplier : MAX_SPEED)
+    ,analyzerDispatcher(dispatchThreads)
+    ,lastReading(SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, 0 })
+    ,replayedCount(0)
+    ,replaying(false)
+    ,started(false)
+    ,stopRequested(false) {
+}
+
+ReplaySource::~ReplaySource() {
+    this->stop();
+
+    if (this->replayThread.joinable()) {
+        this->replayThread.join();
+    }
+
+    // Analyzers get everything that was dispatched before workers stop.
+    this->analyzerDispatcher.shutdown();
+}
+
+bool ReplaySource::isOpen() const {
+    return this->reader.isOpen();
+}
+
+bool ReplaySource::start(SampleTimestamp startTimestamp) {
+    std::scoped_lock replayLock(this->replayMutex);
+
+    if (!this->reader.isOpen() || this->started) {
+        return false;
+    }
+
+    this->started = true;
+    this->replaying = true;
+    this->replayThread = std::thread([this, startTimestamp] {this->replay(startTimestamp); });
+    return true;
+}
+
+void ReplaySource::stop() {
+    {
+        std::scoped_lock replayLock(this->replayMutex);
+        this->stopRequested = true;
+    }
+    this->replayNotifier.notify_all();
+}
+
+void ReplaySource::waitUntilFinished() {
+    {
+        std::unique_lock<std::mutex> replayLock(this->replayMutex);
+        this->replayNotifier.wait(replayLock, [this] {
+            return !this->started || !this->replaying;
+        });
+    }
+    this->analyzerDispatcher.waitUntilIdle();
+}
+
+SerialSample ReplaySource::getData() {
+    return this->lastReading.load();
+}
+
+bool ReplaySource::IsConnected() {
+    return this->replaying;
+}
+
+std::uint64_t ReplaySource::getReplayedCount() const {
+    return this->replayedCount;
+}
+
+std::uint64_t ReplaySource::getRecordedCount() const {
+    return this->reader.getSampleCount();
+}
+
+bool ReplaySource::registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                        std::size_t queueCapacity) {
+    if (analyzerToRegister != nullptr && this->reader.isOpen()) {
+        // Dispatcher rejects analyzers that are already registered.
+        return this->analyzerDispatcher.addAnalyzer(analyzerToRegister, policy, queueCapacity);
+    }
+    else
+        return false;
+}
+
+void ReplaySource::deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
+    this->analyzerDispatcher.removeAnalyzer(analyzerToDeregister);
+}
+
+void ReplaySource::replay(SampleTimestamp startTimestamp) {
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<SerialSample> blockSamples;
+    blockSamples.reserve(RecordingWriter::BLOCK_SAMPLES);
+
+    // Ports which appeared in replayed readings, each of them gets CLOSED reading at the end.
+    std::vector<bool> replayedPorts(static_cast<std::size_t>(ALL_PORTS) + 1, false);
+
+    // Recorded time of the first replayed value and the moment it was replayed - every other
+    // value is replayed after (its timestamp - firstTimestamp) / speedMultiplier.
+    SampleTimestamp firstTimestamp = INVALID_TIMESTAMP;
+    Clock::time_point replayStart;
+
+    bool skipping = (startTimestamp != INVALID_TIMESTAMP);
+    std::size_t firstBlock = skipping ? this->reader.findBlock(startTimestamp) : 0;
+    bool stopped = false;
+
+    for (std::size_t blockNumber = firstBlock; blockNumber < this->reader.getBlockCount() && !stopped; ++blockNumber) {
+        blockSamples.clear();
+        if (!this->reader.readBlock(blockNumber, blockSamples)) {
+            std::cout << "ERROR: recording block " << blockNumber << " is corrupted, replaying stopped." << std::endl;
+            break;
+        }
+
+        std::size_t position = 0;
+        if (skipping) {
+            while (position < blockSamples.size() && (blockSamples[position].timestamp == INVALID_TIMESTAMP ||
+                                                      blockSamples[position].timestamp < startTimestamp)) {
+                ++position;
+            }
+            skipping = (position == blockSamples.size());
+        }
+
+        for (std::size_t i = position; i < blockSamples.size(); ++i) {
+            replayedPorts[blockSamples[i].portId] = true;
+        }
+
+        while (position < blockSamples.size()) {
+            std::size_t end = blockSamples.size();
+
+            if (this->speedMultiplier != MAX_SPEED) {
+                // Readings which are due already go together, then thread waits for the next one.
+                Clock::time_point now = Clock::now();
+                Clock::time_point nextDueTime = now;
+
+                for (end = position; end < blockSamples.size(); ++end) {
+                    SampleTimestamp timestamp = blockSamples[end].timestamp;
+                    if (timestamp == INVALID_TIMESTAMP) {
+                        continue;
+                    }
+                    if (firstTimestamp == INVALID_TIMESTAMP) {
+                        firstTimestamp = timestamp;
+                        replayStart = now;
+                    }
+
+                    std::chrono::nanoseconds recordedOffset(static_cast<std::int64_t>(
+                            static_cast<double>(timestamp - firstTimestamp) / this->speedMultiplier));
+                    nextDueTime = replayStart + std::chrono::duration_cast<Clock::duration>(recordedOffset);
+                    if (nextDueTime > now) {
+                        break;
+                    }
+                }
+
+                if (end == position) {
+                    if (!this->waitUntil(nextDueTime)) {
+                        stopped = true;
+                        break;
+                    }
+                    continue;
+                }
+            }
+            else if (this->stopRequested) {
+                stopped = true;
+                break;
+            }
+
+            this->publish(blockSamples.data() + position, end - position);
+            position = end;
+        }
+    }
+
+    // Analyzers are told that no more readings come.
+    for (std::size_t portId = 0; portId < replayedPorts.size(); ++portId) {
+        if (replayedPorts[portId]) {
+            SerialSample closedSample{ INVALID_TIMESTAMP, 0, SampleStatus::CLOSED, static_cast<PortId>(portId) };
+            this->publish(&closedSample, 1);
+        }
+    }
+
+    {
+        std::scoped_lock replayLock(this->replayMutex);
+        this->replaying = false;
+    }
+    this->replayNotifier.notify_all();
+}
+
+bool ReplaySource::waitUntil(std::chrono::steady_clock::time_point wakeUpTime) {
+    std::unique_lock<std::mutex> replayLock(this->replayMutex);
+    this->replayNotifier.wait_until(replayLock, wakeUpTime, [this] {
+        return this->stopRequested.load();
+    });
+    return !this->stopRequested;
+}
+
+void ReplaySource::publish(const SerialSample* samples, std::size_t count) {
+    this->analyzerDispatcher.dispatch(samples, count);
+    this->lastReading.store(samples[count - 1]);
+    this->replayedCount += count;
+}
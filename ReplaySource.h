@@ -0,0 +1,143 @@
+/*
+ * ReplaySource.h
+ *
+ * Source of readings taken from a recording (see RecordingWriter) instead of serial port.
+ * Analyzers register to it exactly like to Serial, so recorded data can be processed again
+ * by any analyzer without a device - e.g. to reprocess history or benchmark filters on always
+ * the same input.
+ *
+ * Recording is memory mapped and replayed by a single thread: at original speed, N times faster,
+ * or as fast as analyzers take readings (MAX_SPEED). Readings keep their recorded timestamps.
+ * When recording ends, every replayed port gets CLOSED reading.
+ *
+ * Example:
+ *   std::shared_ptr<ReplaySource> replay = std::make_shared<ReplaySource>("RawData.rec", ReplaySource::MAX_SPEED);
+ *   MedianFilter median(replay, 2);
+ *   replay->start();
+ *   replay->waitUntilFinished();
+ */
+
+#ifndef REPLAYSOURCE_H_
+#define REPLAYSOURCE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AnalyzerDispatcher.h"
+#include "RecordingReader.h"
+#include "SampleSource.h"
+#include "SeqLock.h"
+#include "SerialSample.h"
+
+class ReplaySource: public SampleSource {
+public:
+    // Speed multiplier replaying readings without any pacing.
+    static constexpr double MAX_SPEED = 0.0;
+
+    /**
+     * Opens recording, replaying starts with start().
+     *
+     * params:
+     * fileName - path of recording file
+     * speedMultiplier - 1.0 for original speed, 10.0 for ten times faster etc., MAX_SPEED for no pacing
+     * dispatchThreads - amount of threads running analyzers, 0 means one per processor core
+     */
+    explicit ReplaySource(const std::string& fileName, double speedMultiplier = 1.0,
+                          std::size_t dispatchThreads = AnalyzerDispatcher::SINGLE_SOURCE_WORKER_COUNT);
+
+    // Stops replaying, analyzers get everything that was replayed so far.
+    virtual ~ReplaySource();
+
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    // Checks if recording was opened.
+    bool isOpen() const;
+
+    /**
+     * Starts replaying on background thread. Analyzers should be registered before, so they
+     * get all readings.
+     *
+     * param: startTimestamp - readings captured before that time are skipped (found through block index),
+     *                         INVALID_TIMESTAMP to replay whole recording
+     * returns: true on success, false when recording is not opened or replaying was already started
+     */
+    bool start(SampleTimestamp startTimestamp = INVALID_TIMESTAMP);
+
+    // Stops replaying, does not wait for analyzers.
+    void stop();
+
+    // Blocks until whole recording is replayed (or replaying is stopped) and analyzers processed all readings.
+    void waitUntilFinished();
+
+    // Get last replayed reading.
+    virtual SerialSample getData();
+
+    // Check if readings are being replayed.
+    virtual bool IsConnected();
+
+    // Returns amount of readings replayed so far.
+    std::uint64_t getReplayedCount() const;
+
+    // Returns amount of readings in the recording.
+    std::uint64_t getRecordedCount() const;
+
+private:
+    RecordingReader reader;
+
+    // Time scale, MAX_SPEED for no pacing.
+    double speedMultiplier;
+
+    // Runs registered analyzers on worker threads, each one with its own queue
+    AnalyzerDispatcher analyzerDispatcher;
+
+    // Last replayed reading, read by getData() without locking.
+    SeqLock<SerialSample> lastReading;
+
+    std::atomic<std::uint64_t> replayedCount;
+
+    // True between start() and the end of recording (or stop()).
+    std::atomic<bool> replaying;
+
+    // Protects started, changes of stopRequested and the end of replaying.
+    std::mutex replayMutex;
+
+    // Signalled when replaying should stop or has finished.
+    std::condition_variable replayNotifier;
+
+    bool started;
+
+    // Checked by replay thread between blocks of readings without locking.
+    std::atomic<bool> stopRequested;
+
+    std::thread replayThread;
+
+    // Registers data analyzer with given queue policy.
+    virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                      std::size_t queueCapacity);
+
+    // Deregisters data analyzer, after return it is not run anymore.
+    virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister);
+
+    // Decodes blocks one by one and dispatches their readings on time.
+    void replay(SampleTimestamp startTimestamp);
+
+    /**
+     * Waits until given time, unless stop is requested.
+     * returns: false when stop was requested
+     */
+    bool waitUntil(std::chrono::steady_clock::time_point wakeUpTime);
+
+    // Dispatches readings and publishes the last one.
+    void publish(const SerialSample* samples, std::size_t count);
+};
+
+#endif /* REPLAYSOURCE_H_ */
@@ -0,0 +1,233 @@
+/*
+ * ResultPublisher.cpp
+ */
+
+#include "ResultPublisher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+const std::size_t ResultQueue::DEFAULT_CAPACITY;
+
+ResultQueue::ResultQueue(std::size_t capacity)
+    :capacity(capacity > 0 ? capacity : 1)
+    ,closed(false)
+    ,droppedCount(0)
+    ,waitDescriptor(-1) {
+#ifndef _WIN32
+    this->waitDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->waitDescriptor == -1) {
+        std::cout << "ERROR: could not create wait descriptor of result queue." << std::endl;
+    }
+#endif
+}
+
+ResultQueue::~ResultQueue() {
+#ifndef _WIN32
+    if (this->waitDescriptor != -1) {
+        ::close(this->waitDescriptor);
+    }
+#endif
+}
+
+bool ResultQueue::waitForResults(std::vector<SerialSample>& results, std::chrono::nanoseconds timeout) {
+    std::unique_lock<std::mutex> queueLock(this->queueMutex);
+
+    this->resultsAvailable.wait_for(queueLock, timeout, [this] {
+        return !this->pendingResults.empty() || this->closed;
+    });
+
+    return this->moveResults(results) > 0;
+}
+
+std::size_t ResultQueue::takeResults(std::vector<SerialSample>& results) {
+    std::scoped_lock queueLock(this->queueMutex);
+
+    return this->moveResults(results);
+}
+
+int ResultQueue::getWaitDescriptor() const {
+    return this->waitDescriptor;
+}
+
+bool ResultQueue::isClosed() {
+    std::scoped_lock queueLock(this->queueMutex);
+
+    return this->closed;
+}
+
+std::uint64_t ResultQueue::getDroppedCount() const {
+    return this->droppedCount.load(std::memory_order_relaxed);
+}
+
+void ResultQueue::push(const SerialSample* results, std::size_t count) {
+    {
+        std::scoped_lock queueLock(this->queueMutex);
+
+        if (this->closed) {
+            return;
+        }
+
+        // Consumer is woken up only when queue stops being empty.
+        bool wakeupNeeded = this->pendingResults.empty();
+
+        // Oldest results are dropped when consumer does not keep up.
+        if (count > this->capacity) {
+            this->droppedCount.fetch_add(count - this->capacity, std::memory_order_relaxed);
+            results += count - this->capacity;
+            count = this->capacity;
+        }
+        std::size_t overflow = this->pendingResults.size() + count;
+        if (overflow > this->capacity) {
+            overflow -= this->capacity;
+            this->pendingResults.erase(this->pendingResults.begin(), this->pendingResults.begin() + overflow);
+            this->droppedCount.fetch_add(overflow, std::memory_order_relaxed);
+        }
+        this->pendingResults.insert(this->pendingResults.end(), results, results + count);
+
+        if (!wakeupNeeded) {
+            return;
+        }
+        this->signalDescriptor();
+    }
+
+    this->resultsAvailable.notify_one();
+}
+
+void ResultQueue::close() {
+    {
+        std::scoped_lock queueLock(this->queueMutex);
+
+        if (this->closed) {
+            return;
+        }
+        this->closed = true;
+
+        // Descriptor stays readable, so consumer waiting with poll() notices closing.
+        if (this->pendingResults.empty()) {
+            this->signalDescriptor();
+        }
+    }
+
+    this->resultsAvailable.notify_all();
+}
+
+std::size_t ResultQueue::moveResults(std::vector<SerialSample>& results) {
+    results.assign(this->pendingResults.begin(), this->pendingResults.end());
+
+    if (!this->pendingResults.empty()) {
+        this->pendingResults.clear();
+        if (!this->closed) {
+            this->resetDescriptor();
+        }
+    }
+
+    return results.size();
+}
+
+void ResultQueue::signalDescriptor() {
+#ifndef _WIN32
+    if (this->waitDescriptor != -1) {
+        std::uint64_t increment = 1;
+        ssize_t result = write(this->waitDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+#endif
+}
+
+void ResultQueue::resetDescriptor() {
+#ifndef _WIN32
+    if (this->waitDescriptor != -1) {
+        std::uint64_t counter;
+        ssize_t result = read(this->waitDescriptor, &counter, sizeof(counter));
+        (void) result;
+    }
+#endif
+}
+
+ResultPublisher::ResultPublisher()
+    :nextSubscriptionId(1)
+    ,subscriberCount(0) {
+}
+
+ResultPublisher::~ResultPublisher() {
+    std::scoped_lock subscribersLock(this->subscribersMutex);
+
+    for (const std::weak_ptr<ResultQueue>& queueReference : this->queues) {
+        std::shared_ptr<ResultQueue> queue = queueReference.lock();
+        if (queue) {
+            queue->close();
+        }
+    }
+}
+
+SubscriptionId ResultPublisher::addCallback(ResultCallback callback) {
+    std::scoped_lock subscribersLock(this->subscribersMutex);
+
+    SubscriptionId id = this->nextSubscriptionId++;
+    this->callbacks.emplace_back(id, std::move(callback));
+    this->subscriberCount.fetch_add(1, std::memory_order_release);
+
+    return id;
+}
+
+bool ResultPublisher::removeCallback(SubscriptionId id) {
+    std::scoped_lock subscribersLock(this->subscribersMutex);
+
+    auto callbackPosition = std::find_if(this->callbacks.begin(), this->callbacks.end(),
+            [id](const std::pair<SubscriptionId, ResultCallback>& callback) { return callback.first == id; });
+    if (callbackPosition == this->callbacks.end()) {
+        return false;
+    }
+
+    this->callbacks.erase(callbackPosition);
+    this->subscriberCount.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
+
+std::shared_ptr<ResultQueue> ResultPublisher::addQueue(std::size_t capacity) {
+    std::shared_ptr<ResultQueue> queue = std::make_shared<ResultQueue>(capacity);
+
+    std::scoped_lock subscribersLock(this->subscribersMutex);
+    this->queues.push_back(queue);
+    this->subscriberCount.fetch_add(1, std::memory_order_release);
+
+    return queue;
+}
+
+void ResultPublisher::publish(const SerialSample* results, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    std::scoped_lock subscribersLock(this->subscribersMutex);
+
+    for (std::pair<SubscriptionId, ResultCallback>& callback : this->callbacks) {
+        callback.second(results, count);
+    }
+
+    std::size_t releasedCount = 0;
+    for (std::size_t i = 0; i < this->queues.size(); ) {
+        std::shared_ptr<ResultQueue> queue = this->queues[i].lock();
+        if (!queue) {
+            // Consumer released the queue - subscription ends.
+            this->queues[i] = std::move(this->queues.back());
+            this->queues.pop_back();
+            ++releasedCount;
+            continue;
+        }
+
+        queue->push(results, count);
+        ++i;
+    }
+
+    if (releasedCount > 0) {
+        this->subscriberCount.fetch_sub(releasedCount, std::memory_order_release);
+    }
+}
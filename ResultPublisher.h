@@ -0,0 +1,167 @@
+/*
+ * ResultPublisher.h
+ *
+ * Push delivery of analyzer results. Instead of polling getProcessedData(), consumers subscribe
+ * to an analyzer and get every value it computes, right after the block of readings it was
+ * computed from was processed:
+ *   - callbacks are called on the dispatcher worker thread running the analyzer,
+ *   - ResultQueue collects results for a consumer thread, which waits on it (condition variable,
+ *     or eventfd on Linux, so the queue can be watched by poll/epoll with other descriptors).
+ *
+ * Analyzers publish nothing while there are no subscribers, so polling consumers pay nothing.
+ */
+
+#ifndef RESULTPUBLISHER_H_
+#define RESULTPUBLISHER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "SerialSample.h"
+
+// Called with results computed from a single block of readings: VALUE samples with filtered values
+// and status samples passed on when results stopped being legitimate (error, reconnection etc.).
+typedef std::function<void(const SerialSample* results, std::size_t count)> ResultCallback;
+
+// Identifier of callback subscription, 0 is never used.
+typedef std::uint64_t SubscriptionId;
+
+class ResultQueue {
+public:
+    // Default maximal amount of results waiting for consumer.
+    static const std::size_t DEFAULT_CAPACITY = 4096;
+
+    // capacity - maximal amount of waiting results, the oldest ones are dropped above it
+    explicit ResultQueue(std::size_t capacity = DEFAULT_CAPACITY);
+
+    ~ResultQueue();
+
+    ResultQueue(const ResultQueue&) = delete;
+    ResultQueue& operator=(const ResultQueue&) = delete;
+
+    /**
+     * Waits until results are available and takes all of them.
+     *
+     * params:
+     * results - filled with waiting results in order of publishing (cleared when there are none)
+     * timeout - the longest time to wait
+     * returns: true when any results were taken, false on timeout or when queue was closed
+     */
+    bool waitForResults(std::vector<SerialSample>& results, std::chrono::nanoseconds timeout);
+
+    /**
+     * Takes all waiting results without waiting.
+     * returns: amount of results taken
+     */
+    std::size_t takeResults(std::vector<SerialSample>& results);
+
+    /**
+     * Returns descriptor which is readable while results are waiting (Linux eventfd), so consumer can
+     * wait for several queues, sockets etc. with a single poll()/epoll_wait(). Descriptor is reset by
+     * takeResults()/waitForResults(), consumer must not read it. -1 on Windows.
+     */
+    int getWaitDescriptor() const;
+
+    // Checks if analyzer publishing to the queue was destroyed, no results will come anymore.
+    bool isClosed();
+
+    // Returns amount of results dropped because consumer did not keep up.
+    std::uint64_t getDroppedCount() const;
+
+private:
+    friend class ResultPublisher;
+
+    std::deque<SerialSample> pendingResults;
+    std::size_t capacity;
+    bool closed;
+
+    std::atomic<std::uint64_t> droppedCount;
+
+    int waitDescriptor;
+
+    std::mutex queueMutex;
+    std::condition_variable resultsAvailable;
+
+    // Adds results and wakes up consumer.
+    void push(const SerialSample* results, std::size_t count);
+
+    // Marks queue as closed and wakes up consumer.
+    void close();
+
+    // Moves pending results to the vector and resets wait descriptor. Lock queueMutex before calling.
+    std::size_t moveResults(std::vector<SerialSample>& results);
+
+    // Sets wait descriptor readable / not readable.
+    void signalDescriptor();
+    void resetDescriptor();
+};
+
+class ResultPublisher {
+public:
+    ResultPublisher();
+
+    // Closes all subscribed queues.
+    ~ResultPublisher();
+
+    ResultPublisher(const ResultPublisher&) = delete;
+    ResultPublisher& operator=(const ResultPublisher&) = delete;
+
+    /**
+     * Adds callback subscription.
+     * returns: id passed to removeCallback()
+     */
+    SubscriptionId addCallback(ResultCallback callback);
+
+    /**
+     * Removes callback subscription. When method returns callback is not running and will not be
+     * called anymore, so it must not be called from the callback itself.
+     * returns: false when there is no such subscription
+     */
+    bool removeCallback(SubscriptionId id);
+
+    /**
+     * Creates queue getting all results from now on. Subscription ends when the last owner
+     * of returned queue releases it.
+     * param: capacity - maximal amount of results waiting in queue
+     */
+    std::shared_ptr<ResultQueue> addQueue(std::size_t capacity);
+
+    // Checks if anybody is subscribed, cheap enough to be checked for every block of readings.
+    bool hasSubscribers() const {
+        return this->subscriberCount.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * Passes results to all callbacks and queues.
+     *
+     * params:
+     * results - results in order they were computed
+     * count - amount of results, nothing is done for 0
+     */
+    void publish(const SerialSample* results, std::size_t count);
+
+private:
+    std::vector<std::pair<SubscriptionId, ResultCallback>> callbacks;
+
+    // Queues are not owned, released ones are removed during publishing.
+    std::vector<std::weak_ptr<ResultQueue>> queues;
+
+    SubscriptionId nextSubscriptionId;
+
+    // Amount of callbacks and queues (including released ones not removed yet).
+    std::atomic<std::size_t> subscriberCount;
+
+    // Held while results are published, so removeCallback() waits for running callbacks.
+    std::mutex subscribersMutex;
+};
+
+#endif /* RESULTPUBLISHER_H_ */
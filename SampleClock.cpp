@@ -0,0 +1,33 @@
+/*
+ * SampleClock.cpp
+ */
+
+#include "SampleClock.h"
+
+SampleTimestamp SampleClock::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point SampleClock::toWallClock(SampleTimestamp timestamp) {
+    std::chrono::nanoseconds sinceEpoch(toWallClockNanoseconds(timestamp));
+    return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+}
+
+std::time_t SampleClock::toTimeT(SampleTimestamp timestamp) {
+    return std::chrono::system_clock::to_time_t(toWallClock(timestamp));
+}
+
+std::int64_t SampleClock::toWallClockNanoseconds(SampleTimestamp timestamp) {
+    return timestamp + wallClockOffset();
+}
+
+std::int64_t SampleClock::wallClockOffset() {
+    // Both clocks are read close to each other only once, later wall clock adjustments
+    // do not change already captured timestamps.
+    static const std::int64_t offset =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count() - now();
+    return offset;
+}
@@ -0,0 +1,47 @@
+/*
+ * SampleClock.h
+ *
+ * Clock used to timestamp readings. Timestamps are nanoseconds of monotonic clock, so they
+ * never jump back and can be used to measure latency and align samples. They can be mapped
+ * to wall clock time for presentation.
+ */
+
+#ifndef SAMPLECLOCK_H_
+#define SAMPLECLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+// Capture time of a reading in nanoseconds of monotonic clock, INVALID_TIMESTAMP when there is no reading.
+typedef std::int64_t SampleTimestamp;
+
+const SampleTimestamp INVALID_TIMESTAMP = -1;
+
+// Value with its capture time. Plain struct (unlike std::pair), so it can be copied as raw
+// bytes, e.g. by SeqLock. {INVALID_TIMESTAMP, 0} means that there is no value.
+struct TimestampedValue {
+    SampleTimestamp timestamp;
+    double value;
+};
+
+class SampleClock {
+public:
+    // Returns current monotonic time.
+    static SampleTimestamp now();
+
+    // Converts monotonic timestamp to wall clock time.
+    static std::chrono::system_clock::time_point toWallClock(SampleTimestamp timestamp);
+
+    // Converts monotonic timestamp to calendar time (whole seconds).
+    static std::time_t toTimeT(SampleTimestamp timestamp);
+
+    // Converts monotonic timestamp to nanoseconds since Unix epoch.
+    static std::int64_t toWallClockNanoseconds(SampleTimestamp timestamp);
+
+private:
+    // Difference between wall clock and monotonic clock, measured once.
+    static std::int64_t wallClockOffset();
+};
+
+#endif /* SAMPLECLOCK_H_ */
@@ -0,0 +1,68 @@
+/*
+ * SampleRecorder.cpp
+ */
+
+#include <iostream>
+#include "SampleRecorder.h"
+
+SampleRecorder::SampleRecorder(const std::shared_ptr<SampleSource>& serialReader, const std::string& fileName,
+                               std::chrono::milliseconds flushInterval)
+    :SerialPortDataAnalyzer(serialReader)
+    ,writer(fileName, flushInterval)
+    ,lastValue(TimestampedValue{ INVALID_TIMESTAMP, 0 }) {
+    if (!this->writer.isOpen()) {
+        return;
+    }
+    if (this->registerToSerialReader(this) == false) {
+        std::cout << "Error: registering to serial reader failed." << std::endl;
+    }
+}
+
+SampleRecorder::~SampleRecorder() {
+    // Recorder is not run anymore after that, so writer can be closed by this thread.
+    this->deregisterFromSerialReader(this);
+    this->writer.close();
+}
+
+bool SampleRecorder::isRecording() const {
+    return this->writer.isOpen();
+}
+
+std::pair<SampleTimestamp, double> SampleRecorder::getRawData() {
+    TimestampedValue result = this->lastValue.load();
+
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
+}
+
+std::pair<SampleTimestamp, double> SampleRecorder::getProcessedData() {
+    return this->getRawData();
+}
+
+std::uint64_t SampleRecorder::getRecordedCount() const {
+    return this->writer.getSampleCount();
+}
+
+std::uint64_t SampleRecorder::getRecordedBytes() const {
+    return this->writer.getWrittenBytes();
+}
+
+void SampleRecorder::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
+
+void SampleRecorder::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    this->writer.append(samples, count);
+
+    // Value published for getters becomes invalid after status reading, like in filters.
+    const SerialSample& latestSample = samples[count - 1];
+    if (latestSample.status == SampleStatus::VALUE) {
+        this->lastValue.store(TimestampedValue{ latestSample.timestamp, latestSample.value });
+    }
+    else {
+        this->lastValue.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    }
+}
+
+bool SampleRecorder::receivesAllChannels() const {
+    return true;
+}
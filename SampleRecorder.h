@@ -0,0 +1,83 @@
+/*
+ * SampleRecorder.h
+ *
+ * SampleRecorder writes every reading of its source (values and status readings, of all ports
+ * when registered to SerialPortManager) into binary recording file, see RecordingWriter.
+ * Recording can be read later with RecordingReader.
+ */
+
+#ifndef SAMPLERECORDER_H_
+#define SAMPLERECORDER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "RecordingWriter.h"
+#include "SeqLock.h"
+#include "SerialPortDataAnalyzer.h"
+
+class SampleRecorder: public SerialPortDataAnalyzer {
+public:
+
+    /**
+     * Creates recording file and registers recorder to serial reader.
+     *
+     * params:
+     * serialReader - serial reader object or other source of readings (see SampleSource)
+     * fileName - path of recording file, existing file is overwritten
+     * flushInterval - the longest time readings are kept in memory when they arrive slowly
+     */
+    SampleRecorder(const std::shared_ptr<SampleSource>& serialReader, const std::string& fileName,
+                   std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000));
+
+    // Deregisters recorder and closes recording (remaining readings and index are written).
+    virtual ~SampleRecorder();
+
+    // Checks if recording file is opened.
+    bool isRecording() const;
+
+    /**
+     *  Get latest recorded value with timestamp.
+     *  returns: latest value with timestamp or (-1,0) when any data have not been received yet,
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getRawData();
+
+    /**
+     *  Recorder does not process readings - returns the same as getRawData().
+     */
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
+
+    // Returns amount of recorded readings.
+    std::uint64_t getRecordedCount() const;
+
+    // Returns size of recording so far in bytes.
+    std::uint64_t getRecordedBytes() const;
+
+private:
+    // Used only by the thread running recorder.
+    RecordingWriter writer;
+
+    // Latest recorded value, read by getters without locking.
+    SeqLock<TimestampedValue> lastValue;
+
+    /**
+     * Method used by Serial object to send latest data to analyzer.
+     *
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, whole block is appended
+     * to the recording at once.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    // Every channel of multi-channel messages is recorded.
+    virtual bool receivesAllChannels() const;
+};
+
+#endif /* SAMPLERECORDER_H_ */
@@ -0,0 +1,9 @@
+/*
+ * SampleSource.cpp
+ */
+
+#include "SampleSource.h"
+
+SampleSource::~SampleSource() {
+    // Base class does not own any resources.
+}
@@ -0,0 +1,41 @@
+/*
+ * SampleSource.h
+ *
+ * Base class of objects delivering readings to analyzers: a single serial port reader (Serial),
+ * all ports of SerialPortManager or a single port of it. Analyzers register to a source
+ * and get its readings without knowing where they come from.
+ */
+
+#ifndef SAMPLESOURCE_H_
+#define SAMPLESOURCE_H_
+
+#include <cstddef>
+
+#include "AnalyzerDispatcher.h"
+#include "SerialSample.h"
+
+class SerialPortDataAnalyzer;
+
+class SampleSource {
+public:
+    virtual ~SampleSource();
+
+    // Get last read data. Besides values it can be also status reading (see SampleStatus).
+    virtual SerialSample getData() = 0;
+
+    // Check if source delivers readings at the moment.
+    virtual bool IsConnected() = 0;
+
+private:
+    friend class SerialPortDataAnalyzer;
+
+    // Registers data analyzer with given queue policy.
+    // Returns - true on success, false otherwise
+    virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                      std::size_t queueCapacity) = 0;
+
+    // Deregisters data analyzer, after return it is not run anymore.
+    virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) = 0;
+};
+
+#endif /* SAMPLESOURCE_H_ */
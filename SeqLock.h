@@ -0,0 +1,85 @@
+/*
+ * SeqLock.h
+ *
+ * Single value published by one writer and read by any number of threads without locking.
+ *
+ * Writer never waits for readers - it marks value as being changed (odd sequence number),
+ * stores it and marks it as stable again. Reader copies the value and retries only when
+ * sequence number shows that writer was changing it in the meantime, so a read costs
+ * a few loads and never blocks the writer. Value is stored in atomic words, so concurrent
+ * copying is well defined. Writes have to be serialized (single thread or under a mutex).
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value has to be trivially copyable");
+
+public:
+    explicit SeqLock(const T& initialValue)
+        :sequence(0) {
+        this->store(initialValue);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Publishes new value. Writer only.
+    void store(const T& value) {
+        std::uint64_t valueWords[WORD_COUNT] = {};
+        std::memcpy(valueWords, &value, sizeof(T));
+
+        std::uint64_t currentSequence = this->sequence.load(std::memory_order_relaxed);
+        this->sequence.store(currentSequence + 1, std::memory_order_relaxed);
+
+        // Release stores - reader which sees any word of the new value also sees odd sequence number.
+        for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+            this->words[i].store(valueWords[i], std::memory_order_release);
+        }
+
+        this->sequence.store(currentSequence + 2, std::memory_order_release);
+    }
+
+    // Returns latest published value. Can be called from any thread.
+    T load() const {
+        std::uint64_t valueWords[WORD_COUNT];
+
+        while (true) {
+            std::uint64_t sequenceBefore = this->sequence.load(std::memory_order_acquire);
+            if ((sequenceBefore & 1) != 0) {
+                // Writer is in the middle of store().
+                continue;
+            }
+
+            // Acquire loads keep words read before sequence number is checked again.
+            for (std::size_t i = 0; i < WORD_COUNT; ++i) {
+                valueWords[i] = this->words[i].load(std::memory_order_acquire);
+            }
+
+            if (this->sequence.load(std::memory_order_relaxed) == sequenceBefore) {
+                break;
+            }
+        }
+
+        T value;
+        std::memcpy(&value, valueWords, sizeof(T));
+        return value;
+    }
+
+private:
+    static const std::size_t WORD_COUNT = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    // Own cache line, so readers do not slow down writes of neighbouring data.
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    std::atomic<std::uint64_t> words[WORD_COUNT];
+};
+
+#endif /* SEQLOCK_H_ */
@@ -1,80 +1,76 @@
 #include "Serial.h"
 #include "SerialPortDataAnalyzer.h"
 
+#include <chrono>
 #include <iostream>
 
-Serial::Serial(const std::string& portDesc, unsigned int bufferSize) {
-    //We're not yet connected
-    this->connected = false;
+namespace {
+    // Maximal amount of readings passed to analyzerDispatcher at once.
+    const std::size_t DISPATCH_BATCH_SIZE = 256;
 
-    //No errors yet.
-    this->errors = 0;
+    // Default amount of bytes drained from the device at once (on top of one incomplete message).
+    const std::size_t DEFAULT_READ_CHUNK_SIZE = 4096;
 
-    this->nbOfCharsRead = bufferSize;
+    // Delays between reconnection attempts - doubled after every failure up to the maximum.
+    const std::chrono::milliseconds INITIAL_RECONNECT_DELAY(10);
+    const std::chrono::milliseconds MAX_RECONNECT_DELAY(1000);
 
-    this->charBuffer = new char[bufferSize];
+    // Time between checks for free space in readings queue when status reading has to be queued.
+    const std::chrono::microseconds STATUS_RETRY_INTERVAL(100);
+}
 
-    this->lastReading = std::pair<std::time_t, std::string>{ -1, "INITIALIZING" };
+Serial::Serial(const std::string& portDesc, unsigned int bufferSize)
+    :Serial(portDesc, FrameFormat::fixedWidth(bufferSize)) {
+}
 
-    //Try to connect to the given port through CreateFile
-    this->hSerial = CreateFile(portDesc.c_str(),
-            GENERIC_READ,
-            0,
-            NULL,
-            OPEN_EXISTING,
-            FILE_ATTRIBUTE_NORMAL,
-            NULL);
+Serial::Serial(const std::string& portDesc, const FrameFormat& frameFormat, const SerialPortSettings& portSettings,
+               std::unique_ptr<SerialTransport> serialTransport, std::size_t queueCapacity, std::size_t dispatchThreads)
+    :portName(portDesc)
+    ,portSettings(portSettings)
+    ,framer(frameFormat)
+    ,analyzerDispatcher(dispatchThreads)
+    ,lastReading(SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, 0 })
+    ,readingsQueue(queueCapacity) {
+    //We're not yet connected
+    this->connected = false;
+    this->reconnectCount = 0;
+    this->reconnectDelay = INITIAL_RECONNECT_DELAY;
+    this->readerActive = false;
+    this->dispatcherActive = false;
+
+    this->transport = std::move(serialTransport);
+
+    // Buffer always has space for a big chunk of data on top of incomplete message.
+    std::size_t readChunkSize = (portSettings.receiveBufferSize > 0) ? portSettings.receiveBufferSize : DEFAULT_READ_CHUNK_SIZE;
+    this->readBuffer.resize(readChunkSize + this->framer.getMaxMessageSize());
+    this->pendingBytes = 0;
+    this->parsedSamples.resize(this->framer.getMaxSampleCount(this->readBuffer.size()));
+    this->parseErrorCount = 0;
+    this->frameCount = 0;
+    this->byteCount = 0;
+
+    if (!this->transport) {
+        std::cout << "ERROR: no transport for serial port " << portDesc << "." << std::endl;
+        return;
+    }
 
-    //Check if the connection was successfull
-    if(this->hSerial==INVALID_HANDLE_VALUE) {
-        //If not success full display an Error
-        if(GetLastError()==ERROR_FILE_NOT_FOUND) {
+    //Try to connect to the given port, transport reports reason of failure by itself
+    this->connected = this->transport->open(portDesc, this->portSettings);
 
-            //Print Error if neccessary
-            std::cout << "ERROR: Handle was not attached. Reason: "<< portDesc.c_str() << " not available." << std::endl;
+    // Reader is active even when port is not available yet - analyzers can register
+    // and reader keeps trying to open the port the same way as after device failure.
+    this->readerActive = true;
+    this->dispatcherActive = true;
 
-        }
-        else {
-            std::cout << "ERROR!!!" << std::endl;
-        }
+    if (this->connected) {
+        std::cout << "Serial reader created succesfully" << std::endl;
     }
     else {
-        //If connected we try to set the comm parameters
-        DCB dcbSerialParams = {0};
-
-        //Try to get the current
-        if (!GetCommState(this->hSerial, &dcbSerialParams)) {
-            //If impossible, show an error
-            std::cout <<  "failed to get current serial parameters!" << std::endl;
-        }
-        else {
-            //Define serial connection parameters for the arduino board
-            dcbSerialParams.BaudRate=CBR_9600;
-            dcbSerialParams.ByteSize=8;
-            dcbSerialParams.StopBits=ONESTOPBIT;
-            dcbSerialParams.Parity=NOPARITY;
-            //Setting the DTR to Control_Enable ensures that the Arduino is properly
-            //reset upon establishing a connection
-            dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
-
-             //Set the parameters and check for their proper application
-             if(!SetCommState(hSerial, &dcbSerialParams)) {
-                 std::cout << "ALERT: Could not set Serial Port parameters" << std::endl;
-             }
-             else {
-                 //If everything went fine we're connected and active
-                 this->connected = true;
-                 this->readerActive = true;
-                 //Flush any remaining characters in the buffers
-                 PurgeComm(this->hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
-
-                 this->sendThreadPtr = std::make_unique<std::thread>([this] {this->doReading(); });
-                 this->readingThreadPtr = std::make_unique<std::thread>([this] {this->sendDataToAnalyzers(); }); 
-                 std::cout << "Serial reader created succesfully" << std::endl;
-             }
-        }
+        std::cout << "Serial port " << portDesc << " not opened yet, reader keeps trying." << std::endl;
     }
 
+    this->readingThreadPtr = std::make_unique<std::thread>([this] {this->doReading(); });
+    this->sendThreadPtr = std::make_unique<std::thread>([this] {this->sendDataToAnalyzers(); });
 }
 
 Serial::~Serial() {
@@ -82,149 +78,324 @@ Serial::~Serial() {
     // Destructor called - reader is not active anymore.
     this->readerActive = false;
 
+    if (this->transport) {
+        // Wake up reader blocked on waiting for data.
+        this->transport->interrupt();
+    }
+
     {
-        std::scoped_lock analyzerLock(this->registeredAnalyzersMutex);      
+        // Wake up reader waiting before next reconnection attempt. Empty critical section
+        // guarantees that reader either sees readerActive == false or is already waiting.
+        std::scoped_lock reconnectLock(this->reconnectMutex);
+    }
+    this->reconnectNotifier.notify_all();
 
-        // In theory that vector should be empty already (registered analyzers also keep
-        // shared_ptr to serial object so they will keep them alive as long as they want).
-        if (this->registeredAnalyzers.empty() == false) {
-            for (SerialPortDataAnalyzer* analyzerPointer : this->registeredAnalyzers) {
-                analyzerPointer->fetchNewData(std::pair<std::time_t, std::string>{ -1, "CLOSED" });
-            }
-        }
+    if (this->readingThreadPtr) {
+        this->readingThreadPtr->join();
     }
 
-    readerNotifier.notify_all();
+    // Reader is stopped, so this thread can act as the producer now. In theory there should be
+    // no registered analyzers already (registered analyzers also keep shared_ptr to serial object
+    // so they will keep them alive as long as they want), but if there are any they get everything
+    // that was read followed by CLOSED reading.
+    this->queueStatus(SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::CLOSED, 0 });
 
-    readingThreadPtr->join();
-    sendThreadPtr->join();
-    
-    //Check if we are connected before trying to disconnect
-    if(this->connected) {
-        //We're no longer connected
-        this->connected = false;
-        //Close the serial handler
-        CloseHandle(this->hSerial);
+    this->dispatcherActive = false;
+    this->notifyDispatcher();
+
+    if (this->sendThreadPtr) {
+        this->sendThreadPtr->join();
     }
 
-    delete[] this->charBuffer;
+    // Analyzers get everything that was dispatched before workers stop.
+    this->analyzerDispatcher.shutdown();
+    
+    //Check if port is opened before trying to disconnect (reader could have been reconnecting)
+    if(this->transport && this->transport->isOpen()) {
+        this->transport->close();
+    }
+    //We're no longer connected
+    this->connected = false;
 
     std::cout << "Serial reader deleted" << std::endl;
 }
 
-std::pair<std::time_t, std::string> Serial::getData() {
-
-    std::scoped_lock dataLock(this->dataMutex);
+SerialSample Serial::getData() {
 
-    return this->lastReading;
+    return this->lastReading.load();
  }
 
-bool Serial::registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister) {
+bool Serial::registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                  std::size_t queueCapacity) {
 
     if ((analyzerToRegister != nullptr) && (this->readerActive == true)) {
-        bool analyzerAlreadyRegistered = false;
+        // Dispatcher rejects analyzers that are already registered.
+        return this->analyzerDispatcher.addAnalyzer(analyzerToRegister, policy, queueCapacity);
+    }
+    else
+        return false;
+}
 
-        std::scoped_lock analyzerLock(this->registeredAnalyzersMutex);
+void Serial::deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
+    this->analyzerDispatcher.removeAnalyzer(analyzerToDeregister);
+}
 
-        for (SerialPortDataAnalyzer* analyzerPtr : this->registeredAnalyzers) {
-            if (analyzerPtr == analyzerToRegister) {
-                analyzerAlreadyRegistered = true;
+void Serial::sendDataToAnalyzers() {
+    std::vector<SerialSample> readings;
+    readings.reserve(DISPATCH_BATCH_SIZE);
+    SerialSample reading;
+
+    while (true) {
+        // Pass queued readings to analyzer queues in batches. Dispatching does not wait for
+        // analyzers (unless one of them uses BLOCK policy and its queue is full).
+        while (this->readingsQueue.tryPop(reading)) {
+            readings.push_back(reading);
+            if (readings.size() == DISPATCH_BATCH_SIZE) {
+                this->dispatchLatency.recordSince(readings.front().timestamp);
+                this->analyzerDispatcher.dispatch(readings.data(), readings.size());
+                readings.clear();
             }
         }
+        if (!readings.empty()) {
+            this->dispatchLatency.recordSince(readings.front().timestamp);
+            this->analyzerDispatcher.dispatch(readings.data(), readings.size());
+            readings.clear();
+        }
+
+        std::unique_lock<std::mutex> notifierLock(this->notifierMutex);
+        // Predicate protects against spurious wake ups, and since it is checked under notifierMutex
+        // notification sent after pushing new reading cannot be missed.
+        this->readerNotifier.wait(notifierLock, [this] {
+            return !this->readingsQueue.empty() || !this->dispatcherActive;
+        });
+
+        if (!this->dispatcherActive && this->readingsQueue.empty()) {
+            break;
+        }
+    }
+}
+
+void Serial::doReading() {
 
-        if (analyzerAlreadyRegistered) {
-            return false;
+    // Port which was not available at start is opened here. Analyzers have not got any values yet,
+    // so nothing is reported to them - values simply start coming.
+    if (!this->connected) {
+        if (!this->openPort()) {
+            return;
+        }
+        std::cout << "Serial port " << this->portName << " opened" << std::endl;
+    }
+
+    while (this->readerActive) {
+        // Block until device has something for us (or destructor interrupts the wait).
+        SerialTransport::WaitResult waitResult = this->transport->waitForData(-1);
+
+        if (waitResult == SerialTransport::WaitResult::INTERRUPTED || waitResult == SerialTransport::WaitResult::TIMEOUT) {
+            continue;
+        }
+
+        long bytesRead = -1;
+        if (waitResult == SerialTransport::WaitResult::DATA_AVAILABLE) {
+            // Drain everything driver has buffered, not only a single message.
+            bytesRead = this->transport->readAvailable(this->readBuffer.data() + this->pendingBytes,
+                                                       this->readBuffer.size() - this->pendingBytes);
+        }
+
+        if (bytesRead >= 0) {
+            // Timestamp is taken right after read returns, before any processing.
+            SampleTimestamp readTime = SampleClock::now();
+            this->pendingBytes += static_cast<std::size_t>(bytesRead);
+            this->byteCount.fetch_add(static_cast<std::uint64_t>(bytesRead), std::memory_order_relaxed);
+            this->publishCompleteFrames(readTime);
+
+            if (bytesRead > 0) {
+                // Port works again, next failure is retried quickly.
+                this->reconnectDelay = INITIAL_RECONNECT_DELAY;
+            }
         }
         else {
-            this->registeredAnalyzers.push_back(analyzerToRegister);
-            return true;
+            // Device failed or was unplugged - analyzers are told to drop collected data,
+            // then port is reopened. Registered analyzers stay registered the whole time.
+            this->connected = false;
+            this->publishStatus(SampleStatus::READ_ERROR);
+
+            if (this->reconnect()) {
+                this->publishStatus(SampleStatus::RECONNECTED);
+            }
         }
     }
-    else
-        return false;
+
 }
 
-void Serial::deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
-    std::scoped_lock analyzerLock(this->registeredAnalyzersMutex);
+bool Serial::reconnect() {
+    this->transport->close();
 
-    this->registeredAnalyzers.erase(std::remove(this->registeredAnalyzers.begin(), this->registeredAnalyzers.end(),
-                                                analyzerToDeregister),
-                                    this->registeredAnalyzers.end());
-}
+    // Bytes received before failure cannot be completed anymore.
+    this->pendingBytes = 0;
+    this->framer.reset();
 
-void Serial::sendDataToAnalyzers() {
-    std::unique_lock<std::mutex> dataLock(this->dataMutex, std::defer_lock);
-    std::unique_lock<std::mutex> analyzerLock(this->registeredAnalyzersMutex);
+    if (this->openPort()) {
+        ++this->reconnectCount;
+        std::cout << "Serial port " << this->portName << " reconnected" << std::endl;
+        return true;
+    }
+
+    return false;
+}
 
+bool Serial::openPort() {
     while (this->readerActive) {
-        // Wait for new data, if reader is active and there is no registered analyzers wait again.
-        this->readerNotifier.wait(analyzerLock);
-
-        if (!this->registeredAnalyzers.empty()) {
-            // If there are analyzers registered send them new data.
-            dataLock.lock();
-            for (SerialPortDataAnalyzer* analyzerPtr : this->registeredAnalyzers) {
-                analyzerPtr->fetchNewData(this->lastReading);
+        // Every attempt is preceded by delay which keeps growing until port delivers data again,
+        // so device failing right after reopening is not reopened in a busy loop.
+        {
+            std::unique_lock<std::mutex> reconnectLock(this->reconnectMutex);
+            if (this->reconnectNotifier.wait_for(reconnectLock, this->reconnectDelay, [this] {
+                    return !this->readerActive;
+                })) {
+                break;
             }
-            dataLock.unlock();
+        }
+        this->reconnectDelay = std::min(this->reconnectDelay * 2, MAX_RECONNECT_DELAY);
+
+        // Opening applies line settings again.
+        if (this->transport->open(this->portName, this->portSettings)) {
+            this->connected = true;
+            return true;
         }
     }
+
+    return false;
 }
 
-void Serial::doReading() {
-    //Number of bytes we'll have read
-    DWORD bytesRead;
+void Serial::publishCompleteFrames(SampleTimestamp readTime) {
+    // Every message is parsed only here (whole block at once), analyzers get ready numbers.
+    FrameParser::BatchResult batchResult = this->framer.extractSamples(this->readBuffer.data(), this->pendingBytes,
+            readTime, this->parsedSamples.data(), this->parsedSamples.size());
+    std::size_t frameStart = batchResult.consumedBytes;
 
-    std::unique_lock<std::mutex> dataLock(this->dataMutex, std::defer_lock);
+    if (batchResult.parseErrors > 0) {
+        if (this->parseErrorCount.fetch_add(batchResult.parseErrors) == 0) {
+            std::cout << "Error during processing data from serial port - wrong value format or value out of range" << std::endl;
+        }
+    }
 
-    while (this->readerActive) {
-        //Use the ClearCommError function to get status info on the Serial port
-        ClearCommError(this->hSerial, &this->errors, &this->status);
+    if (batchResult.parsedSamples > 0) {
+        // Every message gives one reading per channel.
+        this->frameCount.fetch_add(batchResult.parsedSamples / this->framer.getFormat().channelCount,
+                                   std::memory_order_relaxed);
+        for (std::size_t i = 0; i < batchResult.parsedSamples; ++i) {
+            this->queueReading(this->parsedSamples[i]);
+        }
+        // getData() gets only the newest reading from the batch.
+        this->lastReading.store(this->parsedSamples[batchResult.parsedSamples - 1]);
+        // Whole batch is announced at once.
+        this->notifyDispatcher();
+    }
 
+    if (frameStart > 0) {
+        // Move incomplete message to the beginning of the buffer, rest of it will come with next read.
+        std::copy(this->readBuffer.begin() + frameStart, this->readBuffer.begin() + this->pendingBytes,
+                  this->readBuffer.begin());
+        this->pendingBytes -= frameStart;
+    }
+}
 
-        //Try to read the required number of chars, and return effect
-        if (ReadFile(this->hSerial, this->charBuffer, this->nbOfCharsRead, &bytesRead, NULL))
-        {
-            
+void Serial::publishStatus(SampleStatus status) {
+    SerialSample statusSample{ INVALID_TIMESTAMP, 0, status, 0 };
+    this->lastReading.store(statusSample);
+    this->queueStatus(statusSample);
+    this->notifyDispatcher();
+}
 
-            if (bytesRead == this->nbOfCharsRead) {
-                dataLock.lock();
-                this->lastReading = std::pair<std::time_t, std::string>(std::time(nullptr), std::string(this->charBuffer));
-                dataLock.unlock();
-            }
-            else {
-                // Error during read will result in reader becoming inactive, otherwise thread would most likely
-                // loop without any block flooding everything with error results.
-                this->readerActive = false;
-
-                dataLock.lock();
-                this->lastReading = std::pair<std::time_t, std::string>{ -1, "ERROR" };
-                dataLock.unlock();
-            }
-                
-            
+void Serial::queueReading(const SerialSample& sample) {
+    if (!this->readingsQueue.tryPush(SerialSample(sample))) {
+        // Reading is counted as dropped by the queue. Message is printed only for the first
+        // lost reading, so slow analyzers do not get even slower because of console output.
+        if (this->readingsQueue.getDroppedCount() == 1) {
+            std::cout << "ALERT: analyzers do not keep up with serial port, readings are dropped." << std::endl;
         }
-        else {
-            // Error during read will result in reader becoming inactive, otherwise thread would most likely
-            // loop without any block flooding everything with error results.
-            this->readerActive = false;
-
-            dataLock.lock();            
-            // If nothing has been read, or that an error was detected return error pair
-            this->lastReading = std::pair<std::time_t, std::string>{ -1, "ERROR" };
-            dataLock.unlock();
-        }
-        readerNotifier.notify_all();
     }
+}
 
+void Serial::queueStatus(const SerialSample& statusSample) {
+    // Status readings are never dropped - analyzers which missed them would keep mixing data from
+    // before and after the failure. Dispatcher keeps draining the queue, so space comes soon.
+    while (this->readingsQueue.full()) {
+        this->notifyDispatcher();
+        std::this_thread::sleep_for(STATUS_RETRY_INTERVAL);
+    }
+    this->queueReading(statusSample);
+}
+
+void Serial::notifyDispatcher() {
+    {
+        // Empty critical section - guarantees that dispatcher is either before checking its
+        // wait predicate or already waiting, so notification is never lost.
+        std::scoped_lock notifierLock(this->notifierMutex);
+    }
+    this->readerNotifier.notify_one();
 }
 
 bool Serial::IsConnected()
 {
-    // Simply return whether reader is active (there is no way
-    // to recover from inactivity right now, so from the outside
-    // being active and being connected means the same).
-    return this->readerActive;
+    // Reader stays active while reconnecting, so connection state is tracked separately.
+    return this->readerActive && this->connected;
+}
+
+std::uint64_t Serial::getReconnectCount() const {
+    return this->reconnectCount;
+}
+
+std::uint64_t Serial::getParseErrorCount() const {
+    return this->parseErrorCount;
+}
+
+std::uint64_t Serial::getDroppedReadingCount() const {
+    return this->readingsQueue.getDroppedCount();
+}
+
+std::size_t Serial::getQueueHighWaterMark() const {
+    return this->readingsQueue.getHighWaterMark();
+}
+
+std::uint64_t Serial::getAnalyzerDroppedCount() const {
+    return this->analyzerDispatcher.getDroppedCount();
+}
+
+std::uint64_t Serial::getFrameCount() const {
+    return this->frameCount.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram& Serial::getDispatchLatency() const {
+    return this->dispatchLatency;
+}
+
+const LatencyHistogram& Serial::getAnalyzerLatency() const {
+    return this->analyzerDispatcher.getAnalyzerLatency();
+}
+
+void Serial::collectMetrics(MetricsWriter& writer) {
+    std::string labels = MetricsWriter::label("port", this->portName);
+
+    writer.addCounter("serial_frames_total", "Messages parsed from serial port.", labels, this->getFrameCount());
+    writer.addCounter("serial_bytes_total", "Bytes read from serial port.", labels,
+                      this->byteCount.load(std::memory_order_relaxed));
+    writer.addCounter("serial_parse_errors_total", "Messages which did not contain valid number.", labels,
+                      this->getParseErrorCount());
+    writer.addCounter("serial_dropped_readings_total", "Readings lost because analyzers did not keep up.", labels,
+                      this->getDroppedReadingCount());
+    writer.addCounter("serial_reconnects_total", "Times port was reopened after device failure.", labels,
+                      this->getReconnectCount());
+    writer.addGauge("serial_connected", "1 when port is connected, 0 otherwise.", labels, this->IsConnected() ? 1 : 0);
+    writer.addGauge("serial_queue_depth", "Readings waiting to be dispatched to analyzers.", labels,
+                    static_cast<double>(this->readingsQueue.size()));
+    writer.addGauge("serial_queue_high_water_mark", "The highest amount of readings waiting to be dispatched.", labels,
+                    static_cast<double>(this->getQueueHighWaterMark()));
+    writer.addHistogram("serial_read_to_dispatch_seconds",
+                        "Time from reading the oldest message of a block until the block is dispatched.", labels,
+                        this->dispatchLatency);
+
+    this->analyzerDispatcher.collectMetrics(writer, labels);
 }
 
 
@@ -11,97 +11,216 @@
 #define SERIAL_H_
 
 #include <string>
-#include <windows.h>
 #include <stdlib.h>
 #include <mutex>
 #include <thread>
 #include <vector>
-#include <ctime>
 #include <memory>
 #include <atomic>
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 
+#include "AnalyzerDispatcher.h"
+#include "LatencyHistogram.h"
+#include "MetricsWriter.h"
+#include "SampleClock.h"
+#include "SampleSource.h"
+#include "SeqLock.h"
+#include "SerialFramer.h"
+#include "SerialPortSettings.h"
+#include "SerialSample.h"
+#include "SerialTransport.h"
+#include "SpscRingBuffer.h"
+
 class SerialPortDataAnalyzer;
 
-class Serial
+class Serial: public SampleSource, public MetricsProvider
 {
 private:
-    // Serial comm handler
-    HANDLE hSerial;
+    // Platform specific serial port device
+    std::unique_ptr<SerialTransport> transport;
+
+    // Name of the port, kept for reconnecting
+    std::string portName;
+
+    // Line settings, applied again after reconnecting
+    SerialPortSettings portSettings;
+
+    // Connection status - false while reader waits for device to come back
+    std::atomic<bool> connected;
 
-    // Connection status
-    bool connected;
+    // Amount of successful reconnections
+    std::atomic<std::uint64_t> reconnectCount;
 
     // Information about whether reader is active or not.
     std::atomic<bool> readerActive;
 
-    // Get various information about the connection
-    COMSTAT status;
+    // Information about whether thread sending data to analyzers should keep running.
+    std::atomic<bool> dispatcherActive;
+
+    // Splits received bytes into messages and parses them
+    SerialFramer framer;
+
+    // Buffer for reading, every wake up of the reader drains all available bytes into it.
+    // Incomplete message is kept at the beginning of the buffer until the rest arrives.
+    std::vector<char> readBuffer;
+
+    // Amount of bytes from incomplete message stored in readBuffer
+    std::size_t pendingBytes;
+
+    // Samples parsed from the latest read
+    std::vector<SerialSample> parsedSamples;
 
-    // Keep track of last error
-    DWORD errors;
+    // Amount of messages which did not contain valid number
+    std::atomic<std::uint64_t> parseErrorCount;
 
-    // Hold information about size of the buffer
-    unsigned int nbOfCharsRead;
+    // Amount of parsed messages and amount of bytes read from the port
+    std::atomic<std::uint64_t> frameCount;
+    std::atomic<std::uint64_t> byteCount;
 
-    // Buffer for reading
-    char* charBuffer;
+    // Time from reading a message until it is passed to analyzerDispatcher (once per dispatched block)
+    LatencyHistogram dispatchLatency;
 
-    // Vector for storing pointers to registered analyzers
-    std::vector<SerialPortDataAnalyzer*> registeredAnalyzers;
+    // Runs registered analyzers on worker threads, each one with its own queue
+    AnalyzerDispatcher analyzerDispatcher;
 
-    // Last read value with timestamp, value updated only through Serial::doReading().
-    // Second parameter besides raw values can be also "ERROR", "CLOSED", or "INITIALIZING",
+    // Last read sample, value updated only through Serial::doReading() and read by getData() without locking.
+    // Besides values its status can be also READ_ERROR, RECONNECTED, CLOSED, or INITIALIZING,
     // analyzers should handle that properly.
-    std::pair<std::time_t, std::string> lastReading;
+    SeqLock<SerialSample> lastReading;
 
-    // Mutex for data receiving and reading data from serial port.
-    std::mutex dataMutex;
+    // Every reading (including status ones) goes through that queue from reader thread to the thread
+    // sending data to analyzers, so each of them is delivered exactly once. When analyzers do not keep up
+    // and queue gets full, readings are dropped and counted.
+    SpscRingBuffer<SerialSample> readingsQueue;
 
-    // Mutex for sending new data to analyzers
-    std::mutex registeredAnalyzersMutex;
+    // Mutex used together with readerNotifier
+    std::mutex notifierMutex;
 
     // Variable used to notify about some events
     std::condition_variable readerNotifier;
 
+    // Mutex used together with reconnectNotifier
+    std::mutex reconnectMutex;
+
+    // Variable used to interrupt waiting between reconnection attempts
+    std::condition_variable reconnectNotifier;
+
+    // Delay before next reopen attempt, used only by reader thread. Reset when port delivers data,
+    // so device failing right after reopening is retried less and less often.
+    std::chrono::milliseconds reconnectDelay;
+
     // Ptr to thread that is reading values from serial port
     std::unique_ptr<std::thread> readingThreadPtr;
 
-    // Ptr to thread that is sending new reading to analyzers
+    // Ptr to thread that is passing new readings to analyzerDispatcher
     std::unique_ptr<std::thread> sendThreadPtr;
 
-    friend class SerialPortDataAnalyzer;
- 
 public:
+    // Default amount of readings that can wait for analyzers.
+    static const std::size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
     // Initialize Serial communication with the given COM port using set buffer size.
-    // Note that buffer size MUST be identical to size of messages that are sent through
-    // serial port. Otherwise values will be desynced.
+    // Buffer size is the size of fixed width messages that are sent through serial port,
+    // after corrupted data reader moves byte by byte until messages are aligned again.
     Serial(const std::string& portDesc, unsigned int bufferSize);
 
+    /**
+     * Initialize Serial communication with the given COM port.
+     *
+     * params:
+     * portDesc - name of serial port
+     * frameFormat - format of messages (fixed width, delimited or length prefixed)
+     * portSettings - baud rate, character format, flow control etc.
+     * serialTransport - device to read from (e.g. for testing or custom devices)
+     * queueCapacity - maximal amount of readings waiting to be sent to analyzers
+     * dispatchThreads - amount of threads running analyzers, 0 means one per processor core
+     */
+    Serial(const std::string& portDesc, const FrameFormat& frameFormat,
+           const SerialPortSettings& portSettings = SerialPortSettings(),
+           std::unique_ptr<SerialTransport> serialTransport = SerialTransport::createDefault(),
+           std::size_t queueCapacity = DEFAULT_QUEUE_CAPACITY,
+           std::size_t dispatchThreads = AnalyzerDispatcher::SINGLE_SOURCE_WORKER_COUNT);
+
     // Close the connection
     ~Serial();
 
     // Get last read data. Check lastReading description to know possible data values.
-    std::pair<std::time_t, std::string> getData();
+    virtual SerialSample getData();
+
+    // Check if we are actually connected. It is false until port is opened - after device failure
+    // or when port was not available at start reader keeps trying to open it in the background.
+    virtual bool IsConnected();
+
+    // Returns amount of times port was reopened after device failure.
+    std::uint64_t getReconnectCount() const;
 
-    // Check if we are actually connected
-    bool IsConnected();
+    // Returns amount of messages that were dropped because they did not contain valid number.
+    std::uint64_t getParseErrorCount() const;
+
+    // Returns amount of readings lost because analyzers did not keep up with serial port.
+    std::uint64_t getDroppedReadingCount() const;
+
+    // Returns the highest amount of readings that were waiting for analyzers at once.
+    std::size_t getQueueHighWaterMark() const;
+
+    // Returns amount of readings dropped or coalesced by analyzer queues (DROP_OLDEST and COALESCE policies).
+    std::uint64_t getAnalyzerDroppedCount() const;
+
+    // Returns amount of parsed messages.
+    std::uint64_t getFrameCount() const;
+
+    // Returns histogram of time from reading a message until it is dispatched to analyzers.
+    const LatencyHistogram& getDispatchLatency() const;
+
+    // Returns histogram of time from dispatching readings until analyzer processed them.
+    const LatencyHistogram& getAnalyzerLatency() const;
+
+    // Adds counters, queue gauges and latency histograms of the reader, labelled with port name.
+    virtual void collectMetrics(MetricsWriter& writer);
 private:
-    // Registers data analyzer.
+    // Registers data analyzer with given queue policy.
     // Returns - true on success, false otherwise
-    bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister);
+    virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                      std::size_t queueCapacity);
 
-    // Deregisters data analyzer.
-    void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister);
+    // Deregisters data analyzer, after return it is not run anymore.
+    virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister);
 
-    // Constantly sends new data to registered analyzers.
+    // Constantly passes new readings to analyzerDispatcher.
     // Check lastReading description to know possible data values.
     void sendDataToAnalyzers();
 
     // Does constant reading of values sent through serial port.
     void doReading();
 
+    // Closes failed port and reopens it, waiting longer after every unsuccessful attempt.
+    // Returns - true when port is opened again, false when reader was stopped in the meantime
+    bool reconnect();
+
+    // Tries to open port until it succeeds, waiting longer after every unsuccessful attempt.
+    // Returns - true when port is opened, false when reader was stopped in the meantime
+    bool openPort();
+
+    // Splits bytes gathered in readBuffer into messages and publishes each one of them.
+    // readTime - capture timestamp of the latest read, given to all messages completed by it
+    void publishCompleteFrames(SampleTimestamp readTime);
+
+    // Publishes status sample (READ_ERROR etc.) with invalid timestamp.
+    void publishStatus(SampleStatus status);
+
+    // Puts sample into readingsQueue, it is dropped when queue is full.
+    // Reader thread only (or any thread once reader is stopped).
+    void queueReading(const SerialSample& sample);
+
+    // Puts status sample into readingsQueue, waits for free space when queue is full.
+    // Reader thread only (or any thread once reader is stopped), dispatcher thread has to be running.
+    void queueStatus(const SerialSample& statusSample);
+
+    // Wakes up thread sending data to analyzers.
+    void notifyDispatcher();
+
 };
 
 #endif /* SERIAL_H_ */
@@ -0,0 +1,218 @@
+/*
+ * SerialFramer.cpp
+ */
+
+#include "SerialFramer.h"
+
+#include <cstring>
+
+FrameFormat FrameFormat::fixedWidth(std::size_t frameWidth) {
+    return FrameFormat{ Type::FIXED_WIDTH, (frameWidth > 0) ? frameWidth : 1, '\0', 1, ',' };
+}
+
+FrameFormat FrameFormat::delimited(char delimiter, std::size_t maxFrameSize) {
+    return FrameFormat{ Type::DELIMITED, (maxFrameSize > 0) ? maxFrameSize : 1, delimiter, 1, ',' };
+}
+
+FrameFormat FrameFormat::lengthPrefixed(std::size_t maxFrameSize) {
+    // Length is stored in a single byte.
+    std::size_t limitedSize = (maxFrameSize > 255) ? 255 : maxFrameSize;
+    return FrameFormat{ Type::LENGTH_PREFIXED, (limitedSize > 0) ? limitedSize : 1, '\0', 1, ',' };
+}
+
+FrameFormat FrameFormat::multiChannel(std::size_t channelCount, char separator, char delimiter, std::size_t maxFrameSize) {
+    FrameFormat format = FrameFormat::delimited(delimiter, maxFrameSize);
+    format.channelCount = (channelCount > 0) ? channelCount : 1;
+    format.channelSeparator = separator;
+    return format;
+}
+
+SerialFramer::SerialFramer(const FrameFormat& format, PortId portId)
+    :format(format)
+    ,portId(portId)
+    ,skippingToDelimiter(false) {
+    if (this->format.channelCount == 0) {
+        this->format.channelCount = 1;
+    }
+}
+
+FrameParser::BatchResult SerialFramer::extractSamples(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                      SerialSample* samples, std::size_t maxSamples) {
+    FrameParser::BatchResult batchResult;
+
+    switch (this->format.type) {
+    case FrameFormat::Type::DELIMITED:
+        batchResult = this->extractDelimited(data, length, timestamp, samples, maxSamples);
+        break;
+    case FrameFormat::Type::LENGTH_PREFIXED:
+        batchResult = this->extractLengthPrefixed(data, length, timestamp, samples, maxSamples);
+        break;
+    case FrameFormat::Type::FIXED_WIDTH:
+    default:
+        if (this->format.channelCount > 1) {
+            batchResult = this->extractFixedWidthChannels(data, length, timestamp, samples, maxSamples);
+        }
+        else {
+            batchResult = FrameParser::parseFixedWidthBatch(data, length, this->format.frameSize, timestamp, samples, maxSamples);
+        }
+        break;
+    }
+
+    // Parsers fill only measurement fields.
+    for (std::size_t i = 0; i < batchResult.parsedSamples; ++i) {
+        samples[i].portId = this->portId;
+    }
+
+    return batchResult;
+}
+
+void SerialFramer::reset() {
+    this->skippingToDelimiter = false;
+}
+
+const FrameFormat& SerialFramer::getFormat() const {
+    return this->format;
+}
+
+std::size_t SerialFramer::getMaxMessageSize() const {
+    return (this->format.type == FrameFormat::Type::FIXED_WIDTH) ? this->format.frameSize : this->format.frameSize + 1;
+}
+
+std::size_t SerialFramer::getMinMessageSize() const {
+    return (this->format.type == FrameFormat::Type::FIXED_WIDTH) ? this->format.frameSize : 1;
+}
+
+std::size_t SerialFramer::getMaxSampleCount(std::size_t byteCount) const {
+    // Message producing samples takes at least a character per number, separators between them
+    // and delimiter or length byte (empty lines produce nothing).
+    std::size_t minValueMessageSize = (this->format.type == FrameFormat::Type::FIXED_WIDTH) ?
+            this->format.frameSize : 2 * this->format.channelCount;
+    return (byteCount / minValueMessageSize + 1) * this->format.channelCount;
+}
+
+FrameParser::BatchResult SerialFramer::extractDelimited(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                        SerialSample* samples, std::size_t maxSamples) {
+    FrameParser::BatchResult batchResult{ 0, 0, 0 };
+
+    while (batchResult.consumedBytes < length && batchResult.parsedSamples + this->format.channelCount <= maxSamples) {
+        const char* frameBegin = data + batchResult.consumedBytes;
+        std::size_t remainingBytes = length - batchResult.consumedBytes;
+        const char* delimiterPosition = static_cast<const char*>(std::memchr(frameBegin, this->format.delimiter, remainingBytes));
+
+        if (delimiterPosition == nullptr) {
+            if (remainingBytes > this->format.frameSize) {
+                // No delimiter in more bytes than any message can take - data is corrupted,
+                // drop it and skip everything up to the next delimiter.
+                if (!this->skippingToDelimiter) {
+                    ++batchResult.parseErrors;
+                    this->skippingToDelimiter = true;
+                }
+                batchResult.consumedBytes = length;
+            }
+            else if (this->skippingToDelimiter) {
+                batchResult.consumedBytes = length;
+            }
+            // Otherwise it is beginning of a message, the rest of it comes later.
+            break;
+        }
+
+        std::size_t frameLength = static_cast<std::size_t>(delimiterPosition - frameBegin);
+        batchResult.consumedBytes += frameLength + 1;
+
+        if (this->skippingToDelimiter) {
+            // Tail of corrupted message - next message starts after this delimiter.
+            this->skippingToDelimiter = false;
+            continue;
+        }
+
+        if (frameLength > this->format.frameSize) {
+            ++batchResult.parseErrors;
+            continue;
+        }
+
+        FrameParser::Result parseResult = this->parseMessage(frameBegin, delimiterPosition, timestamp,
+                                                             samples + batchResult.parsedSamples);
+        if (parseResult == FrameParser::Result::OK) {
+            batchResult.parsedSamples += this->format.channelCount;
+        }
+        else if (parseResult != FrameParser::Result::EMPTY) {
+            // Empty lines (e.g. "\r\n" line endings) are not errors.
+            ++batchResult.parseErrors;
+        }
+    }
+
+    return batchResult;
+}
+
+FrameParser::BatchResult SerialFramer::extractLengthPrefixed(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                             SerialSample* samples, std::size_t maxSamples) {
+    FrameParser::BatchResult batchResult{ 0, 0, 0 };
+
+    while (batchResult.consumedBytes < length && batchResult.parsedSamples + this->format.channelCount <= maxSamples) {
+        const char* message = data + batchResult.consumedBytes;
+        std::size_t frameLength = static_cast<unsigned char>(message[0]);
+
+        if (frameLength == 0 || frameLength > this->format.frameSize) {
+            // Length byte cannot be valid - move forward by a single byte looking for the next one.
+            ++batchResult.parseErrors;
+            ++batchResult.consumedBytes;
+            continue;
+        }
+
+        if (length - batchResult.consumedBytes < frameLength + 1) {
+            // Incomplete message, the rest of it comes later.
+            break;
+        }
+
+        if (this->parseMessage(message + 1, message + 1 + frameLength, timestamp,
+                               samples + batchResult.parsedSamples) == FrameParser::Result::OK) {
+            batchResult.parsedSamples += this->format.channelCount;
+            batchResult.consumedBytes += frameLength + 1;
+        }
+        else {
+            // Length byte was most likely a part of corrupted data - resynchronize byte by byte.
+            ++batchResult.parseErrors;
+            ++batchResult.consumedBytes;
+        }
+    }
+
+    return batchResult;
+}
+
+FrameParser::BatchResult SerialFramer::extractFixedWidthChannels(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                                 SerialSample* samples, std::size_t maxSamples) {
+    FrameParser::BatchResult batchResult{ 0, 0, 0 };
+    std::size_t frameWidth = this->format.frameSize;
+
+    while (length - batchResult.consumedBytes >= frameWidth && batchResult.parsedSamples + this->format.channelCount <= maxSamples) {
+        const char* frame = data + batchResult.consumedBytes;
+
+        if (this->parseMessage(frame, frame + frameWidth, timestamp, samples + batchResult.parsedSamples) == FrameParser::Result::OK) {
+            batchResult.parsedSamples += this->format.channelCount;
+            batchResult.consumedBytes += frameWidth;
+        }
+        else {
+            // Same resynchronization as for single value messages (see FrameParser::parseFixedWidthBatch).
+            ++batchResult.parseErrors;
+            ++batchResult.consumedBytes;
+        }
+    }
+
+    return batchResult;
+}
+
+FrameParser::Result SerialFramer::parseMessage(const char* begin, const char* end, SampleTimestamp timestamp, SerialSample* samples) {
+    std::size_t channelCount = this->format.channelCount;
+    FrameParser::Result parseResult = (channelCount == 1) ?
+            FrameParser::parseValue(begin, end, samples[0].value) :
+            FrameParser::parseChannels(begin, end, this->format.channelSeparator, samples, channelCount);
+
+    if (parseResult == FrameParser::Result::OK) {
+        for (std::size_t channel = 0; channel < channelCount; ++channel) {
+            samples[channel].timestamp = timestamp;
+            samples[channel].status = SampleStatus::VALUE;
+            samples[channel].channel = static_cast<std::uint16_t>(channel);
+        }
+    }
+    return parseResult;
+}
@@ -0,0 +1,124 @@
+/*
+ * SerialFramer.h
+ *
+ * Splits stream of bytes received from serial port into messages and parses them.
+ *
+ * Supported message formats:
+ * - fixed width - every message has the same size (e.g. number padded with spaces),
+ * - delimited - messages are terminated by delimiter character (e.g. '\n'),
+ * - length prefixed - every message is preceded by a single byte holding its length.
+ *
+ * Message of any format can hold several numbers separated by a character (multi-channel devices,
+ * e.g. "0.12,-9.81,3.5\n" from IMU). Every number becomes a separate sample with its channel
+ * number, samples of one message follow each other, so analyzers get them together.
+ *
+ * Framer works on blocks of any size - incomplete message at the end of the block is left for
+ * the next call. After corrupted data framer resynchronizes by itself: it skips to the next
+ * delimiter or moves forward byte by byte until a valid message is found.
+ */
+
+#ifndef SERIALFRAMER_H_
+#define SERIALFRAMER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FrameParser.h"
+#include "SerialSample.h"
+
+// Description of messages sent through serial port.
+struct FrameFormat {
+    enum class Type {
+        FIXED_WIDTH,
+        DELIMITED,
+        LENGTH_PREFIXED
+    };
+
+    Type type;
+
+    // FIXED_WIDTH - size of every message, other types - maximal size of message (without
+    // delimiter or length byte). Longer messages are treated as corrupted data.
+    std::size_t frameSize;
+
+    // DELIMITED - character ending every message.
+    char delimiter;
+
+    // Amount of numbers in every message, 1 for single value messages. Can be set for any type.
+    std::size_t channelCount;
+
+    // Character between numbers of multi-channel message.
+    char channelSeparator;
+
+    static FrameFormat fixedWidth(std::size_t frameWidth);
+    static FrameFormat delimited(char delimiter = '\n', std::size_t maxFrameSize = 64);
+    static FrameFormat lengthPrefixed(std::size_t maxFrameSize = 255);
+
+    // Delimited messages holding channelCount numbers each (e.g. "1.5,2.25,-3\n").
+    static FrameFormat multiChannel(std::size_t channelCount, char separator = ',', char delimiter = '\n',
+                                    std::size_t maxFrameSize = 1024);
+};
+
+class SerialFramer {
+public:
+    /**
+     * params:
+     * format - format of messages
+     * portId - id of the port given to all parsed samples
+     */
+    explicit SerialFramer(const FrameFormat& format, PortId portId = 0);
+
+    /**
+     * Extracts and parses all complete messages from received bytes.
+     *
+     * params:
+     * data, length - received bytes, first byte has to follow the last byte consumed by previous call
+     * timestamp - capture time given to all parsed samples
+     * samples - output array
+     * maxSamples - size of output array, parsing stops when it is full
+     * returns: amount of consumed bytes (not consumed ones have to be passed again with next call),
+     *          amount of parsed samples and amount of corrupted messages
+     */
+    FrameParser::BatchResult extractSamples(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                            SerialSample* samples, std::size_t maxSamples);
+
+    // Drops state related to partially received data (e.g. after port was reopened).
+    void reset();
+
+    const FrameFormat& getFormat() const;
+
+    // Returns the biggest amount of bytes single message (with delimiter or length byte) can take.
+    std::size_t getMaxMessageSize() const;
+
+    // Returns the smallest amount of bytes single message (with delimiter or length byte) can take.
+    std::size_t getMinMessageSize() const;
+
+    // Returns the biggest amount of samples that can be extracted from given amount of bytes
+    // (size of output array needed by extractSamples()).
+    std::size_t getMaxSampleCount(std::size_t byteCount) const;
+
+private:
+    FrameFormat format;
+
+    // Port id stamped on parsed samples.
+    PortId portId;
+
+    // DELIMITED - true when too long message is being skipped until next delimiter.
+    bool skippingToDelimiter;
+
+    FrameParser::BatchResult extractDelimited(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                              SerialSample* samples, std::size_t maxSamples);
+
+    FrameParser::BatchResult extractLengthPrefixed(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                   SerialSample* samples, std::size_t maxSamples);
+
+    FrameParser::BatchResult extractFixedWidthChannels(const char* data, std::size_t length, SampleTimestamp timestamp,
+                                                       SerialSample* samples, std::size_t maxSamples);
+
+    /**
+     * Parses single message into format.channelCount samples.
+     * returns: result of parsing, samples are complete only for OK
+     */
+    FrameParser::Result parseMessage(const char* begin, const char* end, SampleTimestamp timestamp, SerialSample* samples);
+};
+
+#endif /* SERIALFRAMER_H_ */
@@ -7,7 +7,7 @@
 
 #include "SerialPortDataAnalyzer.h"
 
-SerialPortDataAnalyzer::SerialPortDataAnalyzer(const std::shared_ptr<Serial>& serialReader) {
+SerialPortDataAnalyzer::SerialPortDataAnalyzer(const std::shared_ptr<SampleSource>& serialReader) {
     this->serialPortReader = serialReader;
 }
 
@@ -19,12 +19,35 @@ SerialPortDataAnalyzer::~SerialPortDataAnalyzer() {
     // For now base destructor does not need to do any specific cleanup.
 }
 
-std::shared_ptr<Serial> SerialPortDataAnalyzer::getSerialPortReader() {
+std::shared_ptr<SampleSource> SerialPortDataAnalyzer::getSerialPortReader() {
     return this->serialPortReader;
 }
 
-bool SerialPortDataAnalyzer::registerToSerialReader(SerialPortDataAnalyzer* analyzer) {
-    return this->serialPortReader->registerDataAnalyzer(analyzer);
+SubscriptionId SerialPortDataAnalyzer::subscribe(ResultCallback callback) {
+    return this->resultPublisher.addCallback(std::move(callback));
+}
+
+void SerialPortDataAnalyzer::unsubscribe(SubscriptionId id) {
+    this->resultPublisher.removeCallback(id);
+}
+
+std::shared_ptr<ResultQueue> SerialPortDataAnalyzer::subscribeQueue(std::size_t capacity) {
+    return this->resultPublisher.addQueue(capacity);
+}
+
+bool SerialPortDataAnalyzer::registerToSerialReader(SerialPortDataAnalyzer* analyzer, BackpressurePolicy policy,
+                                                    std::size_t queueCapacity) {
+    return this->serialPortReader->registerDataAnalyzer(analyzer, policy, queueCapacity);
+}
+
+void SerialPortDataAnalyzer::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        this->fetchNewData(samples[i]);
+    }
+}
+
+bool SerialPortDataAnalyzer::receivesAllChannels() const {
+    return false;
 }
 
 void SerialPortDataAnalyzer::deregisterFromSerialReader(SerialPortDataAnalyzer* analyzer) {
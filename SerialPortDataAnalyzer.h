@@ -9,45 +9,75 @@
 #ifndef SERIALPORTDATAANALYZER_H_
 #define SERIALPORTDATAANALYZER_H_
 
-#include <ctime>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "AnalyzerDispatcher.h"
+#include "ResultPublisher.h"
+#include "SampleClock.h"
+#include "SampleSource.h"
 #include "Serial.h"
+#include "SerialSample.h"
 
 class SerialPortDataAnalyzer {
 public:
     // Ctors
-    // Initializes object and registers to provided serial port reader.
-    SerialPortDataAnalyzer(const std::shared_ptr<Serial>& serialReader);
+    // Initializes object and registers to provided source of readings (serial port reader,
+    // serial port manager or a single port of it).
+    SerialPortDataAnalyzer(const std::shared_ptr<SampleSource>& serialReader);
     // Initializes object, creates and registers to serial port reader from provided serial port name.
     SerialPortDataAnalyzer(const std::string& serialName, unsigned int bufferSize);
 
     virtual ~SerialPortDataAnalyzer();
 
-    // Returns used serial port reader
-    std::shared_ptr<Serial> getSerialPortReader();
+    // Returns used source of readings
+    std::shared_ptr<SampleSource> getSerialPortReader();
 
     /* Pure virtual methods */
     /**
-    * Get latest read with timestamp.
+    * Get latest read with timestamp (monotonic capture time in nanoseconds, see SampleClock).
     * returns: Timestamp with value on success, (-1,0) when error occurs or no sufficient data
     *           was yet received.
     */
-    virtual std::pair<std::time_t, double> getRawData() = 0;
+    virtual std::pair<SampleTimestamp, double> getRawData() = 0;
 
     /**
     * Get latest possible processed read (in case of that example app - filtered read) with timestamp.
     * returns: Timestamp with value on success, (-1,0) when error occurs or no sufficient data
     *           was yet received.
     */
-    virtual std::pair<std::time_t, double> getProcessedData() = 0;
+    virtual std::pair<SampleTimestamp, double> getProcessedData() = 0;
 
+    /**
+     * Subscribes to processed values, so they do not have to be polled. Callback gets every value
+     * analyzer computes (not only the latest one), right after the block of readings it comes from
+     * was processed. Analyzers which do not compute values (e.g. SampleRecorder) publish nothing.
+     *
+     * Callback is called on dispatcher worker thread running the analyzer, so it should be short
+     * and must not unsubscribe itself.
+     * returns: id passed to unsubscribe()
+     */
+    SubscriptionId subscribe(ResultCallback callback);
+
+    // Ends callback subscription, callback is not running anymore when method returns.
+    void unsubscribe(SubscriptionId id);
+
+    /**
+     * Subscribes to processed values through a queue, consumer thread waits for them on the queue
+     * (see ResultQueue). Subscription ends when returned queue is released.
+     * param: capacity - maximal amount of values waiting in queue, the oldest ones are dropped above it
+     */
+    std::shared_ptr<ResultQueue> subscribeQueue(std::size_t capacity = ResultQueue::DEFAULT_CAPACITY);
 
 protected:
-    // Pointer to Serial object responsible for reading data from serial port.
-    std::shared_ptr<Serial> serialPortReader;
+    // Pointer to object delivering readings - Serial object reading data from serial port,
+    // SerialPortManager or a single port of it.
+    std::shared_ptr<SampleSource> serialPortReader;
+
+    // Subscribers of processed values. Analyzers publish results only when it has subscribers,
+    // once per block of readings.
+    ResultPublisher resultPublisher;
 
     /**
      * Registering data analyzer to serial object. Registration allows Serial
@@ -56,9 +86,16 @@ protected:
      * NOTE: It is advised to register data analyzers during construction
      * of objects and deregister them during its destruction.
      *
-     * param: analyzer - pointer to data analyzer.
+     * Analyzer is run on dispatcher worker threads (never on two of them at once) and gets
+     * readings in order. When it does not keep up, its queue behaves according to policy.
+     *
+     * params:
+     * analyzer - pointer to data analyzer.
+     * policy - what to do when analyzer queue is full (by default no reading is lost)
+     * queueCapacity - maximal amount of readings waiting for analyzer
      */
-    bool registerToSerialReader(SerialPortDataAnalyzer* analyzer);
+    bool registerToSerialReader(SerialPortDataAnalyzer* analyzer, BackpressurePolicy policy = BackpressurePolicy::BLOCK,
+                                std::size_t queueCapacity = AnalyzerDispatcher::DEFAULT_ANALYZER_QUEUE_CAPACITY);
 
     /**
      * Deregistering data analyzer from serial object.
@@ -72,15 +109,33 @@ protected:
     void deregisterFromSerialReader(SerialPortDataAnalyzer* analyzer);
 
 private:
-    friend class Serial;
+    friend class AnalyzerDispatcher;
 
     /**
-     * Method used by Serial class object threads to send latest data to analyzer.
+     * Method used by dispatcher worker threads to send latest data to analyzer.
      * Every class should implement way to process that data.
      *
-     * param: data - freshly received data from serial port reader.
+     * param: sample - freshly received sample from serial port reader, already parsed.
+     */
+    virtual void fetchNewData(const SerialSample& sample) = 0;
+
+    /**
+     * Method used by dispatcher worker threads to send block of readings at once.
+     * Default implementation passes them to fetchNewData() one by one, analyzers processing
+     * high rate data should override it to handle whole block under a single lock.
+     *
+     * params:
+     * samples - readings in order of arrival (values and status readings mixed)
+     * count - amount of readings, at least 1
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    /**
+     * Checks if analyzer gets every channel of multi-channel messages (see FrameFormat::channelCount).
+     * By default only channel 0 is delivered, so single value analyzers work with multi-channel
+     * devices as well. Checked once, when analyzer is registered.
      */
-    virtual void fetchNewData(const std::pair<std::time_t, std::string>& data) = 0;
+    virtual bool receivesAllChannels() const;
 };
 
 #endif /* SERIALPORTDATAANALYZER_H_ */
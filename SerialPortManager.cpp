@@ -0,0 +1,520 @@
+/*
+ * SerialPortManager.cpp
+ */
+
+#include "SerialPortManager.h"
+#include "SerialPortDataAnalyzer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+    // Default amount of bytes drained from a port at once (on top of one incomplete message).
+    const std::size_t DEFAULT_READ_CHUNK_SIZE = 4096;
+
+    // Maximal amount of events taken from epoll at once.
+    const int MAX_EVENTS = 64;
+
+    // Delays between reconnection attempts - doubled after every failure up to the maximum.
+    const std::chrono::milliseconds INITIAL_RECONNECT_DELAY(10);
+    const std::chrono::milliseconds MAX_RECONNECT_DELAY(1000);
+}
+
+const PortId SerialPortManager::INVALID_PORT;
+
+class SerialPortManager::PortSource: public SampleSource {
+public:
+    PortSource(const std::shared_ptr<SerialPortManager>& portManager, PortId portId)
+        :portManager(portManager)
+        ,portId(portId) {
+    }
+
+    virtual SerialSample getData() {
+        return this->portManager->getPortData(this->portId);
+    }
+
+    virtual bool IsConnected() {
+        return this->portManager->isPortConnected(this->portId);
+    }
+
+private:
+    // Keeps manager alive as long as any analyzer uses the port.
+    std::shared_ptr<SerialPortManager> portManager;
+    PortId portId;
+
+    virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                      std::size_t queueCapacity) {
+        return this->portManager->registerPortAnalyzer(analyzerToRegister, policy, queueCapacity, this->portId);
+    }
+
+    virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
+        this->portManager->deregisterDataAnalyzer(analyzerToDeregister);
+    }
+};
+
+SerialPortManager::PortState::PortState(PortId portId, const std::string& portName, const FrameFormat& frameFormat,
+                                        const SerialPortSettings& portSettings)
+    :id(portId)
+    ,portName(portName)
+    ,portSettings(portSettings)
+    ,transport(SerialTransport::createDefault())
+    ,framer(frameFormat, portId)
+    ,pendingBytes(0)
+    ,lastReading(SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, portId })
+    ,connected(false)
+    ,frameCount(0)
+    ,byteCount(0)
+    ,parseErrorCount(0)
+    ,reconnectCount(0)
+    ,reconnectDelay(INITIAL_RECONNECT_DELAY) {
+    // Buffer always has space for a big chunk of data on top of incomplete message.
+    std::size_t readChunkSize = (portSettings.receiveBufferSize > 0) ? portSettings.receiveBufferSize : DEFAULT_READ_CHUNK_SIZE;
+    this->readBuffer.resize(readChunkSize + this->framer.getMaxMessageSize());
+    this->parsedSamples.resize(this->framer.getMaxSampleCount(this->readBuffer.size()));
+}
+
+SerialPortManager::SerialPortManager(std::size_t ioThreadCount, std::size_t dispatchThreads)
+    :analyzerDispatcher(dispatchThreads)
+    ,active(true)
+    ,reconnectCount(0)
+    ,parseErrorCount(0) {
+    ioThreadCount = std::max<std::size_t>(ioThreadCount, 1);
+
+    for (std::size_t i = 0; i < ioThreadCount; ++i) {
+        std::unique_ptr<IoThread> ioThread = std::make_unique<IoThread>();
+        ioThread->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+        ioThread->wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ioThread->portCount = 0;
+
+        if (ioThread->epollDescriptor == -1 || ioThread->wakeupDescriptor == -1) {
+            std::cout << "ERROR: could not create epoll instance for serial port manager." << std::endl;
+            if (ioThread->epollDescriptor != -1) {
+                ::close(ioThread->epollDescriptor);
+            }
+            if (ioThread->wakeupDescriptor != -1) {
+                ::close(ioThread->wakeupDescriptor);
+            }
+            continue;
+        }
+
+        // Wake up descriptor is recognized by empty data pointer, ports use pointer to their state.
+        epoll_event wakeupEvent = {};
+        wakeupEvent.events = EPOLLIN;
+        wakeupEvent.data.ptr = nullptr;
+        epoll_ctl(ioThread->epollDescriptor, EPOLL_CTL_ADD, ioThread->wakeupDescriptor, &wakeupEvent);
+
+        this->ioThreads.push_back(std::move(ioThread));
+    }
+
+    for (const std::unique_ptr<IoThread>& ioThread : this->ioThreads) {
+        IoThread* threadState = ioThread.get();
+        threadState->thread = std::thread([this, threadState] {this->runIoThread(*threadState); });
+    }
+}
+
+SerialPortManager::~SerialPortManager() {
+    this->active = false;
+
+    for (const std::unique_ptr<IoThread>& ioThread : this->ioThreads) {
+        std::uint64_t increment = 1;
+        ssize_t result = ::write(ioThread->wakeupDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+
+    for (const std::unique_ptr<IoThread>& ioThread : this->ioThreads) {
+        if (ioThread->thread.joinable()) {
+            ioThread->thread.join();
+        }
+    }
+
+    // I/O threads are stopped, so this thread can publish now. Analyzers still registered
+    // get everything that was read followed by CLOSED reading of every port.
+    {
+        // Empty critical section - addPort() running in the meantime is finished, no port is added later.
+        std::scoped_lock portsLock(this->portsMutex);
+    }
+    for (const std::unique_ptr<PortState>& port : this->ports) {
+        this->publishStatus(*port, SampleStatus::CLOSED);
+    }
+    this->analyzerDispatcher.shutdown();
+
+    for (const std::unique_ptr<PortState>& port : this->ports) {
+        if (port->transport->isOpen()) {
+            port->transport->close();
+        }
+        port->connected = false;
+    }
+
+    for (const std::unique_ptr<IoThread>& ioThread : this->ioThreads) {
+        ::close(ioThread->epollDescriptor);
+        ::close(ioThread->wakeupDescriptor);
+    }
+
+    std::cout << "Serial port manager deleted" << std::endl;
+}
+
+PortId SerialPortManager::addPort(const std::string& portDesc, const FrameFormat& frameFormat,
+                                  const SerialPortSettings& portSettings) {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    if (!this->active || this->ioThreads.empty()) {
+        return INVALID_PORT;
+    }
+    if (this->ports.size() >= INVALID_PORT) {
+        std::cout << "ERROR: too many serial ports." << std::endl;
+        return INVALID_PORT;
+    }
+
+    PortId portId = static_cast<PortId>(this->ports.size());
+    std::unique_ptr<PortState> port = std::make_unique<PortState>(portId, portDesc, frameFormat, portSettings);
+
+    // Transport reports reason of failure by itself.
+    if (!port->transport->open(portDesc, port->portSettings)) {
+        return INVALID_PORT;
+    }
+
+    IoThread* ioThread = std::min_element(this->ioThreads.begin(), this->ioThreads.end(),
+            [](const std::unique_ptr<IoThread>& first, const std::unique_ptr<IoThread>& second) {
+                return first->portCount < second->portCount;
+            })->get();
+
+    port->connected = true;
+    if (!this->watchPort(*ioThread, *port)) {
+        std::cout << "ERROR: serial port " << portDesc << " cannot be watched by event loop." << std::endl;
+        port->transport->close();
+        return INVALID_PORT;
+    }
+
+    ++ioThread->portCount;
+    this->ports.push_back(std::move(port));
+    std::cout << "Serial port " << portDesc << " added with id " << portId << std::endl;
+
+    return portId;
+}
+
+std::shared_ptr<SampleSource> SerialPortManager::getPortSource(PortId portId) {
+    std::shared_ptr<SerialPortManager> portManager = this->weak_from_this().lock();
+
+    if (!portManager) {
+        std::cout << "ERROR: port sources are available only when serial port manager is owned by shared_ptr." << std::endl;
+        return nullptr;
+    }
+    if (portId >= this->getPortCount()) {
+        return nullptr;
+    }
+
+    return std::make_shared<PortSource>(portManager, portId);
+}
+
+SerialSample SerialPortManager::getData() {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    if (this->ports.empty()) {
+        return SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, 0 };
+    }
+
+    // Status readings have invalid timestamp, so any value is newer than them.
+    SerialSample newestReading = this->ports.front()->lastReading.load();
+    for (std::size_t i = 1; i < this->ports.size(); ++i) {
+        SerialSample reading = this->ports[i]->lastReading.load();
+        if (reading.timestamp > newestReading.timestamp) {
+            newestReading = reading;
+        }
+    }
+
+    return newestReading;
+}
+
+bool SerialPortManager::IsConnected() {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    return std::any_of(this->ports.begin(), this->ports.end(),
+            [](const std::unique_ptr<PortState>& port) { return port->connected.load(); });
+}
+
+SerialSample SerialPortManager::getPortData(PortId portId) {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    if (portId >= this->ports.size()) {
+        return SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, portId };
+    }
+    return this->ports[portId]->lastReading.load();
+}
+
+bool SerialPortManager::isPortConnected(PortId portId) {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    return (portId < this->ports.size()) && this->active && this->ports[portId]->connected;
+}
+
+std::string SerialPortManager::getPortName(PortId portId) {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    return (portId < this->ports.size()) ? this->ports[portId]->portName : std::string();
+}
+
+std::size_t SerialPortManager::getPortCount() {
+    std::scoped_lock portsLock(this->portsMutex);
+
+    return this->ports.size();
+}
+
+std::size_t SerialPortManager::getIoThreadCount() const {
+    return this->ioThreads.size();
+}
+
+std::uint64_t SerialPortManager::getReconnectCount() const {
+    return this->reconnectCount;
+}
+
+std::uint64_t SerialPortManager::getParseErrorCount() const {
+    return this->parseErrorCount;
+}
+
+std::uint64_t SerialPortManager::getAnalyzerDroppedCount() const {
+    return this->analyzerDispatcher.getDroppedCount();
+}
+
+const LatencyHistogram& SerialPortManager::getDispatchLatency() const {
+    return this->dispatchLatency;
+}
+
+const LatencyHistogram& SerialPortManager::getAnalyzerLatency() const {
+    return this->analyzerDispatcher.getAnalyzerLatency();
+}
+
+void SerialPortManager::collectMetrics(MetricsWriter& writer) {
+    {
+        std::scoped_lock portsLock(this->portsMutex);
+
+        for (const std::unique_ptr<PortState>& port : this->ports) {
+            std::string portLabels = MetricsWriter::label("port", port->portName);
+
+            writer.addCounter("serial_frames_total", "Messages parsed from serial port.", portLabels,
+                              port->frameCount.load(std::memory_order_relaxed));
+            writer.addCounter("serial_bytes_total", "Bytes read from serial port.", portLabels,
+                              port->byteCount.load(std::memory_order_relaxed));
+            writer.addCounter("serial_parse_errors_total", "Messages which did not contain valid number.", portLabels,
+                              port->parseErrorCount.load(std::memory_order_relaxed));
+            writer.addCounter("serial_reconnects_total", "Times port was reopened after device failure.", portLabels,
+                              port->reconnectCount.load(std::memory_order_relaxed));
+            writer.addGauge("serial_connected", "1 when port is connected, 0 otherwise.", portLabels,
+                            port->connected ? 1 : 0);
+        }
+    }
+
+    // Readings of all ports go through the same dispatcher.
+    std::string labels = MetricsWriter::label("port", "all");
+    writer.addHistogram("serial_read_to_dispatch_seconds",
+                        "Time from reading the oldest message of a block until the block is dispatched.", labels,
+                        this->dispatchLatency);
+
+    this->analyzerDispatcher.collectMetrics(writer, labels);
+}
+
+bool SerialPortManager::registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                             std::size_t queueCapacity) {
+    return this->registerPortAnalyzer(analyzerToRegister, policy, queueCapacity, ALL_PORTS);
+}
+
+void SerialPortManager::deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
+    this->analyzerDispatcher.removeAnalyzer(analyzerToDeregister);
+}
+
+bool SerialPortManager::registerPortAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                             std::size_t queueCapacity, PortId portFilter) {
+    if ((analyzerToRegister != nullptr) && (this->active == true)) {
+        // Dispatcher rejects analyzers that are already registered.
+        return this->analyzerDispatcher.addAnalyzer(analyzerToRegister, policy, queueCapacity, portFilter);
+    }
+    else
+        return false;
+}
+
+void SerialPortManager::runIoThread(IoThread& ioThread) {
+    epoll_event events[MAX_EVENTS];
+
+    // Failed ports of that thread waiting for reconnection.
+    std::vector<PortState*> disconnectedPorts;
+
+    while (this->active) {
+        int eventCount = epoll_wait(ioThread.epollDescriptor, events, MAX_EVENTS, getReconnectTimeout(disconnectedPorts));
+
+        if (eventCount == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "ERROR: waiting for serial ports failed." << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < eventCount && this->active; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                std::uint64_t counter = 0;
+                ssize_t result = ::read(ioThread.wakeupDescriptor, &counter, sizeof(counter));
+                (void) result;
+                continue;
+            }
+
+            PortState* port = static_cast<PortState*>(events[i].data.ptr);
+            long bytesRead = this->readPort(*port);
+
+            // Hang up without any data would wake epoll up again and again.
+            bool hangUp = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+            if (bytesRead < 0 || (bytesRead == 0 && hangUp)) {
+                // Device failed or was unplugged - analyzers are told to drop collected data,
+                // then port is reopened. Registered analyzers stay registered the whole time.
+                this->disconnectPort(ioThread, *port);
+                disconnectedPorts.push_back(port);
+            }
+        }
+
+        if (!disconnectedPorts.empty() && this->active) {
+            this->reconnectPorts(ioThread, disconnectedPorts);
+        }
+    }
+}
+
+long SerialPortManager::readPort(PortState& port) {
+    // Epoll is level triggered - when buffer fills up before driver buffer is drained,
+    // the rest is read after next wake up.
+    long bytesRead = port.transport->readAvailable(port.readBuffer.data() + port.pendingBytes,
+                                                   port.readBuffer.size() - port.pendingBytes);
+
+    if (bytesRead > 0) {
+        // Timestamp is taken right after read returns, before any processing.
+        SampleTimestamp readTime = SampleClock::now();
+        port.pendingBytes += static_cast<std::size_t>(bytesRead);
+        port.byteCount.fetch_add(static_cast<std::uint64_t>(bytesRead), std::memory_order_relaxed);
+        this->publishCompleteFrames(port, readTime);
+
+        // Port works again, next failure is retried quickly.
+        port.reconnectDelay = INITIAL_RECONNECT_DELAY;
+    }
+
+    return bytesRead;
+}
+
+void SerialPortManager::publishCompleteFrames(PortState& port, SampleTimestamp readTime) {
+    FrameParser::BatchResult batchResult = port.framer.extractSamples(port.readBuffer.data(), port.pendingBytes,
+            readTime, port.parsedSamples.data(), port.parsedSamples.size());
+    std::size_t frameStart = batchResult.consumedBytes;
+
+    if (batchResult.parseErrors > 0) {
+        port.parseErrorCount.fetch_add(batchResult.parseErrors, std::memory_order_relaxed);
+        if (this->parseErrorCount.fetch_add(batchResult.parseErrors) == 0) {
+            std::cout << "Error during processing data from serial port " << port.portName
+                      << " - wrong value format or value out of range" << std::endl;
+        }
+    }
+
+    if (batchResult.parsedSamples > 0) {
+        // getPortData() gets only the newest reading from the batch.
+        port.lastReading.store(port.parsedSamples[batchResult.parsedSamples - 1]);
+        // Every message gives one reading per channel.
+        port.frameCount.fetch_add(batchResult.parsedSamples / port.framer.getFormat().channelCount,
+                                  std::memory_order_relaxed);
+        // Whole batch goes to analyzer queues at once, straight from I/O thread.
+        this->dispatchLatency.recordSince(readTime);
+        this->analyzerDispatcher.dispatch(port.parsedSamples.data(), batchResult.parsedSamples);
+    }
+
+    if (frameStart > 0) {
+        // Move incomplete message to the beginning of the buffer, rest of it will come with next read.
+        std::copy(port.readBuffer.begin() + frameStart, port.readBuffer.begin() + port.pendingBytes,
+                  port.readBuffer.begin());
+        port.pendingBytes -= frameStart;
+    }
+}
+
+void SerialPortManager::publishStatus(PortState& port, SampleStatus status) {
+    SerialSample statusSample{ INVALID_TIMESTAMP, 0, status, port.id };
+    port.lastReading.store(statusSample);
+    this->analyzerDispatcher.dispatch(&statusSample, 1);
+}
+
+bool SerialPortManager::watchPort(IoThread& ioThread, PortState& port) {
+    int portDescriptor = port.transport->getPollDescriptor();
+    if (portDescriptor == -1) {
+        return false;
+    }
+
+    epoll_event portEvent = {};
+    portEvent.events = EPOLLIN;
+    portEvent.data.ptr = &port;
+
+    return epoll_ctl(ioThread.epollDescriptor, EPOLL_CTL_ADD, portDescriptor, &portEvent) == 0;
+}
+
+void SerialPortManager::disconnectPort(IoThread& ioThread, PortState& port) {
+    port.connected = false;
+
+    epoll_ctl(ioThread.epollDescriptor, EPOLL_CTL_DEL, port.transport->getPollDescriptor(), nullptr);
+    port.transport->close();
+
+    // Bytes received before failure cannot be completed anymore.
+    port.pendingBytes = 0;
+    port.framer.reset();
+
+    this->publishStatus(port, SampleStatus::READ_ERROR);
+
+    // Delay is kept from previous failures when port failed again before delivering any data.
+    port.nextReconnectTime = std::chrono::steady_clock::now() + port.reconnectDelay;
+    port.reconnectDelay = std::min(port.reconnectDelay * 2, MAX_RECONNECT_DELAY);
+}
+
+void SerialPortManager::reconnectPorts(IoThread& ioThread, std::vector<PortState*>& disconnectedPorts) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < disconnectedPorts.size();) {
+        PortState& port = *disconnectedPorts[i];
+
+        if (port.nextReconnectTime > now) {
+            ++i;
+            continue;
+        }
+
+        // Opening applies line settings again.
+        if (port.transport->open(port.portName, port.portSettings)) {
+            if (this->watchPort(ioThread, port)) {
+                port.connected = true;
+                ++this->reconnectCount;
+                port.reconnectCount.fetch_add(1, std::memory_order_relaxed);
+                std::cout << "Serial port " << port.portName << " reconnected" << std::endl;
+                this->publishStatus(port, SampleStatus::RECONNECTED);
+
+                disconnectedPorts.erase(disconnectedPorts.begin() + i);
+                continue;
+            }
+            port.transport->close();
+        }
+
+        port.nextReconnectTime = now + port.reconnectDelay;
+        port.reconnectDelay = std::min(port.reconnectDelay * 2, MAX_RECONNECT_DELAY);
+        ++i;
+    }
+}
+
+int SerialPortManager::getReconnectTimeout(const std::vector<PortState*>& disconnectedPorts) {
+    if (disconnectedPorts.empty()) {
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point nearestAttempt = disconnectedPorts.front()->nextReconnectTime;
+    for (const PortState* port : disconnectedPorts) {
+        nearestAttempt = std::min(nearestAttempt, port->nextReconnectTime);
+    }
+
+    std::chrono::steady_clock::duration remainingTime = nearestAttempt - std::chrono::steady_clock::now();
+    if (remainingTime <= std::chrono::steady_clock::duration::zero()) {
+        return 0;
+    }
+
+    // Rounded up, so attempt is not made before its time.
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remainingTime).count());
+}
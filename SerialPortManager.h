@@ -0,0 +1,253 @@
+/*
+ * SerialPortManager.h
+ *
+ * Reads many serial ports with a small, fixed amount of I/O threads (Linux only, epoll).
+ *
+ * Ports are spread over I/O threads. Every thread waits for all its ports with a single epoll
+ * instance and drains each port that has data, so monitoring 64 sensors does not need 128 threads.
+ * Failed ports are reopened by the same thread with growing delay, in between reads of other ports.
+ *
+ * Every reading carries id of its port. Analyzers registered to the manager itself get readings
+ * of all ports, analyzers registered to a source returned by getPortSource() get readings of that
+ * port only. All analyzers run on one AnalyzerDispatcher shared by all ports.
+ *
+ * Manager has to be owned by shared_ptr, port sources keep it alive.
+ *
+ * Example:
+ *   std::shared_ptr<SerialPortManager> manager = std::make_shared<SerialPortManager>(2);
+ *   PortId firstPort = manager->addPort("/dev/ttyUSB0", FrameFormat::delimited());
+ *   PortId secondPort = manager->addPort("/dev/ttyUSB1", FrameFormat::delimited());
+ *   MedianFilter firstMedian(manager->getPortSource(firstPort), 2);
+ *   MedianFilter secondMedian(manager->getPortSource(secondPort), 2);
+ */
+
+#ifndef SERIALPORTMANAGER_H_
+#define SERIALPORTMANAGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AnalyzerDispatcher.h"
+#include "LatencyHistogram.h"
+#include "MetricsWriter.h"
+#include "SampleSource.h"
+#include "SeqLock.h"
+#include "SerialFramer.h"
+#include "SerialPortSettings.h"
+#include "SerialSample.h"
+#include "SerialTransport.h"
+
+class SerialPortManager: public SampleSource, public MetricsProvider, public std::enable_shared_from_this<SerialPortManager> {
+public:
+    // Returned by addPort() on failure, ports get ids below that value.
+    static const PortId INVALID_PORT = ALL_PORTS - 1;
+
+    /**
+     * Starts I/O threads, ports are added later with addPort().
+     *
+     * params:
+     * ioThreadCount - amount of threads reading ports (at least 1)
+     * dispatchThreads - amount of threads running analyzers, 0 means one per processor core
+     */
+    explicit SerialPortManager(std::size_t ioThreadCount = 1, std::size_t dispatchThreads = 0);
+
+    // Stops I/O threads, delivers CLOSED reading of every port and closes all ports.
+    virtual ~SerialPortManager();
+
+    SerialPortManager(const SerialPortManager&) = delete;
+    SerialPortManager& operator=(const SerialPortManager&) = delete;
+
+    /**
+     * Opens port and starts reading it on I/O thread with the least ports. Event loop reads
+     * whatever has arrived, so minimumReadBytes and interByteTimeoutMs settings are not used.
+     *
+     * params:
+     * portDesc - name of serial port
+     * frameFormat - format of messages (fixed width, delimited or length prefixed)
+     * portSettings - baud rate, character format, flow control etc.
+     * returns: id of the port, INVALID_PORT when port could not be opened
+     */
+    PortId addPort(const std::string& portDesc, const FrameFormat& frameFormat,
+                   const SerialPortSettings& portSettings = SerialPortSettings());
+
+    /**
+     * Returns source of readings of a single port - analyzers registered to it get only
+     * readings of that port.
+     * returns: port source, nullptr when port does not exist or manager is not owned by shared_ptr
+     */
+    std::shared_ptr<SampleSource> getPortSource(PortId portId);
+
+    // Get the newest value read from any port. When no port has a value yet, status reading
+    // of the first port is returned (INITIALIZING when there are no ports).
+    virtual SerialSample getData();
+
+    // Check if at least one port is connected.
+    virtual bool IsConnected();
+
+    // Get last reading of given port, INITIALIZING reading when port does not exist.
+    SerialSample getPortData(PortId portId);
+
+    // Check if given port is connected. After device failure it is false until port is reopened.
+    bool isPortConnected(PortId portId);
+
+    // Returns name of given port, empty string when port does not exist.
+    std::string getPortName(PortId portId);
+
+    // Returns amount of added ports.
+    std::size_t getPortCount();
+
+    // Returns amount of I/O threads.
+    std::size_t getIoThreadCount() const;
+
+    // Returns amount of times ports were reopened after device failure.
+    std::uint64_t getReconnectCount() const;
+
+    // Returns amount of messages (of all ports) that were dropped because they did not contain valid number.
+    std::uint64_t getParseErrorCount() const;
+
+    // Returns amount of readings dropped or coalesced by analyzer queues (DROP_OLDEST and COALESCE policies).
+    std::uint64_t getAnalyzerDroppedCount() const;
+
+    // Returns histogram of time from reading messages until they are dispatched to analyzers (all ports).
+    const LatencyHistogram& getDispatchLatency() const;
+
+    // Returns histogram of time from dispatching readings until analyzer processed them.
+    const LatencyHistogram& getAnalyzerLatency() const;
+
+    // Adds counters of every port (labelled with port name), latency histograms
+    // and analyzer queue gauges (labelled port="all").
+    virtual void collectMetrics(MetricsWriter& writer);
+
+private:
+    // Source of readings of a single port.
+    class PortSource;
+
+    // State of single port, used only by I/O thread reading it (besides atomic and seqlock fields).
+    struct PortState {
+        PortState(PortId portId, const std::string& portName, const FrameFormat& frameFormat,
+                  const SerialPortSettings& portSettings);
+
+        PortId id;
+
+        // Name of the port and line settings, kept for reconnecting
+        std::string portName;
+        SerialPortSettings portSettings;
+
+        std::unique_ptr<SerialTransport> transport;
+
+        // Splits received bytes into messages and parses them
+        SerialFramer framer;
+
+        // Buffer for reading, incomplete message is kept at its beginning until the rest arrives.
+        std::vector<char> readBuffer;
+
+        // Amount of bytes from incomplete message stored in readBuffer
+        std::size_t pendingBytes;
+
+        // Samples parsed from the latest read
+        std::vector<SerialSample> parsedSamples;
+
+        // Last reading of the port, read by getters without locking.
+        SeqLock<SerialSample> lastReading;
+
+        // False while port waits for reconnection
+        std::atomic<bool> connected;
+
+        // Counters of the port, written by its I/O thread and read by collectMetrics().
+        std::atomic<std::uint64_t> frameCount;
+        std::atomic<std::uint64_t> byteCount;
+        std::atomic<std::uint64_t> parseErrorCount;
+        std::atomic<std::uint64_t> reconnectCount;
+
+        // Time of the next reopen attempt (used only while disconnected) and delay before the following one.
+        // Delay is reset when port delivers data, so port failing right after reopening is retried
+        // less and less often.
+        std::chrono::steady_clock::time_point nextReconnectTime;
+        std::chrono::milliseconds reconnectDelay;
+    };
+
+    // Thread with its epoll instance watching all ports assigned to that thread.
+    struct IoThread {
+        int epollDescriptor;
+
+        // Eventfd used to wake up the thread when manager is destroyed.
+        int wakeupDescriptor;
+
+        // Amount of ports assigned to that thread, protected by portsMutex.
+        std::size_t portCount;
+
+        std::thread thread;
+    };
+
+    // Runs analyzers of all ports, each one with its own queue
+    AnalyzerDispatcher analyzerDispatcher;
+
+    // Protects ports and portCount of I/O threads. Ports are only added, so pointers
+    // given to I/O threads stay valid until manager is destroyed.
+    std::mutex portsMutex;
+    std::vector<std::unique_ptr<PortState>> ports;
+
+    std::vector<std::unique_ptr<IoThread>> ioThreads;
+
+    // False once destructor was called.
+    std::atomic<bool> active;
+
+    // Amount of successful reconnections of all ports
+    std::atomic<std::uint64_t> reconnectCount;
+
+    // Amount of messages which did not contain valid number
+    std::atomic<std::uint64_t> parseErrorCount;
+
+    // Time from reading messages until they are passed to analyzerDispatcher (once per read)
+    LatencyHistogram dispatchLatency;
+
+    // Registers analyzer getting readings of all ports.
+    virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                      std::size_t queueCapacity);
+
+    // Deregisters data analyzer (registered to manager or to any port source).
+    virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister);
+
+    // Registers analyzer getting readings of given port (ALL_PORTS for every port).
+    // Returns - true on success, false otherwise
+    bool registerPortAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                              std::size_t queueCapacity, PortId portFilter);
+
+    // Waits for data on ports of given thread and reopens failed ones until manager is destroyed.
+    void runIoThread(IoThread& ioThread);
+
+    /**
+     * Reads everything port has buffered and publishes complete messages.
+     * returns: amount of bytes read, -1 on device failure
+     */
+    long readPort(PortState& port);
+
+    // Splits bytes gathered in readBuffer of the port into messages and dispatches them.
+    // readTime - capture timestamp of the latest read, given to all messages completed by it
+    void publishCompleteFrames(PortState& port, SampleTimestamp readTime);
+
+    // Publishes status sample of the port (READ_ERROR etc.) with invalid timestamp.
+    void publishStatus(PortState& port, SampleStatus status);
+
+    // Adds opened port to epoll instance of the thread.
+    // Returns - true on success, false otherwise
+    bool watchPort(IoThread& ioThread, PortState& port);
+
+    // Removes failed port from epoll instance, closes it and tells analyzers to drop collected data.
+    void disconnectPort(IoThread& ioThread, PortState& port);
+
+    // Tries to reopen ports whose reconnection time has come, reopened ones are removed from the list.
+    void reconnectPorts(IoThread& ioThread, std::vector<PortState*>& disconnectedPorts);
+
+    // Returns time to the nearest reconnection attempt in milliseconds, -1 when no port is disconnected.
+    static int getReconnectTimeout(const std::vector<PortState*>& disconnectedPorts);
+};
+
+#endif /* SERIALPORTMANAGER_H_ */
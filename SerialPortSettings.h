@@ -0,0 +1,73 @@
+/*
+ * SerialPortSettings.h
+ *
+ * Line settings of serial port - applied by transport every time port is opened
+ * (also when it is reopened after device failure).
+ *
+ * Default values match Arduino generator: 9600 baud, 8N1, no flow control, DTR enabled.
+ */
+
+#ifndef SERIALPORTSETTINGS_H_
+#define SERIALPORTSETTINGS_H_
+
+#include <cstddef>
+
+struct SerialPortSettings {
+    enum class Parity {
+        NONE,
+        ODD,
+        EVEN
+    };
+
+    enum class StopBits {
+        ONE,
+        TWO
+    };
+
+    enum class FlowControl {
+        NONE,
+        HARDWARE, // RTS/CTS
+        SOFTWARE  // XON/XOFF
+    };
+
+    // Bits per second. Besides standard rates any rate supported by the driver can be used
+    // (e.g. 2000000 or 3500000 for USB adapters).
+    unsigned int baudRate = 9600;
+
+    // Amount of data bits in a character, 5 - 8.
+    unsigned int dataBits = 8;
+
+    Parity parity = Parity::NONE;
+
+    StopBits stopBits = StopBits::ONE;
+
+    FlowControl flowControl = FlowControl::NONE;
+
+    // Setting DTR ensures that the Arduino is properly reset upon establishing a connection.
+    bool dtrEnabled = true;
+
+    // Read wake up semantics (VMIN/VTIME equivalent). Reader is woken up when at least
+    // minimumReadBytes are buffered, or when no new byte arrived for interByteTimeoutMs.
+    // minimumReadBytes is used only with positive interByteTimeoutMs, so reader never waits
+    // forever for the rest of a burst. Default wakes up on every byte - lowest latency.
+    // At high rates bigger values let a single wake up take many messages at once.
+    std::size_t minimumReadBytes = 1;
+    int interByteTimeoutMs = 0;
+
+    // Size of driver receive and transmit buffers, 0 keeps driver defaults. Windows applies
+    // them to the driver (SetupComm), Linux tty buffers cannot be resized so on Linux
+    // receiveBufferSize is only the amount of bytes Serial takes from the driver at once.
+    std::size_t receiveBufferSize = 0;
+    std::size_t transmitBufferSize = 0;
+
+    // Linux only - asks driver to deliver bytes immediately (e.g. FTDI adapters otherwise
+    // hold them for up to 16 ms). Ignored when driver does not support it.
+    bool lowLatency = false;
+
+    // Returns amount of bits sent on the line for a single character (start bit included).
+    unsigned int bitsPerCharacter() const {
+        return 1 + this->dataBits + ((this->parity != Parity::NONE) ? 1 : 0) + ((this->stopBits == StopBits::TWO) ? 2 : 1);
+    }
+};
+
+#endif /* SERIALPORTSETTINGS_H_ */
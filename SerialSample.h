@@ -0,0 +1,61 @@
+/*
+ * SerialSample.h
+ *
+ * Single reading from serial port - message is parsed once by Serial object and passed
+ * to analyzers in that form.
+ */
+
+#ifndef SERIALSAMPLE_H_
+#define SERIALSAMPLE_H_
+
+#include <cstdint>
+
+#include "SampleClock.h"
+
+// State of serial reader reported with a sample. Only VALUE samples carry a measurement,
+// other ones mean that analyzers should drop collected data.
+enum class SampleStatus : std::uint8_t {
+    VALUE,
+    INITIALIZING,
+    READ_ERROR,
+    CLOSED,
+    RECONNECTED     // port was reopened after READ_ERROR, values follow
+};
+
+// Identifier of serial port given by SerialPortManager, standalone Serial object uses 0.
+typedef std::uint16_t PortId;
+
+// Port filter meaning readings of all ports, never used as id of a port.
+const PortId ALL_PORTS = 0xFFFF;
+
+struct SerialSample {
+    // Capture time, INVALID_TIMESTAMP for status samples.
+    SampleTimestamp timestamp;
+    // Measured value, 0 for status samples.
+    double value;
+    SampleStatus status;
+    // Port the reading comes from (status samples too).
+    PortId portId;
+    // Number of value in multi-channel message (see FrameFormat::channelCount), 0 for single value
+    // messages and status samples. Channels of one message follow each other with the same timestamp.
+    std::uint16_t channel = 0;
+};
+
+// Returns readable name of status.
+inline const char* sampleStatusName(SampleStatus status) {
+    switch (status) {
+    case SampleStatus::VALUE:
+        return "VALUE";
+    case SampleStatus::INITIALIZING:
+        return "INITIALIZING";
+    case SampleStatus::READ_ERROR:
+        return "ERROR";
+    case SampleStatus::CLOSED:
+        return "CLOSED";
+    case SampleStatus::RECONNECTED:
+        return "RECONNECTED";
+    }
+    return "UNKNOWN";
+}
+
+#endif /* SERIALSAMPLE_H_ */
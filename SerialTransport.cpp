@@ -0,0 +1,27 @@
+/*
+ * SerialTransport.cpp
+ */
+
+#include "SerialTransport.h"
+
+#ifdef _WIN32
+#include "WindowsSerialTransport.h"
+#else
+#include "PosixSerialTransport.h"
+#endif
+
+SerialTransport::~SerialTransport() {
+    // Base class does not own any resources.
+}
+
+int SerialTransport::getPollDescriptor() const {
+    return -1;
+}
+
+std::unique_ptr<SerialTransport> SerialTransport::createDefault() {
+#ifdef _WIN32
+    return std::make_unique<WindowsSerialTransport>();
+#else
+    return std::make_unique<PosixSerialTransport>();
+#endif
+}
@@ -0,0 +1,75 @@
+/*
+ * SerialTransport.h
+ *
+ * Platform independent interface of serial port device. Serial object uses it to open port,
+ * wait for incoming bytes and read everything that is available at once, so reading
+ * logic does not depend on operating system API.
+ */
+
+#ifndef SERIALTRANSPORT_H_
+#define SERIALTRANSPORT_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "SerialPortSettings.h"
+
+class SerialTransport {
+public:
+    // Result of waiting for incoming data.
+    enum class WaitResult {
+        DATA_AVAILABLE, // at least one byte can be read without blocking
+        TIMEOUT,        // nothing arrived in given time
+        INTERRUPTED,    // interrupt() was called from other thread
+        FAILURE         // device error or device was disconnected
+    };
+
+    virtual ~SerialTransport();
+
+    /**
+     * Opens and configures serial port.
+     *
+     * params:
+     * portDesc - name of the port ("COM3", "/dev/ttyUSB0" etc.)
+     * settings - line settings (baud rate, parity, flow control etc.)
+     * returns: true on success, false otherwise
+     */
+    virtual bool open(const std::string& portDesc, const SerialPortSettings& settings) = 0;
+
+    // Closes serial port, does nothing when port is not opened.
+    virtual void close() = 0;
+
+    // Checks if port is opened.
+    virtual bool isOpen() const = 0;
+
+    /**
+     * Blocks until there is data to read, timeout passes or wait is interrupted.
+     * Respects minimumReadBytes and interByteTimeoutMs from settings given to open().
+     *
+     * param: timeoutMs - maximal wait time in milliseconds, negative value means infinite wait.
+     */
+    virtual WaitResult waitForData(int timeoutMs) = 0;
+
+    /**
+     * Reads all bytes that are currently available (but no more than capacity) without blocking.
+     *
+     * returns: number of bytes read (0 when nothing was available), -1 on error
+     */
+    virtual long readAvailable(char* buffer, std::size_t capacity) = 0;
+
+    // Wakes up thread blocked in waitForData(). Can be called from any thread.
+    virtual void interrupt() = 0;
+
+    /**
+     * Returns descriptor which becomes readable when data arrives, so opened port can be
+     * watched by external event loop (SerialPortManager) instead of waitForData().
+     * returns: descriptor, -1 when port is closed or transport does not provide one
+     */
+    virtual int getPollDescriptor() const;
+
+    // Creates transport appropriate for current platform.
+    static std::unique_ptr<SerialTransport> createDefault();
+};
+
+#endif /* SERIALTRANSPORT_H_ */
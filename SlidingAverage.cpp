@@ -0,0 +1,78 @@
+/*
+ * SlidingAverage.cpp
+ */
+
+#include "SlidingAverage.h"
+
+#include <algorithm>
+
+namespace {
+    // Minimal amount of updates between exact sum recalculations.
+    const std::size_t MIN_RESYNC_INTERVAL = 4096;
+}
+
+SlidingAverage::SlidingAverage(unsigned int windowWidth)
+    :window(std::max(windowWidth, 1u))
+    ,nextIndex(0)
+    ,valueCount(0)
+    ,runningSum(0)
+    ,compensation(0)
+    ,updatesSinceResync(0)
+    ,resyncInterval(std::max<std::size_t>(this->window.size(), MIN_RESYNC_INTERVAL)) {
+}
+
+void SlidingAverage::push(SampleTimestamp timestamp, double value) {
+    if (this->valueCount == this->window.size()) {
+        // Oldest value leaves the window together with newest one entering it.
+        this->addToSum(value - this->window[this->nextIndex].second);
+    }
+    else {
+        this->addToSum(value);
+        ++this->valueCount;
+    }
+
+    this->window[this->nextIndex] = std::pair<SampleTimestamp, double>(timestamp, value);
+    this->nextIndex = (this->nextIndex + 1 == this->window.size()) ? 0 : this->nextIndex + 1;
+
+    if (++this->updatesSinceResync >= this->resyncInterval) {
+        this->resyncSum();
+    }
+}
+
+void SlidingAverage::clear() {
+    this->nextIndex = 0;
+    this->valueCount = 0;
+    this->runningSum = 0;
+    this->compensation = 0;
+    this->updatesSinceResync = 0;
+}
+
+bool SlidingAverage::isFull() const {
+    return this->valueCount == this->window.size();
+}
+
+double SlidingAverage::getAverage() const {
+    return this->runningSum / static_cast<double>(this->window.size());
+}
+
+SampleTimestamp SlidingAverage::getCenterTimestamp() const {
+    // When window is full nextIndex points at the oldest value.
+    std::size_t centerIndex = (this->nextIndex + this->window.size() / 2) % this->window.size();
+    return this->window[centerIndex].first;
+}
+
+void SlidingAverage::addToSum(double value) {
+    double correctedValue = value - this->compensation;
+    double newSum = this->runningSum + correctedValue;
+    this->compensation = (newSum - this->runningSum) - correctedValue;
+    this->runningSum = newSum;
+}
+
+void SlidingAverage::resyncSum() {
+    this->runningSum = 0;
+    this->compensation = 0;
+    for (std::size_t i = 0; i < this->valueCount; ++i) {
+        this->addToSum(this->window[i].second);
+    }
+    this->updatesSinceResync = 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * SlidingAverage.h
+ *
+ * Average of last windowWidth values, updated in constant time per value.
+ *
+ * Values are kept in circular buffer allocated once, average is computed from running sum
+ * updated with compensated (Kahan) summation. Floating point error accumulated by adding and
+ * removing values is cleared by periodic exact recalculation of the sum, cost of which is
+ * spread over at least windowWidth updates.
+ */
+
+#ifndef SLIDINGAVERAGE_H_
+#define SLIDINGAVERAGE_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "SampleClock.h"
+
+class SlidingAverage {
+public:
+    // windowWidth - amount of values that are averaged (at least 1)
+    explicit SlidingAverage(unsigned int windowWidth);
+
+    /**
+     * Adds newest value to the window, oldest one is removed when window is full.
+     *
+     * params:
+     * timestamp - timestamp of value
+     * value - new value
+     */
+    void push(SampleTimestamp timestamp, double value);
+
+    // Removes all values from the window.
+    void clear();
+
+    // Checks if window holds windowWidth values already.
+    bool isFull() const;
+
+    // Returns average of values in the window (valid only when window is full).
+    double getAverage() const;
+
+    // Returns timestamp of value from the middle of the window (valid only when window is full).
+    SampleTimestamp getCenterTimestamp() const;
+
+private:
+    // Circular buffer of values, nextIndex points at the oldest value once buffer is full.
+    std::vector<std::pair<SampleTimestamp, double>> window;
+    std::size_t nextIndex;
+    std::size_t valueCount;
+
+    // Running sum of values in the window and Kahan compensation term of that sum.
+    double runningSum;
+    double compensation;
+
+    // Amount of updates since sum was recalculated, and how often it should be done.
+    std::size_t updatesSinceResync;
+    std::size_t resyncInterval;
+
+    // Adds value to running sum using compensated summation.
+    void addToSum(double value);
+
+    // Recalculates running sum from values in the window.
+    void resyncSum();
+};
+
+#endif /* SLIDINGAVERAGE_H_ */
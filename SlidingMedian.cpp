@@ -0,0 +1,177 @@
+/*
+ * SlidingMedian.cpp
+ */
+
+#include "SlidingMedian.h"
+
+#include <algorithm>
+
+SlidingMedian::SlidingMedian(unsigned int windowWidth)
+    :window(std::max(windowWidth, 1u))
+    ,nextIndex(0)
+    ,valueCount(0)
+    ,lowerHeap(this->window.size() / 2 + 1)
+    ,upperHeap(this->window.size() / 2 + 1)
+    ,lowerHeapSize(0)
+    ,upperHeapSize(0)
+    ,slotInLowerHeap(this->window.size(), 0)
+    ,slotHeapPosition(this->window.size(), 0) {
+}
+
+void SlidingMedian::push(SampleTimestamp timestamp, double value) {
+    std::size_t slot = this->nextIndex;
+    this->window[slot] = std::pair<SampleTimestamp, double>(timestamp, value);
+    this->nextIndex = (this->nextIndex + 1 == this->window.size()) ? 0 : this->nextIndex + 1;
+
+    if (this->valueCount < this->window.size()) {
+        ++this->valueCount;
+        this->insertSlot(slot);
+    }
+    else {
+        // Slot of the oldest value got the newest one - it stays in the same heap, only its
+        // position has to be corrected, then at most one value has to change heap.
+        bool lower = this->slotInLowerHeap[slot] != 0;
+        this->restoreHeapOrder(lower, this->slotHeapPosition[slot]);
+        this->fixHeapsBoundary();
+    }
+}
+
+void SlidingMedian::clear() {
+    this->nextIndex = 0;
+    this->valueCount = 0;
+    this->lowerHeapSize = 0;
+    this->upperHeapSize = 0;
+}
+
+bool SlidingMedian::isFull() const {
+    return this->valueCount == this->window.size();
+}
+
+double SlidingMedian::getMedian() const {
+    double lowerMiddle = this->slotValue(this->lowerHeap[0]);
+    if (this->lowerHeapSize > this->upperHeapSize) {
+        return lowerMiddle;
+    }
+    return (lowerMiddle + this->slotValue(this->upperHeap[0])) / 2.0;
+}
+
+SampleTimestamp SlidingMedian::getCenterTimestamp() const {
+    // When window is full nextIndex points at the oldest value.
+    std::size_t centerIndex = (this->nextIndex + this->window.size() / 2) % this->window.size();
+    return this->window[centerIndex].first;
+}
+
+double SlidingMedian::slotValue(std::size_t slot) const {
+    return this->window[slot].second;
+}
+
+bool SlidingMedian::isHigherInHeap(bool lower, std::size_t firstSlot, std::size_t secondSlot) const {
+    return lower ? (this->slotValue(firstSlot) > this->slotValue(secondSlot))
+                 : (this->slotValue(firstSlot) < this->slotValue(secondSlot));
+}
+
+void SlidingMedian::placeInHeap(bool lower, std::size_t position, std::size_t slot) {
+    (lower ? this->lowerHeap : this->upperHeap)[position] = slot;
+    this->slotInLowerHeap[slot] = lower ? 1 : 0;
+    this->slotHeapPosition[slot] = position;
+}
+
+std::size_t SlidingMedian::siftUp(bool lower, std::size_t position) {
+    std::vector<std::size_t>& heap = lower ? this->lowerHeap : this->upperHeap;
+    std::size_t slot = heap[position];
+
+    while (position > 0) {
+        std::size_t parentPosition = (position - 1) / 2;
+        if (!this->isHigherInHeap(lower, slot, heap[parentPosition])) {
+            break;
+        }
+        this->placeInHeap(lower, position, heap[parentPosition]);
+        position = parentPosition;
+    }
+    this->placeInHeap(lower, position, slot);
+    return position;
+}
+
+std::size_t SlidingMedian::siftDown(bool lower, std::size_t position) {
+    std::vector<std::size_t>& heap = lower ? this->lowerHeap : this->upperHeap;
+    std::size_t heapSize = lower ? this->lowerHeapSize : this->upperHeapSize;
+    std::size_t slot = heap[position];
+
+    while (true) {
+        std::size_t childPosition = 2 * position + 1;
+        if (childPosition >= heapSize) {
+            break;
+        }
+        if (childPosition + 1 < heapSize && this->isHigherInHeap(lower, heap[childPosition + 1], heap[childPosition])) {
+            ++childPosition;
+        }
+        if (!this->isHigherInHeap(lower, heap[childPosition], slot)) {
+            break;
+        }
+        this->placeInHeap(lower, position, heap[childPosition]);
+        position = childPosition;
+    }
+    this->placeInHeap(lower, position, slot);
+    return position;
+}
+
+void SlidingMedian::restoreHeapOrder(bool lower, std::size_t position) {
+    if (this->siftUp(lower, position) == position) {
+        this->siftDown(lower, position);
+    }
+}
+
+void SlidingMedian::insertSlot(std::size_t slot) {
+    if (this->lowerHeapSize == 0 || this->slotValue(slot) <= this->slotValue(this->lowerHeap[0])) {
+        this->placeInHeap(true, this->lowerHeapSize, slot);
+        this->siftUp(true, this->lowerHeapSize++);
+    }
+    else {
+        this->placeInHeap(false, this->upperHeapSize, slot);
+        this->siftUp(false, this->upperHeapSize++);
+    }
+
+    // Keep sizes balanced - lower heap has the same amount of values as upper one or one more.
+    if (this->lowerHeapSize > this->upperHeapSize + 1) {
+        this->moveTop(true);
+    }
+    else if (this->upperHeapSize > this->lowerHeapSize) {
+        this->moveTop(false);
+    }
+}
+
+void SlidingMedian::moveTop(bool fromLower) {
+    std::vector<std::size_t>& sourceHeap = fromLower ? this->lowerHeap : this->upperHeap;
+    std::size_t& sourceSize = fromLower ? this->lowerHeapSize : this->upperHeapSize;
+    std::size_t& targetSize = fromLower ? this->upperHeapSize : this->lowerHeapSize;
+
+    std::size_t movedSlot = sourceHeap[0];
+
+    // Remove top of source heap.
+    --sourceSize;
+    if (sourceSize > 0) {
+        this->placeInHeap(fromLower, 0, sourceHeap[sourceSize]);
+        this->siftDown(fromLower, 0);
+    }
+
+    // Add it to target heap.
+    this->placeInHeap(!fromLower, targetSize, movedSlot);
+    this->siftUp(!fromLower, targetSize++);
+}
+
+void SlidingMedian::fixHeapsBoundary() {
+    if (this->upperHeapSize == 0) {
+        return;
+    }
+
+    std::size_t lowerTop = this->lowerHeap[0];
+    std::size_t upperTop = this->upperHeap[0];
+
+    if (this->slotValue(lowerTop) > this->slotValue(upperTop)) {
+        // Only one value changed, so exchanging tops is enough to separate halves again.
+        this->placeInHeap(true, 0, upperTop);
+        this->placeInHeap(false, 0, lowerTop);
+        this->siftDown(true, 0);
+        this->siftDown(false, 0);
+    }
+}
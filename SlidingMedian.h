@@ -0,0 +1,89 @@
+/*
+ * SlidingMedian.h
+ *
+ * Median of last windowWidth values, updated in O(log windowWidth) per value.
+ *
+ * Values are kept in circular buffer and split between two heaps built over indexes of that
+ * buffer: max-heap with lower half of values and min-heap with upper half. Each buffer slot
+ * knows its heap and position inside it, so the oldest value can be overwritten with the newest
+ * one in place and only that single heap entry has to be moved. All storage is allocated once
+ * in constructor, equal values are handled like any other values.
+ */
+
+#ifndef SLIDINGMEDIAN_H_
+#define SLIDINGMEDIAN_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "SampleClock.h"
+
+class SlidingMedian {
+public:
+    // windowWidth - amount of values median is computed from (at least 1)
+    explicit SlidingMedian(unsigned int windowWidth);
+
+    /**
+     * Adds newest value to the window, oldest one is removed when window is full.
+     *
+     * params:
+     * timestamp - timestamp of value
+     * value - new value
+     */
+    void push(SampleTimestamp timestamp, double value);
+
+    // Removes all values from the window.
+    void clear();
+
+    // Checks if window holds windowWidth values already.
+    bool isFull() const;
+
+    // Returns median of values in the window (for even amount of values - mean of two middle ones).
+    // Valid only when window is not empty.
+    double getMedian() const;
+
+    // Returns timestamp of value from the middle of the window (valid only when window is full).
+    SampleTimestamp getCenterTimestamp() const;
+
+private:
+    // Circular buffer of values, nextIndex points at the oldest value once buffer is full.
+    std::vector<std::pair<SampleTimestamp, double>> window;
+    std::size_t nextIndex;
+    std::size_t valueCount;
+
+    // Heaps of window slot indexes. Lower heap is max-heap, upper heap is min-heap, lower heap
+    // holds the same amount of values as upper heap or one more.
+    std::vector<std::size_t> lowerHeap;
+    std::vector<std::size_t> upperHeap;
+    std::size_t lowerHeapSize;
+    std::size_t upperHeapSize;
+
+    // For every window slot - heap it belongs to and its position in that heap.
+    std::vector<char> slotInLowerHeap;
+    std::vector<std::size_t> slotHeapPosition;
+
+    double slotValue(std::size_t slot) const;
+
+    // Checks if first slot should be closer to the top of given heap than second one.
+    bool isHigherInHeap(bool lower, std::size_t firstSlot, std::size_t secondSlot) const;
+
+    // Puts slot at given position of heap and updates its position entry.
+    void placeInHeap(bool lower, std::size_t position, std::size_t slot);
+
+    // Restores heap order after value at given position changed, returns new position of that value.
+    std::size_t siftUp(bool lower, std::size_t position);
+    std::size_t siftDown(bool lower, std::size_t position);
+    void restoreHeapOrder(bool lower, std::size_t position);
+
+    // Adds slot to heap (window not full yet).
+    void insertSlot(std::size_t slot);
+
+    // Moves top value of one heap to the other one.
+    void moveTop(bool fromLower);
+
+    // Swaps tops of both heaps when lower heap top is bigger than upper heap top.
+    void fixHeapsBoundary();
+};
+
+#endif /* SLIDINGMEDIAN_H_ */
@@ -0,0 +1,167 @@
+/*
+ * SortingNetwork.h
+ *
+ * Sorting network for arrays of fixed size, generated at compile time.
+ *
+ * Comparators come from Batcher's merge exchange (Knuth, TAOCP vol. 3, 5.2.2 algorithm M),
+ * which works for any size. For median selection comparators which cannot affect the middle
+ * position are removed. Network is expanded into straight code of min/max pairs - no loops,
+ * no data dependent branches - so small arrays stay in registers. Many independent arrays can be
+ * processed together as lanes, then every comparator is a loop over lanes, which compiler turns
+ * into vector min/max instructions.
+ */
+
+#ifndef SORTINGNETWORK_H_
+#define SORTINGNETWORK_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Single compare-exchange - smaller value goes to position low, bigger one to position high.
+struct NetworkComparator {
+    std::size_t low;
+    std::size_t high;
+};
+
+// Comparators of a network, count first of them are used.
+template <std::size_t Size>
+struct NetworkLayout {
+    // Batcher's network for sizes used here takes far less than Size*Size comparators.
+    std::array<NetworkComparator, Size * Size + 1> comparators{};
+    std::size_t count = 0;
+};
+
+// Builds network sorting Size values in ascending order.
+template <std::size_t Size>
+constexpr NetworkLayout<Size> buildSortingLayout() {
+    NetworkLayout<Size> layout{};
+    if (Size < 2) {
+        return layout;
+    }
+
+    std::size_t t = 0;
+    while ((static_cast<std::size_t>(1) << t) < Size) {
+        ++t;
+    }
+
+    for (std::size_t p = static_cast<std::size_t>(1) << (t - 1); p > 0; p >>= 1) {
+        std::size_t q = static_cast<std::size_t>(1) << (t - 1);
+        std::size_t r = 0;
+        std::size_t d = p;
+
+        while (true) {
+            for (std::size_t i = 0; i + d < Size; ++i) {
+                if ((i & p) == r) {
+                    layout.comparators[layout.count++] = NetworkComparator{ i, i + d };
+                }
+            }
+            if (q == p) {
+                break;
+            }
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+    return layout;
+}
+
+// Builds network which puts median at position Size/2 (other positions are not sorted).
+template <std::size_t Size>
+constexpr NetworkLayout<Size> buildMedianLayout() {
+    NetworkLayout<Size> sortingLayout = buildSortingLayout<Size>();
+
+    // Going backwards from the output - comparator matters when it touches position that
+    // the middle value can still come from.
+    std::array<bool, Size> neededPositions{};
+    std::array<bool, Size * Size + 1> neededComparators{};
+    neededPositions[Size / 2] = true;
+
+    for (std::size_t i = sortingLayout.count; i > 0; --i) {
+        const NetworkComparator& comparator = sortingLayout.comparators[i - 1];
+        if (neededPositions[comparator.low] || neededPositions[comparator.high]) {
+            neededComparators[i - 1] = true;
+            neededPositions[comparator.low] = true;
+            neededPositions[comparator.high] = true;
+        }
+    }
+
+    NetworkLayout<Size> medianLayout{};
+    for (std::size_t i = 0; i < sortingLayout.count; ++i) {
+        if (neededComparators[i]) {
+            medianLayout.comparators[medianLayout.count++] = sortingLayout.comparators[i];
+        }
+    }
+    return medianLayout;
+}
+
+template <std::size_t Size>
+class SortingNetwork {
+public:
+    static constexpr NetworkLayout<Size> SORTING_LAYOUT = buildSortingLayout<Size>();
+    static constexpr NetworkLayout<Size> MEDIAN_LAYOUT = buildMedianLayout<Size>();
+
+    // Sorts values in ascending order.
+    static void sort(std::array<double, Size>& values) {
+        apply<false>(values, std::make_index_sequence<SORTING_LAYOUT.count>());
+    }
+
+    /**
+     * Finds median (for even size - the upper of two middle values).
+     * Values are reordered, only middle position holds its final value.
+     */
+    static double selectMedian(std::array<double, Size>& values) {
+        apply<true>(values, std::make_index_sequence<MEDIAN_LAYOUT.count>());
+        return values[Size / 2];
+    }
+
+    /**
+     * Finds medians of laneCount independent sets at once.
+     *
+     * params:
+     * rows - Size rows of laneCount values, lane (column) holds one set. Rows are reordered,
+     *        row Size/2 holds median of every lane afterwards.
+     * laneCount - amount of values in a row
+     */
+    static void selectMedianLanes(double* rows, std::size_t laneCount) {
+        applyLanes(rows, laneCount, std::make_index_sequence<MEDIAN_LAYOUT.count>());
+    }
+
+private:
+    template <std::size_t Low, std::size_t High>
+    static void compareExchange(std::array<double, Size>& values) {
+        // min/max compile to single instructions, comparison result never decides a jump.
+        double lowValue = std::min(values[Low], values[High]);
+        double highValue = std::max(values[Low], values[High]);
+        values[Low] = lowValue;
+        values[High] = highValue;
+    }
+
+    template <std::size_t Low, std::size_t High>
+    static void compareExchangeLanes(double* rows, std::size_t laneCount) {
+        double* lowRow = rows + Low * laneCount;
+        double* highRow = rows + High * laneCount;
+
+        for (std::size_t lane = 0; lane < laneCount; ++lane) {
+            double lowValue = std::min(lowRow[lane], highRow[lane]);
+            double highValue = std::max(lowRow[lane], highRow[lane]);
+            lowRow[lane] = lowValue;
+            highRow[lane] = highValue;
+        }
+    }
+
+    template <std::size_t... Indexes>
+    static void applyLanes(double* rows, std::size_t laneCount, std::index_sequence<Indexes...>) {
+        (compareExchangeLanes<MEDIAN_LAYOUT.comparators[Indexes].low, MEDIAN_LAYOUT.comparators[Indexes].high>(rows, laneCount), ...);
+    }
+
+    template <bool MedianOnly, std::size_t... Indexes>
+    static void apply(std::array<double, Size>& values, std::index_sequence<Indexes...>) {
+        constexpr const NetworkLayout<Size>& layout = MedianOnly ? MEDIAN_LAYOUT : SORTING_LAYOUT;
+        (compareExchange<layout.comparators[Indexes].low, layout.comparators[Indexes].high>(values), ...);
+    }
+};
+
+#endif /* SORTINGNETWORK_H_ */
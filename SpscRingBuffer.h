@@ -0,0 +1,143 @@
+/*
+ * SpscRingBuffer.h
+ *
+ * Bounded lock-free queue for exactly one producer thread and exactly one consumer thread.
+ * Capacity is rounded up to power of two. When queue is full new item is rejected and counted
+ * as dropped, queue also remembers the highest fill level it has ever reached, so overflows
+ * can be detected and queue can be sized properly.
+ */
+
+#ifndef SPSCRINGBUFFER_H_
+#define SPSCRINGBUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(std::size_t requestedCapacity)
+        :writeIndex(0)
+        ,cachedReadIndex(0)
+        ,readIndex(0)
+        ,cachedWriteIndex(0)
+        ,droppedCount(0)
+        ,highWaterMark(0) {
+        std::size_t capacity = 1;
+        while (capacity < requestedCapacity) {
+            capacity <<= 1;
+        }
+        this->slots.resize(capacity);
+        this->indexMask = capacity - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * Adds item at the end of the queue. Producer thread only.
+     *
+     * returns: true on success, false when queue is full (item is counted as dropped)
+     */
+    bool tryPush(T&& item) {
+        const std::size_t currentWrite = this->writeIndex.load(std::memory_order_relaxed);
+
+        if (currentWrite - this->cachedReadIndex > this->indexMask) {
+            // Queue looks full - refresh consumer position before giving up.
+            this->cachedReadIndex = this->readIndex.load(std::memory_order_acquire);
+            if (currentWrite - this->cachedReadIndex > this->indexMask) {
+                this->droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        this->slots[currentWrite & this->indexMask] = std::move(item);
+        this->writeIndex.store(currentWrite + 1, std::memory_order_release);
+
+        // Fill level is computed from current consumer position, cached one is refreshed only
+        // when queue looks full and would count items popped long ago.
+        this->cachedReadIndex = this->readIndex.load(std::memory_order_acquire);
+        const std::size_t fillLevel = currentWrite + 1 - this->cachedReadIndex;
+        if (fillLevel > this->highWaterMark.load(std::memory_order_relaxed)) {
+            this->highWaterMark.store(fillLevel, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * Takes first item from the queue. Consumer thread only.
+     *
+     * returns: true on success, false when queue is empty
+     */
+    bool tryPop(T& item) {
+        const std::size_t currentRead = this->readIndex.load(std::memory_order_relaxed);
+
+        if (currentRead == this->cachedWriteIndex) {
+            this->cachedWriteIndex = this->writeIndex.load(std::memory_order_acquire);
+            if (currentRead == this->cachedWriteIndex) {
+                return false;
+            }
+        }
+
+        item = std::move(this->slots[currentRead & this->indexMask]);
+        this->readIndex.store(currentRead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Checks if there is no space for next item. Producer thread only, nothing is counted as dropped.
+    bool full() {
+        const std::size_t currentWrite = this->writeIndex.load(std::memory_order_relaxed);
+
+        if (currentWrite - this->cachedReadIndex > this->indexMask) {
+            this->cachedReadIndex = this->readIndex.load(std::memory_order_acquire);
+        }
+        return currentWrite - this->cachedReadIndex > this->indexMask;
+    }
+
+    // Checks if queue is empty. Result is exact only when called from consumer thread.
+    bool empty() const {
+        return this->readIndex.load(std::memory_order_acquire) == this->writeIndex.load(std::memory_order_acquire);
+    }
+
+    // Returns approximate amount of queued items.
+    std::size_t size() const {
+        const std::size_t currentRead = this->readIndex.load(std::memory_order_acquire);
+        return this->writeIndex.load(std::memory_order_acquire) - currentRead;
+    }
+
+    std::size_t capacity() const {
+        return this->indexMask + 1;
+    }
+
+    // Returns amount of items rejected because queue was full.
+    std::uint64_t getDroppedCount() const {
+        return this->droppedCount.load(std::memory_order_relaxed);
+    }
+
+    // Returns the highest amount of items that were queued at once.
+    std::size_t getHighWaterMark() const {
+        return this->highWaterMark.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots;
+    std::size_t indexMask;
+
+    // Producer side - written only by producer, consumer position seen by the latest push
+    // (consumer cache line is only read, never written by producer).
+    alignas(64) std::atomic<std::size_t> writeIndex;
+    std::size_t cachedReadIndex;
+
+    // Consumer side.
+    alignas(64) std::atomic<std::size_t> readIndex;
+    std::size_t cachedWriteIndex;
+
+    // Statistics, updated by producer only.
+    alignas(64) std::atomic<std::uint64_t> droppedCount;
+    std::atomic<std::size_t> highWaterMark;
+};
+
+#endif /* SPSCRINGBUFFER_H_ */
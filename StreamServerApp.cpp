@@ -0,0 +1,66 @@
+/*
+ * StreamServerApp.cpp
+ *
+ * Serial to TCP gateway (Linux). Reads data from serial port, filters it with median
+ * and moving average filters and streams raw and filtered values to TCP clients.
+ * Metrics of the reader, analyzers and server are served in Prometheus format on localhost.
+ *
+ * Usage: StreamServerApp [serial port] [TCP port] [metrics port]
+ * Stop with Ctrl+C.
+ */
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+#include "Serial.h"
+#include "MedianFilter.h"
+#include "MetricsServer.h"
+#include "MovingAverageFilter.h"
+#include "TcpStreamServer.h"
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void handleStopSignal(int) {
+        stopRequested = 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string portName = (argc > 1) ? argv[1] : "/dev/ttyACM0";
+    unsigned short tcpPort = (argc > 2) ? static_cast<unsigned short>(std::atoi(argv[2])) : 5555;
+    unsigned short metricsPort = (argc > 3) ? static_cast<unsigned short>(std::atoi(argv[3])) : MetricsServer::DEFAULT_PORT;
+    unsigned int bufferSize = 10;
+    unsigned int filterWindow = 2;
+
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    // Port which is not available yet is opened by serial reader as soon as it appears.
+    std::shared_ptr<Serial> serialReader = std::make_shared<Serial>(portName, bufferSize);
+
+    // Server streams raw readings (source 0) and every value computed by filters (sources 1 and 2).
+    MedianFilter medianFilter(serialReader, filterWindow);
+    MovingAverageFilter movingAverageFilter(serialReader, filterWindow);
+    TcpStreamServer server(serialReader, tcpPort, { &medianFilter, &movingAverageFilter });
+
+    if (!server.isListening()) {
+        return 1;
+    }
+
+    // Metrics are optional - gateway works even when metrics port is taken.
+    MetricsServer metricsServer(metricsPort, { serialReader.get(), &server });
+
+    // Serial reader reconnects by itself after read errors, so gateway runs until it is stopped
+    // (connection state is reported by serial_connected metric).
+    while (!stopRequested) {
+        // Sleep is interrupted by stop signal, so shutdown is immediate.
+        sleep(1);
+    }
+
+    return 0;
+}
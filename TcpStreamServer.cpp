@@ -0,0 +1,465 @@
+/*
+ * TcpStreamServer.cpp
+ */
+
+#include "TcpStreamServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+    // Maximal amount of lines passed to a single writev() call.
+    const int MAX_LINES_PER_WRITE = 64;
+
+    // Maximal amount of epoll events handled in one loop iteration.
+    const int MAX_EVENTS = 256;
+}
+
+TcpStreamServer::TcpStreamServer(const std::shared_ptr<SampleSource>& serialReader, unsigned short port,
+                                 const std::vector<SerialPortDataAnalyzer*>& streamedAnalyzers,
+                                 std::size_t clientQueueLimit)
+    :SerialPortDataAnalyzer(serialReader)
+    ,rawResult(TimestampedValue{ INVALID_TIMESTAMP, 0 })
+    ,pendingLinesTime(INVALID_TIMESTAMP)
+    ,listenDescriptor(-1)
+    ,epollDescriptor(-1)
+    ,wakeupDescriptor(-1)
+    ,clientQueueLimit(clientQueueLimit > 0 ? clientQueueLimit : 1)
+    ,listenPort(port)
+    ,serverActive(false)
+    ,clientCount(0)
+    ,droppedLineCount(0)
+    ,publishedLineCount(0) {
+    if (this->openServerSocket(port)) {
+        this->serverActive = true;
+        this->eventLoopThreadPtr = std::make_unique<std::thread>([this] {this->runEventLoop(); });
+        std::cout << "TCP stream server listening on port " << port << std::endl;
+    }
+
+    for (std::size_t i = 0; i < streamedAnalyzers.size(); ++i) {
+        std::size_t source = i + 1;
+        SubscriptionId subscriptionId = streamedAnalyzers[i]->subscribe(
+            [this, source](const SerialSample* results, std::size_t count) {
+                this->publishSamples(results, count, source);
+            });
+        this->resultSubscriptions.emplace_back(streamedAnalyzers[i], subscriptionId);
+    }
+
+    if (this->registerToSerialReader(this) == false) {
+        std::cout << "Error: registering to serial reader failed." << std::endl;
+    }
+}
+
+TcpStreamServer::~TcpStreamServer() {
+    // Stop receiving new data and results first, then stop event loop.
+    for (std::pair<SerialPortDataAnalyzer*, SubscriptionId>& subscription : this->resultSubscriptions) {
+        subscription.first->unsubscribe(subscription.second);
+    }
+    this->deregisterFromSerialReader(this);
+
+    this->serverActive = false;
+    if (this->wakeupDescriptor != -1) {
+        std::uint64_t increment = 1;
+        ssize_t result = write(this->wakeupDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+
+    if (this->eventLoopThreadPtr) {
+        this->eventLoopThreadPtr->join();
+    }
+
+    for (auto& clientEntry : this->clients) {
+        close(clientEntry.first);
+    }
+    this->clients.clear();
+
+    if (this->listenDescriptor != -1) {
+        close(this->listenDescriptor);
+    }
+    if (this->wakeupDescriptor != -1) {
+        close(this->wakeupDescriptor);
+    }
+    if (this->epollDescriptor != -1) {
+        close(this->epollDescriptor);
+    }
+}
+
+bool TcpStreamServer::isListening() const {
+    return this->serverActive;
+}
+
+std::size_t TcpStreamServer::getClientCount() const {
+    return this->clientCount;
+}
+
+std::uint64_t TcpStreamServer::getDroppedLineCount() const {
+    return this->droppedLineCount;
+}
+
+const LatencyHistogram& TcpStreamServer::getSendLatency() const {
+    return this->sendLatency;
+}
+
+void TcpStreamServer::collectMetrics(MetricsWriter& writer) {
+    std::string labels = MetricsWriter::label("tcp_port", std::to_string(this->listenPort));
+
+    writer.addGauge("tcp_stream_clients", "Connected TCP clients.", labels, static_cast<double>(this->getClientCount()));
+    writer.addCounter("tcp_stream_lines_total", "Lines produced for TCP clients.", labels,
+                      this->publishedLineCount.load(std::memory_order_relaxed));
+    writer.addCounter("tcp_stream_dropped_lines_total", "Lines dropped because of slow clients.", labels,
+                      this->getDroppedLineCount());
+    writer.addHistogram("tcp_stream_analyzer_to_send_seconds",
+                        "Time from getting readings until their lines were passed to client sockets.", labels,
+                        this->sendLatency);
+}
+
+std::pair<SampleTimestamp, double> TcpStreamServer::getRawData() {
+    TimestampedValue result = this->rawResult.load();
+
+    return std::pair<SampleTimestamp, double>{ result.timestamp, result.value };
+}
+
+std::pair<SampleTimestamp, double> TcpStreamServer::getProcessedData() {
+    return this->getRawData();
+}
+
+void TcpStreamServer::fetchNewData(const SerialSample& sample) {
+    this->fetchNewBatch(&sample, 1);
+}
+
+void TcpStreamServer::fetchNewBatch(const SerialSample* samples, std::size_t count) {
+    this->publishSamples(samples, count, 0);
+
+    // Raw value reflects the last reading of the block.
+    const SerialSample& lastSample = samples[count - 1];
+    if (lastSample.status != SampleStatus::VALUE) {
+        this->rawResult.store(TimestampedValue{ INVALID_TIMESTAMP, 0 });
+    }
+    else {
+        this->rawResult.store(TimestampedValue{ lastSample.timestamp, lastSample.value });
+    }
+}
+
+void TcpStreamServer::publishSamples(const SerialSample* samples, std::size_t count, std::size_t source) {
+    std::vector<std::shared_ptr<const std::string>> lines;
+    lines.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        // Status readings are streamed once, from serial reader - analyzers only pass them on.
+        if (source != 0 && samples[i].status != SampleStatus::VALUE) {
+            continue;
+        }
+        lines.push_back(this->formatLine(samples[i], source));
+    }
+
+    this->publishLines(lines);
+}
+
+std::shared_ptr<const std::string> TcpStreamServer::formatLine(const SerialSample& sample, std::size_t source) const {
+    char lineBuffer[96];
+
+    if (sample.status != SampleStatus::VALUE) {
+        std::snprintf(lineBuffer, sizeof(lineBuffer), "%u,-1,%s\n", static_cast<unsigned int>(sample.portId),
+                      sampleStatusName(sample.status));
+    }
+    else {
+        std::snprintf(lineBuffer, sizeof(lineBuffer), "%u,%lld,%zu,%.6f\n", static_cast<unsigned int>(sample.portId),
+                      static_cast<long long>(SampleClock::toWallClockNanoseconds(sample.timestamp)), source,
+                      sample.value);
+    }
+
+    return std::make_shared<const std::string>(lineBuffer);
+}
+
+void TcpStreamServer::publishLines(std::vector<std::shared_ptr<const std::string>>& lines) {
+    if (!this->serverActive || lines.empty()) {
+        return;
+    }
+
+    this->publishedLineCount.fetch_add(lines.size(), std::memory_order_relaxed);
+
+    bool wakeupNeeded;
+    {
+        std::scoped_lock pendingLock(this->pendingLinesMutex);
+        // Event loop is woken up only once for the whole batch of lines it has not taken yet.
+        wakeupNeeded = this->pendingLines.empty();
+        if (wakeupNeeded) {
+            this->pendingLinesTime = SampleClock::now();
+        }
+        std::move(lines.begin(), lines.end(), std::back_inserter(this->pendingLines));
+    }
+
+    if (wakeupNeeded) {
+        std::uint64_t increment = 1;
+        ssize_t result = write(this->wakeupDescriptor, &increment, sizeof(increment));
+        (void) result;
+    }
+}
+
+bool TcpStreamServer::openServerSocket(unsigned short port) {
+    this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    this->wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    this->listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (this->epollDescriptor == -1 || this->wakeupDescriptor == -1 || this->listenDescriptor == -1) {
+        std::cout << "ERROR: could not create TCP server resources." << std::endl;
+        return false;
+    }
+
+    int reuseAddress = 1;
+    setsockopt(this->listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(this->listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+            || listen(this->listenDescriptor, SOMAXCONN) == -1) {
+        std::cout << "ERROR: could not listen on TCP port " << port << "." << std::endl;
+        return false;
+    }
+
+    epoll_event listenEvent = {};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = this->listenDescriptor;
+    epoll_event wakeupEvent = {};
+    wakeupEvent.events = EPOLLIN;
+    wakeupEvent.data.fd = this->wakeupDescriptor;
+
+    if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->listenDescriptor, &listenEvent) == -1
+            || epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->wakeupDescriptor, &wakeupEvent) == -1) {
+        std::cout << "ERROR: could not create TCP server event loop." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void TcpStreamServer::runEventLoop() {
+    epoll_event events[MAX_EVENTS];
+
+    while (this->serverActive) {
+        int eventCount = epoll_wait(this->epollDescriptor, events, MAX_EVENTS, -1);
+
+        if (eventCount == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "ERROR: TCP server event loop failed." << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < eventCount; ++i) {
+            int descriptor = events[i].data.fd;
+
+            if (descriptor == this->listenDescriptor) {
+                this->acceptClients();
+            }
+            else if (descriptor == this->wakeupDescriptor) {
+                std::uint64_t counter;
+                while (read(this->wakeupDescriptor, &counter, sizeof(counter)) > 0) {
+                    // Drain all pending wake ups.
+                }
+                this->distributePendingLines();
+            }
+            else {
+                auto clientIterator = this->clients.find(descriptor);
+                if (clientIterator == this->clients.end()) {
+                    continue;
+                }
+
+                bool keepClient = true;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    keepClient = false;
+                }
+                if (keepClient && (events[i].events & EPOLLIN)) {
+                    keepClient = this->drainClientInput(descriptor);
+                }
+                if (keepClient && (events[i].events & EPOLLOUT)) {
+                    keepClient = this->flushClient(descriptor, clientIterator->second);
+                }
+
+                if (!keepClient) {
+                    this->disconnectClient(descriptor);
+                }
+            }
+        }
+    }
+}
+
+void TcpStreamServer::acceptClients() {
+    while (true) {
+        int clientDescriptor = accept4(this->listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientDescriptor == -1) {
+            // EAGAIN means that all pending connections were accepted, other errors concern only that client.
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+
+        int noDelay = 1;
+        setsockopt(clientDescriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        epoll_event clientEvent = {};
+        clientEvent.events = EPOLLIN;
+        clientEvent.data.fd = clientDescriptor;
+        if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, clientDescriptor, &clientEvent) == -1) {
+            close(clientDescriptor);
+            continue;
+        }
+
+        this->clients.emplace(clientDescriptor, ClientConnection());
+        this->clientCount = this->clients.size();
+    }
+}
+
+void TcpStreamServer::distributePendingLines() {
+    std::vector<std::shared_ptr<const std::string>> newLines;
+    SampleTimestamp newLinesTime;
+    {
+        std::scoped_lock pendingLock(this->pendingLinesMutex);
+        newLines.swap(this->pendingLines);
+        newLinesTime = this->pendingLinesTime;
+    }
+
+    if (newLines.empty()) {
+        return;
+    }
+
+    std::vector<int> failedClients;
+
+    for (auto& clientEntry : this->clients) {
+        ClientConnection& client = clientEntry.second;
+
+        for (const std::shared_ptr<const std::string>& line : newLines) {
+            client.sendQueue.push_back(line);
+        }
+
+        // Drop oldest lines of a slow client. Line which is partially sent cannot be dropped,
+        // otherwise client would receive a broken line.
+        while (client.sendQueue.size() > this->clientQueueLimit) {
+            if (client.sentBytesOfFront > 0) {
+                client.sendQueue.erase(client.sendQueue.begin() + 1);
+            }
+            else {
+                client.sendQueue.pop_front();
+            }
+            ++this->droppedLineCount;
+        }
+
+        // Client which waits for EPOLLOUT will be flushed when its socket becomes writable.
+        if (!client.waitingForWritable && !this->flushClient(clientEntry.first, client)) {
+            failedClients.push_back(clientEntry.first);
+        }
+    }
+
+    for (int clientDescriptor : failedClients) {
+        this->disconnectClient(clientDescriptor);
+    }
+
+    if (!this->clients.empty()) {
+        this->sendLatency.recordSince(newLinesTime);
+    }
+}
+
+bool TcpStreamServer::flushClient(int clientDescriptor, ClientConnection& client) {
+    while (!client.sendQueue.empty()) {
+        iovec lineVectors[MAX_LINES_PER_WRITE];
+        int vectorCount = 0;
+
+        for (const std::shared_ptr<const std::string>& line : client.sendQueue) {
+            if (vectorCount == MAX_LINES_PER_WRITE) {
+                break;
+            }
+            std::size_t offset = (vectorCount == 0) ? client.sentBytesOfFront : 0;
+            lineVectors[vectorCount].iov_base = const_cast<char*>(line->data() + offset);
+            lineVectors[vectorCount].iov_len = line->size() - offset;
+            ++vectorCount;
+        }
+
+        msghdr message = {};
+        message.msg_iov = lineVectors;
+        message.msg_iovlen = vectorCount;
+
+        ssize_t bytesSent = sendmsg(clientDescriptor, &message, MSG_NOSIGNAL);
+
+        if (bytesSent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+
+        // Remove lines which were sent completely.
+        std::size_t remainingBytes = static_cast<std::size_t>(bytesSent);
+        while (remainingBytes > 0) {
+            std::size_t frontBytesLeft = client.sendQueue.front()->size() - client.sentBytesOfFront;
+            if (remainingBytes >= frontBytesLeft) {
+                remainingBytes -= frontBytesLeft;
+                client.sendQueue.pop_front();
+                client.sentBytesOfFront = 0;
+            }
+            else {
+                client.sentBytesOfFront += remainingBytes;
+                remainingBytes = 0;
+            }
+        }
+    }
+
+    // Watch for writability only while there is something left to send.
+    bool writableWatchNeeded = !client.sendQueue.empty();
+    if (writableWatchNeeded != client.waitingForWritable) {
+        epoll_event clientEvent = {};
+        clientEvent.events = writableWatchNeeded ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        clientEvent.data.fd = clientDescriptor;
+        if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_MOD, clientDescriptor, &clientEvent) == -1) {
+            return false;
+        }
+        client.waitingForWritable = writableWatchNeeded;
+    }
+
+    return true;
+}
+
+bool TcpStreamServer::drainClientInput(int clientDescriptor) {
+    char discardBuffer[512];
+
+    while (true) {
+        ssize_t bytesRead = read(clientDescriptor, discardBuffer, sizeof(discardBuffer));
+        if (bytesRead > 0) {
+            continue;
+        }
+        if (bytesRead == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+void TcpStreamServer::disconnectClient(int clientDescriptor) {
+    epoll_ctl(this->epollDescriptor, EPOLL_CTL_DEL, clientDescriptor, nullptr);
+    close(clientDescriptor);
+    this->clients.erase(clientDescriptor);
+    this->clientCount = this->clients.size();
+}
@@ -0,0 +1,192 @@
+/*
+ * TcpStreamServer.h
+ *
+ * TcpStreamServer streams readings from serial port to any number of TCP clients (Linux only).
+ *
+ * Server is registered to serial reader like any other analyzer and subscribed to results of streamed
+ * analyzers. Every reading and every computed result is formatted once into a text line:
+ *     <port id>,<timestamp>,<source>,<value>\n
+ * where port id identifies port of SerialPortManager (0 for standalone serial reader), timestamp
+ * is capture time in nanoseconds since Unix epoch (for results - time of the reading they were computed
+ * from) and source is 0 for raw reading or number of streamed analyzer (starting from 1),
+ * or "<port id>,-1,<status>\n" when serial reader reports state of the port (error, reconnection,
+ * closing etc.),
+ * and handed over to event loop thread, which sends it to all connected clients.
+ * Lines of raw readings and of results are produced by different threads, so they can interleave
+ * in any order - timestamps tell which reading a result belongs to.
+ *
+ * Each client has its own bounded send queue - when client does not keep up, oldest queued lines
+ * are dropped for that client only. Neither serial reader thread nor other clients ever wait for it.
+ *
+ * Server measures time from getting readings until their lines are handed to client sockets
+ * (see collectMetrics()).
+ */
+
+#ifndef TCPSTREAMSERVER_H_
+#define TCPSTREAMSERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "MetricsWriter.h"
+#include "SeqLock.h"
+#include "SerialPortDataAnalyzer.h"
+
+class TcpStreamServer: public SerialPortDataAnalyzer, public MetricsProvider {
+public:
+
+    /**
+     * Creates server listening on given TCP port and registers it to serial reader.
+     *
+     * params:
+     * serialReader - serial reader object or other source of readings (see SampleSource)
+     * port - TCP port server listens on (all interfaces)
+     * streamedAnalyzers - analyzers whose processed values are sent as separate lines, every value they compute
+     *                     is sent (server subscribes to their results). Analyzers must outlive the server.
+     * clientQueueLimit - maximal amount of lines waiting for a single client, oldest ones are dropped above it
+     */
+    TcpStreamServer(const std::shared_ptr<SampleSource>& serialReader, unsigned short port,
+                    const std::vector<SerialPortDataAnalyzer*>& streamedAnalyzers = {},
+                    std::size_t clientQueueLimit = 1024);
+
+    virtual ~TcpStreamServer();
+
+    // Checks if server socket is open and event loop is running.
+    bool isListening() const;
+
+    // Returns amount of currently connected clients.
+    std::size_t getClientCount() const;
+
+    // Returns total amount of lines dropped because of slow clients.
+    std::uint64_t getDroppedLineCount() const;
+
+    // Returns histogram of time from getting readings until their lines were sent to connected clients.
+    const LatencyHistogram& getSendLatency() const;
+
+    // Adds client gauge, line counters and send latency histogram, labelled with TCP port.
+    virtual void collectMetrics(MetricsWriter& writer);
+
+    /**
+     *  Get latest read from serial port with timestamp.
+     *  returns: latest raw data with timestamp or (-1,0) when any data have not been received yet,
+     *  or error occured.
+     */
+    virtual std::pair<SampleTimestamp, double> getRawData();
+
+    /**
+     *  Server does not process data, so it returns the same value as getRawData().
+     */
+    virtual std::pair<SampleTimestamp, double> getProcessedData();
+
+private:
+
+    // State of a single connected client.
+    struct ClientConnection {
+        // Lines waiting to be sent, shared between all clients.
+        std::deque<std::shared_ptr<const std::string>> sendQueue;
+        // Amount of bytes of first queued line that were already sent.
+        std::size_t sentBytesOfFront = 0;
+        // True when client socket is watched for EPOLLOUT (kernel buffer was full).
+        bool waitingForWritable = false;
+    };
+
+    // Streamed analyzers with ids of subscriptions to their results, in order of source numbers.
+    std::vector<std::pair<SerialPortDataAnalyzer*, SubscriptionId>> resultSubscriptions;
+
+    // Latest raw value ({-1,0} after status reading), read by getRawData() without locking
+    SeqLock<TimestampedValue> rawResult;
+
+    // Lines produced by fetchNewData() that were not taken by event loop yet.
+    std::vector<std::shared_ptr<const std::string>> pendingLines;
+
+    // Time the oldest of pendingLines was produced, protected by pendingLinesMutex.
+    SampleTimestamp pendingLinesTime;
+
+    // Mutex protecting pendingLines - it is held only for a push or a swap.
+    std::mutex pendingLinesMutex;
+
+    // Listening socket, epoll instance and eventfd used to wake up event loop.
+    int listenDescriptor;
+    int epollDescriptor;
+    int wakeupDescriptor;
+
+    // Connected clients, accessed only from event loop thread.
+    std::unordered_map<int, ClientConnection> clients;
+
+    std::size_t clientQueueLimit;
+
+    // Port server listens on, used as metrics label.
+    unsigned short listenPort;
+
+    std::atomic<bool> serverActive;
+    std::atomic<std::size_t> clientCount;
+    std::atomic<std::uint64_t> droppedLineCount;
+    std::atomic<std::uint64_t> publishedLineCount;
+
+    // Time from fetchNewBatch() until lines were passed to sockets of all clients
+    // which were not waiting for free space (once per distribution of lines).
+    LatencyHistogram sendLatency;
+
+    // Ptr to thread running event loop
+    std::unique_ptr<std::thread> eventLoopThreadPtr;
+
+    /**
+     * Method used by Serial object to send latest data to analyzer.
+     *
+     * param: sample - freshly received sample from serial port reader.
+     */
+    virtual void fetchNewData(const SerialSample& sample);
+
+    /**
+     * Method used by Serial object to send block of readings, lines for the whole block
+     * are queued at once with a single wake up of event loop.
+     */
+    virtual void fetchNewBatch(const SerialSample* samples, std::size_t count);
+
+    /**
+     * Formats lines for block of readings or results and queues them for clients.
+     *
+     * params:
+     * samples - readings or results in order of arrival
+     * count - amount of samples
+     * source - 0 for readings, number of streamed analyzer for its results
+     */
+    void publishSamples(const SerialSample* samples, std::size_t count, std::size_t source);
+
+    // Creates line sent to clients for a single reading or result.
+    std::shared_ptr<const std::string> formatLine(const SerialSample& sample, std::size_t source) const;
+
+    // Queues lines (moved out of the vector) for all clients and wakes up event loop.
+    void publishLines(std::vector<std::shared_ptr<const std::string>>& lines);
+
+    // Creates listening socket and epoll instance. returns: true on success
+    bool openServerSocket(unsigned short port);
+
+    // Serves clients until server is stopped.
+    void runEventLoop();
+
+    // Accepts all pending connections.
+    void acceptClients();
+
+    // Moves pending lines to send queues of all clients.
+    void distributePendingLines();
+
+    // Sends as much of client's queue as socket accepts. returns: false when client should be disconnected
+    bool flushClient(int clientDescriptor, ClientConnection& client);
+
+    // Reads and discards everything client sent. returns: false when client closed connection
+    bool drainClientInput(int clientDescriptor);
+
+    void disconnectClient(int clientDescriptor);
+};
+
+#endif /* TCPSTREAMSERVER_H_ */
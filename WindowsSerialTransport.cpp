@@ -0,0 +1,246 @@
+/*
+ * WindowsSerialTransport.cpp
+ */
+
+#include "WindowsSerialTransport.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Single wait slice - interrupt() is noticed at most after that time.
+    const DWORD WAIT_SLICE_MS = 100;
+}
+
+WindowsSerialTransport::WindowsSerialTransport()
+    :hSerial(INVALID_HANDLE_VALUE)
+    ,status()
+    ,errors(0)
+    ,peekedByte(0)
+    ,byteWasPeeked(false)
+    ,interruptRequested(false) {
+}
+
+WindowsSerialTransport::~WindowsSerialTransport() {
+    this->close();
+}
+
+bool WindowsSerialTransport::open(const std::string& portDesc, const SerialPortSettings& settings) {
+    this->close();
+    this->settings = settings;
+
+    //Try to connect to the given port through CreateFile
+    this->hSerial = CreateFile(portDesc.c_str(),
+            GENERIC_READ,
+            0,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL);
+
+    //Check if the connection was successfull
+    if(this->hSerial==INVALID_HANDLE_VALUE) {
+        //If not success full display an Error
+        if(GetLastError()==ERROR_FILE_NOT_FOUND) {
+
+            //Print Error if neccessary
+            std::cout << "ERROR: Handle was not attached. Reason: "<< portDesc.c_str() << " not available." << std::endl;
+
+        }
+        else {
+            std::cout << "ERROR!!!" << std::endl;
+        }
+        return false;
+    }
+
+    //If connected we try to set the comm parameters
+    DCB dcbSerialParams = {0};
+
+    //Try to get the current
+    if (!GetCommState(this->hSerial, &dcbSerialParams)) {
+        //If impossible, show an error
+        std::cout <<  "failed to get current serial parameters!" << std::endl;
+        this->close();
+        return false;
+    }
+
+    //Define serial connection parameters, any baud rate supported by the driver can be used
+    dcbSerialParams.BaudRate = settings.baudRate;
+    dcbSerialParams.ByteSize = static_cast<BYTE>(settings.dataBits);
+    dcbSerialParams.StopBits = (settings.stopBits == SerialPortSettings::StopBits::TWO) ? TWOSTOPBITS : ONESTOPBIT;
+
+    switch (settings.parity) {
+    case SerialPortSettings::Parity::ODD:
+        dcbSerialParams.Parity = ODDPARITY;
+        break;
+    case SerialPortSettings::Parity::EVEN:
+        dcbSerialParams.Parity = EVENPARITY;
+        break;
+    default:
+        dcbSerialParams.Parity = NOPARITY;
+        break;
+    }
+    dcbSerialParams.fParity = (settings.parity != SerialPortSettings::Parity::NONE) ? TRUE : FALSE;
+
+    bool hardwareFlowControl = (settings.flowControl == SerialPortSettings::FlowControl::HARDWARE);
+    bool softwareFlowControl = (settings.flowControl == SerialPortSettings::FlowControl::SOFTWARE);
+    dcbSerialParams.fOutxCtsFlow = hardwareFlowControl ? TRUE : FALSE;
+    dcbSerialParams.fRtsControl = hardwareFlowControl ? RTS_CONTROL_HANDSHAKE : RTS_CONTROL_ENABLE;
+    dcbSerialParams.fOutX = softwareFlowControl ? TRUE : FALSE;
+    dcbSerialParams.fInX = softwareFlowControl ? TRUE : FALSE;
+
+    //Setting the DTR to Control_Enable ensures that the Arduino is properly
+    //reset upon establishing a connection
+    dcbSerialParams.fDtrControl = settings.dtrEnabled ? DTR_CONTROL_ENABLE : DTR_CONTROL_DISABLE;
+
+    // Driver buffers - only a recommendation, driver may keep its own sizes.
+    if (settings.receiveBufferSize > 0 || settings.transmitBufferSize > 0) {
+        SetupComm(this->hSerial, static_cast<DWORD>(settings.receiveBufferSize),
+                  static_cast<DWORD>(settings.transmitBufferSize));
+    }
+
+    //Set the parameters and check for their proper application
+    if(!SetCommState(hSerial, &dcbSerialParams)) {
+        std::cout << "ALERT: Could not set Serial Port parameters" << std::endl;
+        this->close();
+        return false;
+    }
+
+    // ReadFile returns immediately with whatever is buffered, or waits at most
+    // WAIT_SLICE_MS for the first byte when buffer is empty.
+    COMMTIMEOUTS timeouts = {0};
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = WAIT_SLICE_MS;
+    SetCommTimeouts(this->hSerial, &timeouts);
+
+    //Flush any remaining characters in the buffers
+    PurgeComm(this->hSerial, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+    return true;
+}
+
+void WindowsSerialTransport::close() {
+    //Check if we are connected before trying to disconnect
+    if (this->hSerial != INVALID_HANDLE_VALUE) {
+        //Close the serial handler
+        CloseHandle(this->hSerial);
+        this->hSerial = INVALID_HANDLE_VALUE;
+    }
+    this->byteWasPeeked = false;
+}
+
+bool WindowsSerialTransport::isOpen() const {
+    return this->hSerial != INVALID_HANDLE_VALUE;
+}
+
+SerialTransport::WaitResult WindowsSerialTransport::waitForData(int timeoutMs) {
+    if (this->hSerial == INVALID_HANDLE_VALUE) {
+        return WaitResult::FAILURE;
+    }
+
+    ULONGLONG startTime = GetTickCount64();
+
+    while (true) {
+        if (this->interruptRequested.exchange(false)) {
+            return WaitResult::INTERRUPTED;
+        }
+
+        if (this->byteWasPeeked) {
+            return WaitResult::DATA_AVAILABLE;
+        }
+
+        //Use the ClearCommError function to get status info on the Serial port
+        if (!ClearCommError(this->hSerial, &this->errors, &this->status)) {
+            return WaitResult::FAILURE;
+        }
+        if (this->status.cbInQue > 0) {
+            return this->waitForBurst() ? WaitResult::DATA_AVAILABLE : WaitResult::INTERRUPTED;
+        }
+
+        // Nothing buffered - block for a single slice waiting for the first byte.
+        DWORD bytesRead = 0;
+        if (!ReadFile(this->hSerial, &this->peekedByte, 1, &bytesRead, NULL)) {
+            return WaitResult::FAILURE;
+        }
+        if (bytesRead == 1) {
+            this->byteWasPeeked = true;
+            return this->waitForBurst() ? WaitResult::DATA_AVAILABLE : WaitResult::INTERRUPTED;
+        }
+
+        if (timeoutMs >= 0 && GetTickCount64() - startTime >= static_cast<ULONGLONG>(timeoutMs)) {
+            return WaitResult::TIMEOUT;
+        }
+    }
+}
+
+long WindowsSerialTransport::readAvailable(char* buffer, std::size_t capacity) {
+    if (this->hSerial == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    if (capacity == 0) {
+        return 0;
+    }
+
+    std::size_t totalRead = 0;
+
+    if (this->byteWasPeeked) {
+        buffer[totalRead++] = this->peekedByte;
+        this->byteWasPeeked = false;
+    }
+
+    if (!ClearCommError(this->hSerial, &this->errors, &this->status)) {
+        return (totalRead > 0) ? static_cast<long>(totalRead) : -1;
+    }
+
+    DWORD bytesToRead = static_cast<DWORD>(std::min<std::size_t>(this->status.cbInQue, capacity - totalRead));
+    if (bytesToRead > 0) {
+        DWORD bytesRead = 0;
+        if (!ReadFile(this->hSerial, buffer + totalRead, bytesToRead, &bytesRead, NULL)) {
+            return (totalRead > 0) ? static_cast<long>(totalRead) : -1;
+        }
+        totalRead += bytesRead;
+    }
+
+    return static_cast<long>(totalRead);
+}
+
+bool WindowsSerialTransport::waitForBurst() {
+    if (this->settings.minimumReadBytes <= 1 || this->settings.interByteTimeoutMs <= 0) {
+        return true;
+    }
+
+    DWORD bufferedBytes = 0;
+    ULONGLONG lastArrival = GetTickCount64();
+
+    while (true) {
+        if (!ClearCommError(this->hSerial, &this->errors, &this->status)) {
+            // Let readAvailable() find out what is wrong.
+            return true;
+        }
+
+        DWORD currentBytes = this->status.cbInQue + (this->byteWasPeeked ? 1 : 0);
+        if (currentBytes >= this->settings.minimumReadBytes) {
+            return true;
+        }
+
+        ULONGLONG now = GetTickCount64();
+        if (currentBytes != bufferedBytes) {
+            // Inter-byte timer restarts with every new byte.
+            bufferedBytes = currentBytes;
+            lastArrival = now;
+        }
+        else if (now - lastArrival >= static_cast<ULONGLONG>(this->settings.interByteTimeoutMs)) {
+            return true;
+        }
+
+        if (this->interruptRequested.exchange(false)) {
+            return false;
+        }
+        Sleep(1);
+    }
+}
+
+void WindowsSerialTransport::interrupt() {
+    this->interruptRequested = true;
+}
@@ -0,0 +1,63 @@
+/*
+ * WindowsSerialTransport.h
+ *
+ *  Based on existing example of serial port communication from:
+ * https://playground.arduino.cc/Interfacing/CPPWindows/
+ *
+ * Serial port transport for Windows based on Win32 communication API.
+ */
+
+#ifndef WINDOWSSERIALTRANSPORT_H_
+#define WINDOWSSERIALTRANSPORT_H_
+
+#include <atomic>
+#include <windows.h>
+
+#include "SerialTransport.h"
+
+class WindowsSerialTransport: public SerialTransport {
+public:
+    WindowsSerialTransport();
+
+    virtual ~WindowsSerialTransport();
+
+    virtual bool open(const std::string& portDesc, const SerialPortSettings& settings);
+
+    virtual void close();
+
+    virtual bool isOpen() const;
+
+    virtual WaitResult waitForData(int timeoutMs);
+
+    virtual long readAvailable(char* buffer, std::size_t capacity);
+
+    virtual void interrupt();
+
+private:
+    // Serial comm handler
+    HANDLE hSerial;
+
+    // Get various information about the connection
+    COMSTAT status;
+
+    // Keep track of last error
+    DWORD errors;
+
+    // Byte received while waiting for data, it is returned by next readAvailable() call.
+    char peekedByte;
+    bool byteWasPeeked;
+
+    // Set by interrupt(), checked after every wait slice.
+    std::atomic<bool> interruptRequested;
+
+    // Settings given to the latest open() call.
+    SerialPortSettings settings;
+
+    /**
+     * Waits until minimumReadBytes are buffered or no byte arrives for interByteTimeoutMs.
+     * returns: false when wait was interrupted
+     */
+    bool waitForBurst();
+};
+
+#endif /* WINDOWSSERIALTRANSPORT_H_ */
@@ -0,0 +1,474 @@
+/*
+ * AnalyzerBenchmarks.cpp
+ *
+ * Google Benchmark suite for the hot paths of reading and filtering:
+ * - SlidingMedian / SlidingAverage - general window kernels, for different window sizes,
+ * - FilterKernel - kernels picked by MedianFilter / MovingAverageFilter (specialized at compile
+ *   time for common widths, general ones otherwise) run for every reading,
+ * - MedianFilter / MovingAverageFilter - whole analyzer (dispatcher queue, fetchNewBatch(),
+ *   window update, publishing result) for different window sizes,
+ * - MultiChannelFilter - all channels of multi-channel device filtered by a single analyzer,
+ * - FrameParser / SerialFramer - parsing of every supported message format (multi-channel too),
+ * - AnalyzerDispatcher - delivery of readings to fetchNewData() / fetchNewBatch() of many analyzers,
+ * - LatencyHistogram - cost of recording a latency (from one thread and from many at once),
+ * - Serial - latency from writing a message to pseudo-terminal until all analyzers got it (Linux only).
+ *
+ * Results can be saved as JSON and compared between releases (tools/compare.py of Google Benchmark):
+ *   AnalyzerBenchmarks --benchmark_out=results.json --benchmark_out_format=json
+ * or printed as JSON only:
+ *   AnalyzerBenchmarks --benchmark_format=json
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "AnalyzerDispatcher.h"
+#include "FilterKernel.h"
+#include "FrameParser.h"
+#include "LatencyHistogram.h"
+#include "MedianFilter.h"
+#include "MovingAverageFilter.h"
+#include "MultiChannelFilter.h"
+#include "SampleSource.h"
+#include "SerialFramer.h"
+#include "SerialPortDataAnalyzer.h"
+#include "SerialSample.h"
+#include "SlidingAverage.h"
+#include "SlidingMedian.h"
+
+#ifdef __linux__
+#include "PseudoTerminal.h"
+#include "Serial.h"
+#endif
+
+namespace {
+    const unsigned int FRAME_WIDTH = 10;
+
+    // Amount of readings processed by single iteration of analyzer benchmarks.
+    const std::size_t BLOCK_SAMPLES = 4096;
+
+    // Size of data parsed by single iteration of parsing benchmarks.
+    const std::size_t PARSED_FRAMES = 4096;
+
+    // Values like the ones sent by the generator (sine wave with noise).
+    std::vector<SerialSample> makeSamples(std::size_t count) {
+        std::vector<SerialSample> samples;
+        samples.reserve(count);
+
+        std::uint32_t noise = 12345;
+        for (std::size_t i = 0; i < count; ++i) {
+            noise = noise * 1103515245u + 12345u;
+            double value = 1000.0 * std::sin(static_cast<double>(i) / 50.0) + static_cast<double>(noise >> 22) - 512.0;
+            samples.push_back(SerialSample{ static_cast<SampleTimestamp>(i) * 1000, value, SampleStatus::VALUE, 0 });
+        }
+        return samples;
+    }
+
+    // Readings of multi-channel device - messageCount messages, channels of a message share timestamp.
+    std::vector<SerialSample> makeChannelSamples(std::size_t messageCount, std::size_t channelCount) {
+        std::vector<SerialSample> values = makeSamples(messageCount * channelCount);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i].timestamp = static_cast<SampleTimestamp>(i / channelCount) * 1000;
+            values[i].channel = static_cast<std::uint16_t>(i % channelCount);
+        }
+        return values;
+    }
+
+    std::string formatValue(std::size_t i) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(i % 2000) - 1000.0);
+        return text;
+    }
+
+    std::string makeFixedWidthData() {
+        std::string data;
+        char frame[FRAME_WIDTH + 1];
+
+        for (std::size_t i = 0; i < PARSED_FRAMES; ++i) {
+            std::snprintf(frame, sizeof(frame), "%-10.3f", static_cast<double>(i % 2000) - 1000.0);
+            data.append(frame, FRAME_WIDTH);
+        }
+        return data;
+    }
+
+    std::string makeDelimitedData() {
+        std::string data;
+        for (std::size_t i = 0; i < PARSED_FRAMES; ++i) {
+            data += formatValue(i);
+            data += '\n';
+        }
+        return data;
+    }
+
+    std::string makeLengthPrefixedData() {
+        std::string data;
+        for (std::size_t i = 0; i < PARSED_FRAMES; ++i) {
+            std::string value = formatValue(i);
+            data += static_cast<char>(value.size());
+            data += value;
+        }
+        return data;
+    }
+
+    // PARSED_FRAMES values in messages of channelCount values separated by commas.
+    std::string makeMultiChannelData(std::size_t channelCount) {
+        std::string data;
+        for (std::size_t i = 0; i < PARSED_FRAMES; ++i) {
+            data += formatValue(i);
+            data += ((i + 1) % channelCount == 0) ? '\n' : ',';
+        }
+        return data;
+    }
+
+    // Source of readings pushed by benchmark itself - analyzers are run by dispatcher exactly
+    // like when registered to Serial, without any device involved.
+    class BenchmarkSource: public SampleSource {
+    public:
+        explicit BenchmarkSource(std::size_t dispatchThreads)
+            :analyzerDispatcher(dispatchThreads) {
+        }
+
+        virtual SerialSample getData() {
+            return SerialSample{ INVALID_TIMESTAMP, 0, SampleStatus::INITIALIZING, 0 };
+        }
+
+        virtual bool IsConnected() {
+            return true;
+        }
+
+        // Dispatches readings in batches of given size and waits until analyzers processed all of them.
+        void deliver(const std::vector<SerialSample>& samples, std::size_t batchSize) {
+            for (std::size_t position = 0; position < samples.size(); position += batchSize) {
+                this->analyzerDispatcher.dispatch(samples.data() + position, std::min(batchSize, samples.size() - position));
+            }
+            this->analyzerDispatcher.waitUntilIdle();
+        }
+
+    private:
+        AnalyzerDispatcher analyzerDispatcher;
+
+        virtual bool registerDataAnalyzer(SerialPortDataAnalyzer* analyzerToRegister, BackpressurePolicy policy,
+                                          std::size_t queueCapacity) {
+            return this->analyzerDispatcher.addAnalyzer(analyzerToRegister, policy, queueCapacity);
+        }
+
+        virtual void deregisterDataAnalyzer(SerialPortDataAnalyzer* analyzerToDeregister) {
+            this->analyzerDispatcher.removeAnalyzer(analyzerToDeregister);
+        }
+    };
+
+#ifdef __linux__
+    // Analyzer which only counts delivered values, shared counter lets benchmark wait for all analyzers.
+    class CountingAnalyzer: public SerialPortDataAnalyzer {
+    public:
+        CountingAnalyzer(const std::shared_ptr<SampleSource>& serialReader, std::atomic<std::uint64_t>& receivedSamples)
+            :SerialPortDataAnalyzer(serialReader)
+            ,receivedSamples(receivedSamples) {
+            this->registerToSerialReader(this);
+        }
+
+        virtual ~CountingAnalyzer() {
+            this->deregisterFromSerialReader(this);
+        }
+
+        virtual std::pair<SampleTimestamp, double> getRawData() {
+            return std::pair<SampleTimestamp, double>{ -1,0 };
+        }
+
+        virtual std::pair<SampleTimestamp, double> getProcessedData() {
+            return std::pair<SampleTimestamp, double>{ -1,0 };
+        }
+
+    private:
+        std::atomic<std::uint64_t>& receivedSamples;
+
+        virtual void fetchNewData(const SerialSample& sample) {
+            if (sample.status == SampleStatus::VALUE) {
+                this->receivedSamples.fetch_add(1, std::memory_order_release);
+            }
+        }
+    };
+#endif
+}
+
+// Window update and median of the window - work of MedianFilter::processData() per reading.
+static void BM_SlidingMedian(benchmark::State& state) {
+    const unsigned int filterWindow = static_cast<unsigned int>(state.range(0));
+    std::vector<SerialSample> samples = makeSamples(BLOCK_SAMPLES);
+    SlidingMedian medianWindow(2 * filterWindow + 1);
+
+    for (auto _ : state) {
+        for (const SerialSample& sample : samples) {
+            medianWindow.push(sample.timestamp, sample.value);
+            benchmark::DoNotOptimize(medianWindow.getMedian());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size()));
+}
+BENCHMARK(BM_SlidingMedian)->RangeMultiplier(4)->Range(1, 1024);
+
+// Window update and average of the window - work of MovingAverageFilter::processData() per reading.
+static void BM_SlidingAverage(benchmark::State& state) {
+    const unsigned int filterWindow = static_cast<unsigned int>(state.range(0));
+    std::vector<SerialSample> samples = makeSamples(BLOCK_SAMPLES);
+    SlidingAverage averageWindow(2 * filterWindow + 1);
+
+    for (auto _ : state) {
+        for (const SerialSample& sample : samples) {
+            averageWindow.push(sample.timestamp, sample.value);
+            benchmark::DoNotOptimize(averageWindow.getAverage());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size()));
+}
+BENCHMARK(BM_SlidingAverage)->RangeMultiplier(4)->Range(1, 1024);
+
+// Kernel created by factory for given window width (3, 5, 7, 9, 15 - specialized ones), new result
+// is computed for every value like in FilterPipeline stages.
+template <std::unique_ptr<FilterKernel> (*createKernel)(unsigned int)>
+static void BM_FilterKernel(benchmark::State& state) {
+    const unsigned int windowWidth = static_cast<unsigned int>(state.range(0));
+    std::vector<SerialSample> samples = makeSamples(BLOCK_SAMPLES);
+    std::unique_ptr<FilterKernel> kernel = createKernel(windowWidth);
+    state.SetLabel(FilterKernel::hasFixedWindowKernel(windowWidth) ? "fixed window" : "sliding window");
+
+    for (auto _ : state) {
+        for (const SerialSample& sample : samples) {
+            kernel->push(sample.timestamp, sample.value);
+            benchmark::DoNotOptimize(kernel->getResult());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size()));
+}
+BENCHMARK_TEMPLATE(BM_FilterKernel, FilterKernel::createMedian)->Arg(3)->Arg(5)->Arg(7)->Arg(9)->Arg(15)->Arg(17);
+BENCHMARK_TEMPLATE(BM_FilterKernel, FilterKernel::createAverage)->Arg(3)->Arg(5)->Arg(7)->Arg(9)->Arg(15)->Arg(17);
+
+// Whole filter analyzer fed by dispatcher (single worker) with blocks of readings.
+template <class Filter>
+static void BM_FilterAnalyzer(benchmark::State& state) {
+    const unsigned int filterWindow = static_cast<unsigned int>(state.range(0));
+    std::vector<SerialSample> samples = makeSamples(BLOCK_SAMPLES);
+    std::shared_ptr<BenchmarkSource> source = std::make_shared<BenchmarkSource>(1);
+    Filter filter(source, filterWindow);
+
+    for (auto _ : state) {
+        source->deliver(samples, samples.size());
+    }
+    benchmark::DoNotOptimize(filter.getProcessedData());
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size()));
+}
+BENCHMARK_TEMPLATE(BM_FilterAnalyzer, MedianFilter)->RangeMultiplier(4)->Range(1, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FilterAnalyzer, MovingAverageFilter)->RangeMultiplier(4)->Range(1, 1024)->UseRealTime();
+
+/*
+ * Single MultiChannelFilter fed with blocks of multi-channel readings.
+ * Arguments: amount of channels, filterWindow (4 - width 9 specialized at compile time), filter type.
+ * Items are values (messages * channels), so results compare directly with BM_FilterAnalyzer.
+ */
+static void BM_MultiChannelFilter(benchmark::State& state) {
+    const std::size_t channelCount = static_cast<std::size_t>(state.range(0));
+    const unsigned int filterWindow = static_cast<unsigned int>(state.range(1));
+    const MultiChannelFilter::Type type = (state.range(2) == 0) ? MultiChannelFilter::Type::MEDIAN :
+                                                                  MultiChannelFilter::Type::MOVING_AVERAGE;
+    std::vector<SerialSample> samples = makeChannelSamples(BLOCK_SAMPLES / channelCount, channelCount);
+    std::shared_ptr<BenchmarkSource> source = std::make_shared<BenchmarkSource>(1);
+    MultiChannelFilter filter(source, channelCount, filterWindow, type);
+
+    for (auto _ : state) {
+        source->deliver(samples, samples.size());
+    }
+    benchmark::DoNotOptimize(filter.getProcessedData());
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size()));
+}
+BENCHMARK(BM_MultiChannelFilter)->ArgsProduct({ { 1, 4, 16 }, { 4, 16 }, { 0, 1 } })->UseRealTime();
+
+// Parsing of a single fixed width message.
+static void BM_ParseValue(benchmark::State& state) {
+    std::string data = makeFixedWidthData();
+    double value = 0;
+    std::size_t position = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FrameParser::parseValue(data.data() + position, data.data() + position + FRAME_WIDTH, value));
+        position = (position + FRAME_WIDTH) % data.size();
+    }
+    benchmark::DoNotOptimize(value);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ParseValue);
+
+// Framing and parsing of received block, argument selects message format.
+static void BM_SerialFramer(benchmark::State& state) {
+    FrameFormat format = FrameFormat::fixedWidth(FRAME_WIDTH);
+    std::string data;
+
+    switch (state.range(0)) {
+    case 0:
+        data = makeFixedWidthData();
+        state.SetLabel("fixed width");
+        break;
+    case 1:
+        format = FrameFormat::delimited('\n');
+        data = makeDelimitedData();
+        state.SetLabel("delimited");
+        break;
+    default:
+        format = FrameFormat::lengthPrefixed();
+        data = makeLengthPrefixedData();
+        state.SetLabel("length prefixed");
+        break;
+    }
+
+    SerialFramer framer(format);
+    std::vector<SerialSample> samples(PARSED_FRAMES);
+
+    for (auto _ : state) {
+        FrameParser::BatchResult result = framer.extractSamples(data.data(), data.size(), 0, samples.data(), samples.size());
+        if (result.parsedSamples != PARSED_FRAMES) {
+            state.SkipWithError("not all messages were parsed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * PARSED_FRAMES));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_SerialFramer)->DenseRange(0, 2);
+
+// Framing and parsing of multi-channel messages, argument is amount of channels.
+static void BM_MultiChannelFramer(benchmark::State& state) {
+    const std::size_t channelCount = static_cast<std::size_t>(state.range(0));
+    std::string data = makeMultiChannelData(channelCount);
+    SerialFramer framer(FrameFormat::multiChannel(channelCount));
+    std::vector<SerialSample> samples(framer.getMaxSampleCount(data.size()));
+
+    for (auto _ : state) {
+        FrameParser::BatchResult result = framer.extractSamples(data.data(), data.size(), 0, samples.data(), samples.size());
+        if (result.parsedSamples != PARSED_FRAMES) {
+            state.SkipWithError("not all values were parsed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * PARSED_FRAMES));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_MultiChannelFramer)->Arg(4)->Arg(16);
+
+// Recording single latency, run from 1 and 4 threads recording into the same histogram.
+static void BM_LatencyHistogramRecord(benchmark::State& state) {
+    static LatencyHistogram histogram;
+    std::int64_t latency = 1000 + state.thread_index() * 7919;
+
+    for (auto _ : state) {
+        histogram.record(latency);
+        // Spreads values over many buckets, like real latencies.
+        latency = (latency * 1103515245 + 12345) & 0xFFFFFF;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_LatencyHistogramRecord)->Threads(1)->Threads(4);
+
+/*
+ * Delivery of readings to many median filters through dispatcher - fetchNewData() end to end.
+ * Arguments: amount of analyzers, amount of readings dispatched at once (1 - reading by reading).
+ */
+static void BM_DispatchToAnalyzers(benchmark::State& state) {
+    const std::size_t analyzerCount = static_cast<std::size_t>(state.range(0));
+    const std::size_t batchSize = static_cast<std::size_t>(state.range(1));
+    std::vector<SerialSample> samples = makeSamples(BLOCK_SAMPLES);
+    std::shared_ptr<BenchmarkSource> source = std::make_shared<BenchmarkSource>(0);
+
+    std::vector<std::unique_ptr<MedianFilter>> filters;
+    for (std::size_t i = 0; i < analyzerCount; ++i) {
+        filters.push_back(std::make_unique<MedianFilter>(source, 2));
+    }
+
+    for (auto _ : state) {
+        source->deliver(samples, batchSize);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * samples.size() * analyzerCount));
+}
+BENCHMARK(BM_DispatchToAnalyzers)->ArgsProduct({ { 1, 2, 4, 8 }, { 1, 64, 4096 } })->UseRealTime();
+
+#ifdef __linux__
+/*
+ * Time from writing a message to pseudo-terminal until every analyzer registered to Serial got it
+ * (transport, framing, Serial queue, dispatcher). Argument: amount of analyzers.
+ * Median and 99th percentile are reported as counters (microseconds).
+ */
+static void BM_SerialLatency(benchmark::State& state) {
+    typedef std::chrono::steady_clock Clock;
+
+    const std::uint64_t analyzerCount = static_cast<std::uint64_t>(state.range(0));
+
+    PseudoTerminal pseudoTerminal;
+    if (!pseudoTerminal.isOpen()) {
+        state.SkipWithError("could not open pseudo-terminal");
+        return;
+    }
+
+    std::shared_ptr<Serial> serialReader = std::make_shared<Serial>(pseudoTerminal.getSlaveName(),
+            FrameFormat::fixedWidth(FRAME_WIDTH));
+    if (!serialReader->IsConnected()) {
+        state.SkipWithError("could not open serial port");
+        return;
+    }
+
+    std::atomic<std::uint64_t> receivedSamples(0);
+    std::vector<std::unique_ptr<CountingAnalyzer>> analyzers;
+    for (std::uint64_t i = 0; i < analyzerCount; ++i) {
+        analyzers.push_back(std::make_unique<CountingAnalyzer>(serialReader, receivedSamples));
+    }
+
+    std::string data = makeFixedWidthData();
+    std::size_t position = 0;
+    std::uint64_t expectedSamples = 0;
+    std::vector<double> latencies;
+
+    for (auto _ : state) {
+        expectedSamples += analyzerCount;
+        Clock::time_point writeTime = Clock::now();
+        Clock::time_point deadline = writeTime + std::chrono::seconds(1);
+
+        if (!pseudoTerminal.write(data.data() + position, FRAME_WIDTH)) {
+            state.SkipWithError("writing to pseudo-terminal failed");
+            break;
+        }
+        position = (position + FRAME_WIDTH) % data.size();
+
+        while (receivedSamples.load(std::memory_order_acquire) < expectedSamples && Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        Clock::time_point receiveTime = Clock::now();
+
+        if (receivedSamples.load(std::memory_order_acquire) < expectedSamples) {
+            state.SkipWithError("message was not delivered within 1 s");
+            break;
+        }
+
+        double latency = std::chrono::duration<double>(receiveTime - writeTime).count();
+        state.SetIterationTime(latency);
+        latencies.push_back(latency);
+    }
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        state.counters["p50_us"] = latencies[latencies.size() / 2] * 1e6;
+        state.counters["p99_us"] = latencies[latencies.size() * 99 / 100] * 1e6;
+    }
+}
+BENCHMARK(BM_SerialLatency)->Arg(1)->Arg(4)->UseManualTime()->Iterations(2000);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,198 @@
+/*
+ * SerialThroughputBenchmark.cpp
+ *
+ * Measures sustained sample rate of whole reading pipeline (transport, framing, parsing,
+ * delivery to analyzer) for different line settings. Data is generated on pseudo-terminal
+ * (Linux only) - writer paces bytes like a real line at given baud rate would, so each case
+ * shows how many 10 byte messages per second that setting can carry, and whether reader keeps up.
+ * The last case writes as fast as possible and shows the limit of the pipeline itself.
+ *
+ * Usage: SerialThroughputBenchmark [seconds per case]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PseudoTerminal.h"
+#include "Serial.h"
+#include "SerialPortDataAnalyzer.h"
+
+namespace {
+    const unsigned int FRAME_WIDTH = 10;
+
+    // Amount of messages prepared up front and written in a loop.
+    const std::size_t PATTERN_FRAMES = 1000;
+
+    struct BenchmarkCase {
+        const char* name;
+        SerialPortSettings settings;
+        // false - write as fast as pseudo-terminal accepts data
+        bool paced;
+    };
+
+    // Analyzer which only counts delivered values.
+    class CountingAnalyzer: public SerialPortDataAnalyzer {
+    public:
+        CountingAnalyzer(const std::shared_ptr<SampleSource>& serialReader)
+            :SerialPortDataAnalyzer(serialReader)
+            ,receivedSamples(0) {
+            this->registerToSerialReader(this);
+        }
+
+        virtual ~CountingAnalyzer() {
+            this->deregisterFromSerialReader(this);
+        }
+
+        virtual std::pair<SampleTimestamp, double> getRawData() {
+            return std::pair<SampleTimestamp, double>{ -1,0 };
+        }
+
+        virtual std::pair<SampleTimestamp, double> getProcessedData() {
+            return std::pair<SampleTimestamp, double>{ -1,0 };
+        }
+
+        std::uint64_t getReceivedSamples() const {
+            return this->receivedSamples;
+        }
+
+    private:
+        std::atomic<std::uint64_t> receivedSamples;
+
+        virtual void fetchNewData(const SerialSample& sample) {
+            if (sample.status == SampleStatus::VALUE) {
+                this->receivedSamples.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    SerialPortSettings makeSettings(unsigned int baudRate, std::size_t minimumReadBytes = 1, int interByteTimeoutMs = 0) {
+        SerialPortSettings settings;
+        settings.baudRate = baudRate;
+        settings.minimumReadBytes = minimumReadBytes;
+        settings.interByteTimeoutMs = interByteTimeoutMs;
+        return settings;
+    }
+
+    std::string makePattern() {
+        std::string pattern;
+        char frame[FRAME_WIDTH + 1];
+
+        for (std::size_t i = 0; i < PATTERN_FRAMES; ++i) {
+            std::snprintf(frame, sizeof(frame), "%-10.3f", static_cast<double>(i % 2000) - 1000.0);
+            pattern.append(frame, FRAME_WIDTH);
+        }
+        return pattern;
+    }
+
+    /**
+     * Writes pattern to pseudo-terminal until stop is requested.
+     *
+     * params:
+     * bytesPerSecond - line rate to simulate, 0 means no pacing
+     * returns: amount of written messages
+     */
+    std::uint64_t writeFrames(PseudoTerminal& pseudoTerminal, const std::string& pattern, double bytesPerSecond,
+                              const std::atomic<bool>& stopRequested) {
+        typedef std::chrono::steady_clock Clock;
+
+        const std::size_t writeChunk = 1000;
+        Clock::time_point startTime = Clock::now();
+        std::uint64_t writtenBytes = 0;
+        std::size_t patternPosition = 0;
+
+        while (!stopRequested) {
+            std::size_t bytesToWrite = writeChunk;
+
+            if (bytesPerSecond > 0) {
+                double elapsedSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+                double bytesDue = elapsedSeconds * bytesPerSecond - static_cast<double>(writtenBytes);
+                if (bytesDue < 1) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+                    continue;
+                }
+                bytesToWrite = std::min<std::size_t>(writeChunk, static_cast<std::size_t>(bytesDue));
+            }
+
+            bytesToWrite = std::min(bytesToWrite, pattern.size() - patternPosition);
+            if (!pseudoTerminal.write(pattern.data() + patternPosition, bytesToWrite)) {
+                break;
+            }
+            writtenBytes += bytesToWrite;
+            patternPosition = (patternPosition + bytesToWrite) % pattern.size();
+        }
+
+        return writtenBytes / FRAME_WIDTH;
+    }
+
+    void runCase(const BenchmarkCase& benchmarkCase, const std::string& pattern, double seconds) {
+        PseudoTerminal pseudoTerminal;
+        if (!pseudoTerminal.isOpen()) {
+            std::cout << "ERROR: could not open pseudo-terminal." << std::endl;
+            return;
+        }
+
+        std::shared_ptr<Serial> serialReader = std::make_shared<Serial>(pseudoTerminal.getSlaveName(),
+                FrameFormat::fixedWidth(FRAME_WIDTH), benchmarkCase.settings);
+        if (!serialReader->IsConnected()) {
+            return;
+        }
+        CountingAnalyzer analyzer(serialReader);
+
+        double bytesPerSecond = benchmarkCase.paced ?
+                static_cast<double>(benchmarkCase.settings.baudRate) / benchmarkCase.settings.bitsPerCharacter() : 0;
+
+        std::atomic<bool> stopRequested(false);
+        std::uint64_t writtenFrames = 0;
+        std::thread writerThread([&] {
+            writtenFrames = writeFrames(pseudoTerminal, pattern, bytesPerSecond, stopRequested);
+        });
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stopRequested = true;
+        writerThread.join();
+
+        // Let reader take what is still buffered.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        double lineRate = bytesPerSecond / FRAME_WIDTH;
+        double receivedRate = static_cast<double>(analyzer.getReceivedSamples()) / seconds;
+
+        std::printf("%-28s %14.0f %14.0f %10llu %10llu %8llu\n", benchmarkCase.name, lineRate, receivedRate,
+                    static_cast<unsigned long long>(writtenFrames),
+                    static_cast<unsigned long long>(analyzer.getReceivedSamples()),
+                    static_cast<unsigned long long>(serialReader->getParseErrorCount() + serialReader->getDroppedReadingCount()));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = (argc > 1) ? std::atof(argv[1]) : 2.0;
+    if (seconds <= 0) {
+        seconds = 2.0;
+    }
+
+    const std::vector<BenchmarkCase> benchmarkCases = {
+        { "9600 8N1", makeSettings(9600), true },
+        { "115200 8N1", makeSettings(115200), true },
+        { "921600 8N1", makeSettings(921600), true },
+        { "1843200 8N1 (custom rate)", makeSettings(1843200), true },
+        { "3000000 8N1", makeSettings(3000000), true },
+        { "3000000 8N1 burst 1000B/2ms", makeSettings(3000000, 1000, 2), true },
+        { "unpaced", makeSettings(4000000), false },
+        { "unpaced burst 4000B/1ms", makeSettings(4000000, 4000, 1), false }
+    };
+
+    std::string pattern = makePattern();
+
+    std::printf("%-28s %14s %14s %10s %10s %8s\n", "setting", "line [msg/s]", "received [/s]", "written", "received", "lost");
+    for (const BenchmarkCase& benchmarkCase : benchmarkCases) {
+        runCase(benchmarkCase, pattern, seconds);
+    }
+
+    return 0;
+}
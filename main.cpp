@@ -5,86 +5,134 @@
  *      Author: Jakub Popiech
  * 
  * Simple presentation how app works.
- * Press escape to stop demo.
+ * Press escape (Windows) or Ctrl+C (Linux) to stop demo.
+ *
+ * Usage: SerialDemo [serial port]
+ * On Linux metrics of serial reader are served on http://127.0.0.1:9464/metrics.
  */
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
+#include <memory>
 #include <vector>
 #include <utility>
 #include <string>
+
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include "MetricsServer.h"
+#endif
 
 #include "Serial.h"
-#include "MovingAverageFilter.h"
-#include "MedianFilter.h"
+#include "FilterPipeline.h"
+#include "MedianStage.h"
+#include "MovingAverageStage.h"
+#include "RecordingWriter.h"
+#include "SampleRecorder.h"
 
-int main() {
-    // data transfer interval in my Arduino board is set to 500ms that is why main thread
-    // wakes up every half a second.
-    std::chrono::milliseconds sleepTime(500);
-    int bufferSize = 10;
-    //std::shared_ptr<Serial> serialReader = std::make_shared<Serial>("COM3", bufferSize);
-    bool exit = false;
-    std::vector<std::pair<SerialPortDataAnalyzer*, std::ofstream>> analyzerVector;
-
-    std::ofstream rawDataFile("RawData.txt");
-
-
-    analyzerVector.push_back(std::pair<SerialPortDataAnalyzer*, std::ofstream>(new MedianFilter("COM3", bufferSize, 2), "MedianFilter.txt"));
-    analyzerVector.push_back(std::pair<SerialPortDataAnalyzer*, std::ofstream>(new MovingAverageFilter(analyzerVector[0].first->getSerialPortReader(), 2), "MovingAverageFilter.txt"));
-    std::pair<std::time_t, std::double_t> resultPair;
-
-    while (!exit) {
-        // All analyzers should provide the same raw data, so I can choose anyone to get it.
-
-        if (!analyzerVector.empty()) {
-            SerialPortDataAnalyzer* chosenAnalyzer = analyzerVector[0].first;
-            resultPair = chosenAnalyzer->getRawData();
-            if (resultPair.first == -1) {
-                std::cout << "Raw data from analyzer not available" << std::endl;
-            }
-            else {
-                // probably most simple way to present time in readable form, altough definitely not the best,
-                // but for presentation purpose is enough
-                std::string dataDate = std::asctime(std::localtime(&resultPair.first));
-                if (dataDate.length() >= 2)
-                    dataDate.back() = '\0';
-
-                rawDataFile << dataDate << " , " << resultPair.second << std::endl;
-            }
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void handleStopSignal(int) {
+        stopRequested = 1;
+    }
+
+    // Checks if user asked to stop demo.
+    bool isStopRequested() {
+#ifdef _WIN32
+        if (GetAsyncKeyState(VK_ESCAPE)) {
+            return true;
         }
+#endif
+        return stopRequested != 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    std::string portName = (argc > 1) ? argv[1] : "COM3";
+#else
+    std::string portName = (argc > 1) ? argv[1] : "/dev/ttyACM0";
+#endif
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    // Main thread waits for results of analyzers, timeout only bounds the time of reacting to stop request.
+    std::chrono::milliseconds stopCheckInterval(100);
+    int bufferSize = 10;
+    std::shared_ptr<Serial> serialReader = std::make_shared<Serial>(portName, bufferSize);
+
+    // Every raw reading is recorded by the recorder itself. It is registered before any other analyzer,
+    // so it gets readings from the very first one.
+    SampleRecorder rawDataRecorder(serialReader, "RawData.rec");
 
-        for (std::pair<SerialPortDataAnalyzer*, std::ofstream>& analyzerPair : analyzerVector) {
-            SerialPortDataAnalyzer* selectedAnalyzer = analyzerPair.first;
-            resultPair = selectedAnalyzer->getProcessedData();
-            if (resultPair.first == -1) {
-                std::cout << "Processed data from analyzer not available" << std::endl;
-            }
-            else {
-                std::string dataDate = std::asctime(std::localtime(&resultPair.first));
-                if (dataDate.length() >= 2)
-                    dataDate.back() = '\0';
-
-                analyzerPair.second  << dataDate << " , " << resultPair.second << std::endl;
-            }
+    // Processed values are written to binary recordings (read them with RecordingReader).
+    // Filters are pipelines, which start getting readings only after start(), so their recordings
+    // are subscribed before the first reading comes and not a single output is missed.
+    std::vector<std::pair<FilterPipeline*, std::unique_ptr<RecordingWriter>>> analyzerVector;
+
+    FilterPipeline* medianFilter = new FilterPipeline(serialReader);
+    medianFilter->addStage(std::make_unique<MedianStage>(2));
+    analyzerVector.push_back(std::make_pair(medianFilter, std::make_unique<RecordingWriter>("MedianFilter.rec")));
+
+    FilterPipeline* movingAverageFilter = new FilterPipeline(serialReader);
+    movingAverageFilter->addStage(std::make_unique<MovingAverageStage>(2));
+    analyzerVector.push_back(std::make_pair(movingAverageFilter, std::make_unique<RecordingWriter>("MovingAverageFilter.rec")));
+
+    // Median output smoothed by moving average - both stages run in one pass per reading.
+    FilterPipeline* chainedFilters = new FilterPipeline(serialReader);
+    FilterPipeline::StageId medianStage = chainedFilters->addStage(std::make_unique<MedianStage>(2));
+    chainedFilters->addStage(std::make_unique<MovingAverageStage>(2), medianStage);
+    analyzerVector.push_back(std::make_pair(chainedFilters, std::make_unique<RecordingWriter>("MedianThenMovingAverage.rec")));
+
+    // Every processed value is recorded right after analyzer computed it, on worker thread running
+    // the analyzer - it is the only thread writing to that recording.
+    for (std::pair<FilterPipeline*, std::unique_ptr<RecordingWriter>>& analyzerPair : analyzerVector) {
+        RecordingWriter* recording = analyzerPair.second.get();
+        analyzerPair.first->subscribe([recording](const SerialSample* results, std::size_t count) {
+            recording->append(results, count);
+        });
+    }
+
+    // Main thread is woken up by every block of outputs of chained filters.
+    std::shared_ptr<ResultQueue> chainedResults = chainedFilters->subscribeQueue();
+
+    for (std::pair<FilterPipeline*, std::unique_ptr<RecordingWriter>>& analyzerPair : analyzerVector) {
+        analyzerPair.first->start();
+    }
+
+#ifndef _WIN32
+    MetricsServer metricsServer(MetricsServer::DEFAULT_PORT, { serialReader.get() });
+#endif
+
+    std::vector<SerialSample> newResults;
+
+    while (!isStopRequested()) {
+        if (!chainedResults->waitForResults(newResults, stopCheckInterval)) {
+            continue;
         }
-        
 
-        if (GetAsyncKeyState(VK_ESCAPE))
-        {
-            exit = true;
+        const SerialSample& latestResult = newResults.back();
+        if (latestResult.status != SampleStatus::VALUE) {
+            std::cout << "Processed data from analyzer not available" << std::endl;
+        }
+        else {
+            std::cout << "Median then moving average: " << latestResult.value << " (" << newResults.size()
+                      << " new values)" << std::endl;
         }
-        std::this_thread::sleep_for(sleepTime);
     }
 
-    for (std::pair<SerialPortDataAnalyzer*, std::ofstream>& analyzerPair : analyzerVector) {
+    for (std::pair<FilterPipeline*, std::unique_ptr<RecordingWriter>>& analyzerPair : analyzerVector) {
         delete analyzerPair.first;
-        analyzerPair.second.close();
+        analyzerPair.second->close();
     }
     analyzerVector.clear();
-    rawDataFile.close();
 
+#ifdef _WIN32
     system("pause");
+#endif
     return 0;
 }
 